@@ -13,6 +13,8 @@ BUILD_DIR = os.path.normpath(sys.argv[2])
 EBOOT = sys.argv[3]
 # assets dir
 ASSETS_DIR = os.path.normpath(sys.argv[4])
+# files put next to EBOOT.PBP, like cooked fonts
+EXTRA_FILES = sys.argv[5:]
 
 dir_name, _ = os.path.splitext(os.path.basename(ZIP))
 
@@ -25,6 +27,8 @@ os.makedirs(str(root_dir), exist_ok=True)
 
 shutil.copy(EBOOT, root_dir / "EBOOT.PBP")
 shutil.copytree(ASSETS_DIR, root_dir / os.path.basename(ASSETS_DIR))
+for extra_file in EXTRA_FILES:
+    shutil.copy(extra_file, root_dir)
 
 with zipfile.ZipFile(ZIP, "w", zipfile.ZIP_DEFLATED) as zipf:
     for root, dirs, files in os.walk(root_dir):
@@ -0,0 +1,61 @@
+// Cooks BMFont files, text or binary, so that the game reads them with one
+// read and without parsing.
+//
+// Usage: cook_fonts <output_dir> <input.fnt or input_dir>...
+//
+// Cooked files get the names of the fonts with the .cooked extension added,
+// directories are cooked non-recursively.
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <symphony_lite/bm_font_file.hpp>
+
+namespace {
+bool CookFile(const std::filesystem::path& input_path,
+              const std::filesystem::path& output_dir) {
+  Symphony::Text::BmFontFile font_file;
+  if (!Symphony::Text::LoadBmFontFile(input_path.string(), font_file)) {
+    return false;
+  }
+
+  std::filesystem::path output_path =
+      output_dir / (input_path.filename().string() + ".cooked");
+  if (!Symphony::Text::SaveCookedBmFont(output_path.string(), font_file)) {
+    return false;
+  }
+
+  std::cout << input_path.string() << " -> " << output_path.string() << " ("
+            << font_file.chars.size() << " chars, "
+            << font_file.kernings.size() << " kernings)" << std::endl;
+  return true;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <output_dir> <input.fnt or input_dir>..." << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path output_dir(argv[1]);
+  std::filesystem::create_directories(output_dir);
+
+  bool success = true;
+  for (int i = 2; i < argc; ++i) {
+    std::filesystem::path input_path(argv[i]);
+    if (std::filesystem::is_directory(input_path)) {
+      for (const auto& entry :
+           std::filesystem::directory_iterator(input_path)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".fnt") {
+          success = CookFile(entry.path(), output_dir) && success;
+        }
+      }
+    } else {
+      success = CookFile(input_path, output_dir) && success;
+    }
+  }
+
+  return success ? 0 : 1;
+}
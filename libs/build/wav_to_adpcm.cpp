@@ -0,0 +1,74 @@
+// Converts 16-bit PCM wave files to 4-bit IMA ADPCM.
+//
+// Usage: wav_to_adpcm <output_dir> <input.wav or input_dir>...
+//
+// Converted files keep their names, directories are converted non-recursively.
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <symphony_lite/wave_loader.hpp>
+#include <vector>
+
+namespace {
+bool ConvertFile(const std::filesystem::path& input_path,
+                 const std::filesystem::path& output_dir) {
+  auto wave_file = Symphony::Audio::LoadWave(
+      input_path.string(), Symphony::Audio::WaveFile::kModeLoadInMemory);
+  if (!wave_file) {
+    return false;
+  }
+
+  if (wave_file->IsCompressed()) {
+    std::cout << "Already compressed, skipping: " << input_path.string()
+              << std::endl;
+    return true;
+  }
+
+  std::vector<int16_t> samples(wave_file->GetNumBlocks() *
+                               wave_file->GetNumChannels());
+  wave_file->ReadBlocks(0, wave_file->GetNumBlocks(), samples.data());
+
+  std::filesystem::path output_path = output_dir / input_path.filename();
+  if (!Symphony::Audio::SaveWave(
+          output_path.string(), Symphony::Audio::kWaveFormatImaAdpcm,
+          wave_file->GetNumChannels(), wave_file->GetSampleRate(),
+          samples.data(), wave_file->GetNumBlocks())) {
+    return false;
+  }
+
+  std::cout << input_path.string() << " -> " << output_path.string() << " ("
+            << std::filesystem::file_size(input_path) << " -> "
+            << std::filesystem::file_size(output_path) << " bytes)"
+            << std::endl;
+  return true;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <output_dir> <input.wav or input_dir>..." << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path output_dir(argv[1]);
+  std::filesystem::create_directories(output_dir);
+
+  bool success = true;
+  for (int i = 2; i < argc; ++i) {
+    std::filesystem::path input_path(argv[i]);
+    if (std::filesystem::is_directory(input_path)) {
+      for (const auto& entry :
+           std::filesystem::directory_iterator(input_path)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".wav") {
+          success = ConvertFile(entry.path(), output_dir) && success;
+        }
+      }
+    } else {
+      success = ConvertFile(input_path, output_dir) && success;
+    }
+  }
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace Symphony {
+namespace Audio {
+// 4-bit ADPCM codecs as stored in RIFF WAVE files. Samples are coded in
+// independent blocks: every block starts with a header which holds decoder
+// state, so any block can be decoded without decoding the ones before it.
+//
+// Decoded samples are interleaved int16_t, same as 16-bit PCM. Mono and
+// stereo are supported.
+
+inline constexpr size_t kImaAdpcmHeaderSize = 4;
+inline constexpr size_t kMsAdpcmHeaderSize = 7;
+inline constexpr int kImaAdpcmMaxStepIndex = 88;
+
+size_t GetImaAdpcmSamplesPerBlock(size_t block_size, size_t num_channels);
+size_t GetImaAdpcmBlockSize(size_t samples_per_block, size_t num_channels);
+size_t GetMsAdpcmSamplesPerBlock(size_t block_size, size_t num_channels);
+
+// Returns: number of samples per channel decoded, it is less than
+// samples_per_block when block is truncated, e.g. the last block in a file.
+size_t DecodeImaAdpcmBlock(const uint8_t* block, size_t block_size,
+                           size_t num_channels, size_t samples_per_block,
+                           int16_t* samples_out);
+
+// samples_per_block - 1 should be a multiple of 8. When num_samples is less
+// than samples_per_block, block is padded with silence. step_indices hold
+// encoder state for each channel, they are carried between blocks.
+void EncodeImaAdpcmBlock(const int16_t* samples, size_t num_samples,
+                         size_t num_channels, size_t samples_per_block,
+                         int* step_indices, uint8_t* block_out);
+
+// coefficients: pairs of predictor coefficients from format chunk.
+size_t DecodeMsAdpcmBlock(const uint8_t* block, size_t block_size,
+                          size_t num_channels, size_t samples_per_block,
+                          const std::vector<int16_t>& coefficients,
+                          int16_t* samples_out);
+
+// Coefficients every MS ADPCM file has, in case format chunk lacks them.
+const std::vector<int16_t>& GetMsAdpcmStandardCoefficients();
+
+namespace {
+const int kImaAdpcmIndexTable[16] = {-1, -1, -1, -1, 2, 4, 6, 8,
+                                     -1, -1, -1, -1, 2, 4, 6, 8};
+
+const int kImaAdpcmStepTable[kImaAdpcmMaxStepIndex + 1] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+const int kMsAdpcmAdaptationTable[16] = {230, 230, 230, 230, 307, 409,
+                                         512, 614, 768, 614, 512, 409,
+                                         307, 230, 230, 230};
+
+int16_t ReadInt16(const uint8_t* bytes) {
+  return (int16_t)(uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+void WriteInt16(int16_t value, uint8_t* bytes) {
+  bytes[0] = (uint8_t)((uint16_t)value & 0xFF);
+  bytes[1] = (uint8_t)((uint16_t)value >> 8);
+}
+
+int16_t ClampSample16(int value) {
+  return (int16_t)std::clamp(value, -32768, 32767);
+}
+
+struct ImaAdpcmChannel {
+  int predictor{0};
+  int step_index{0};
+
+  int16_t Decode(uint8_t nibble) {
+    int step = kImaAdpcmStepTable[step_index];
+    int diff = step >> 3;
+    if (nibble & 4) {
+      diff += step;
+    }
+    if (nibble & 2) {
+      diff += step >> 1;
+    }
+    if (nibble & 1) {
+      diff += step >> 2;
+    }
+    predictor =
+        ClampSample16((nibble & 8) ? predictor - diff : predictor + diff);
+    step_index = std::clamp(step_index + kImaAdpcmIndexTable[nibble], 0,
+                            kImaAdpcmMaxStepIndex);
+    return (int16_t)predictor;
+  }
+
+  // Mirrors Decode(), so that encoder and decoder predictors stay equal.
+  uint8_t Encode(int16_t sample) {
+    int step = kImaAdpcmStepTable[step_index];
+    int diff = sample - predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+      nibble = 8;
+      diff = -diff;
+    }
+
+    int predicted_diff = step >> 3;
+    if (diff >= step) {
+      nibble |= 4;
+      diff -= step;
+      predicted_diff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+      nibble |= 2;
+      diff -= step;
+      predicted_diff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+      nibble |= 1;
+      predicted_diff += step;
+    }
+
+    predictor = ClampSample16((nibble & 8) ? predictor - predicted_diff
+                                           : predictor + predicted_diff);
+    step_index = std::clamp(step_index + kImaAdpcmIndexTable[nibble], 0,
+                            kImaAdpcmMaxStepIndex);
+    return nibble;
+  }
+};
+}  // namespace
+
+size_t GetImaAdpcmSamplesPerBlock(size_t block_size, size_t num_channels) {
+  if (!num_channels || block_size < kImaAdpcmHeaderSize * num_channels) {
+    return 0;
+  }
+  return (block_size - kImaAdpcmHeaderSize * num_channels) * 2 / num_channels +
+         1;
+}
+
+size_t GetImaAdpcmBlockSize(size_t samples_per_block, size_t num_channels) {
+  return kImaAdpcmHeaderSize * num_channels +
+         (samples_per_block - 1) / 2 * num_channels;
+}
+
+size_t GetMsAdpcmSamplesPerBlock(size_t block_size, size_t num_channels) {
+  if (!num_channels || block_size < kMsAdpcmHeaderSize * num_channels) {
+    return 0;
+  }
+  return (block_size - kMsAdpcmHeaderSize * num_channels) * 2 / num_channels +
+         2;
+}
+
+size_t DecodeImaAdpcmBlock(const uint8_t* block, size_t block_size,
+                           size_t num_channels, size_t samples_per_block,
+                           int16_t* samples_out) {
+  if (!num_channels || num_channels > 2 || !samples_per_block ||
+      block_size < kImaAdpcmHeaderSize * num_channels) {
+    return 0;
+  }
+
+  ImaAdpcmChannel channels[2];
+
+  for (size_t c = 0; c < num_channels; ++c) {
+    const uint8_t* header = block + c * kImaAdpcmHeaderSize;
+    channels[c].predictor = ReadInt16(header);
+    channels[c].step_index =
+        std::min((int)header[2], (int)kImaAdpcmMaxStepIndex);
+    samples_out[c] = (int16_t)channels[c].predictor;
+  }
+
+  // Data goes in groups of 4 bytes (8 samples) for each channel in turn.
+  const uint8_t* data = block + kImaAdpcmHeaderSize * num_channels;
+  size_t group_size = 4 * num_channels;
+  size_t num_groups =
+      (block_size - kImaAdpcmHeaderSize * num_channels) / group_size;
+  size_t num_samples = std::min(samples_per_block, 1 + num_groups * 8);
+
+  for (size_t group = 0; group < num_groups; ++group) {
+    for (size_t c = 0; c < num_channels; ++c) {
+      const uint8_t* bytes = data + group * group_size + c * 4;
+      for (size_t k = 0; k < 8; ++k) {
+        size_t sample_index = 1 + group * 8 + k;
+        if (sample_index >= num_samples) {
+          break;
+        }
+        uint8_t byte = bytes[k / 2];
+        uint8_t nibble = (k % 2) ? (byte >> 4) : (byte & 0x0F);
+        samples_out[sample_index * num_channels + c] =
+            channels[c].Decode(nibble);
+      }
+    }
+  }
+
+  return num_samples;
+}
+
+void EncodeImaAdpcmBlock(const int16_t* samples, size_t num_samples,
+                         size_t num_channels, size_t samples_per_block,
+                         int* step_indices, uint8_t* block_out) {
+  if (!num_channels || num_channels > 2) {
+    return;
+  }
+
+  memset(block_out, 0, GetImaAdpcmBlockSize(samples_per_block, num_channels));
+
+  auto get_sample = [&](size_t sample_index, size_t c) -> int16_t {
+    return sample_index < num_samples ? samples[sample_index * num_channels + c]
+                                      : 0;
+  };
+
+  ImaAdpcmChannel channels[2];
+  for (size_t c = 0; c < num_channels; ++c) {
+    channels[c].predictor = get_sample(0, c);
+    channels[c].step_index =
+        std::clamp(step_indices[c], 0, kImaAdpcmMaxStepIndex);
+
+    uint8_t* header = block_out + c * kImaAdpcmHeaderSize;
+    WriteInt16((int16_t)channels[c].predictor, header);
+    header[2] = (uint8_t)channels[c].step_index;
+    header[3] = 0;
+  }
+
+  uint8_t* data = block_out + kImaAdpcmHeaderSize * num_channels;
+  size_t group_size = 4 * num_channels;
+  size_t num_groups = (samples_per_block - 1) / 8;
+  for (size_t group = 0; group < num_groups; ++group) {
+    for (size_t c = 0; c < num_channels; ++c) {
+      uint8_t* bytes = data + group * group_size + c * 4;
+      for (size_t k = 0; k < 8; ++k) {
+        uint8_t nibble = channels[c].Encode(get_sample(1 + group * 8 + k, c));
+        bytes[k / 2] |= (k % 2) ? (uint8_t)(nibble << 4) : nibble;
+      }
+    }
+  }
+
+  for (size_t c = 0; c < num_channels; ++c) {
+    step_indices[c] = channels[c].step_index;
+  }
+}
+
+size_t DecodeMsAdpcmBlock(const uint8_t* block, size_t block_size,
+                          size_t num_channels, size_t samples_per_block,
+                          const std::vector<int16_t>& coefficients,
+                          int16_t* samples_out) {
+  if (!num_channels || num_channels > 2 || samples_per_block < 2 ||
+      block_size < kMsAdpcmHeaderSize * num_channels) {
+    return 0;
+  }
+
+  size_t num_coefficient_pairs = coefficients.size() / 2;
+
+  int coefficient1[2] = {0, 0};
+  int coefficient2[2] = {0, 0};
+  int delta[2] = {0, 0};
+  int sample1[2] = {0, 0};
+  int sample2[2] = {0, 0};
+
+  // Header: predictor indices, deltas, first and second samples, each field
+  // for all channels.
+  const uint8_t* header = block;
+  for (size_t c = 0; c < num_channels; ++c) {
+    size_t predictor = header[c];
+    if (predictor < num_coefficient_pairs) {
+      coefficient1[c] = coefficients[predictor * 2];
+      coefficient2[c] = coefficients[predictor * 2 + 1];
+    }
+    delta[c] = ReadInt16(header + num_channels + c * 2);
+    sample1[c] = ReadInt16(header + num_channels * 3 + c * 2);
+    sample2[c] = ReadInt16(header + num_channels * 5 + c * 2);
+
+    // Older sample goes first.
+    samples_out[c] = (int16_t)sample2[c];
+    samples_out[num_channels + c] = (int16_t)sample1[c];
+  }
+
+  // Nibbles, high one first, alternate between channels.
+  const uint8_t* data = block + kMsAdpcmHeaderSize * num_channels;
+  size_t num_nibbles = (block_size - kMsAdpcmHeaderSize * num_channels) * 2;
+  size_t num_samples =
+      std::min(samples_per_block, 2 + num_nibbles / num_channels);
+  num_nibbles = (num_samples - 2) * num_channels;
+
+  for (size_t i = 0; i < num_nibbles; ++i) {
+    size_t c = i % num_channels;
+    uint8_t nibble = (i % 2) ? (data[i / 2] & 0x0F) : (data[i / 2] >> 4);
+    int signed_nibble = (nibble & 8) ? (int)nibble - 16 : (int)nibble;
+
+    int predicted =
+        (sample1[c] * coefficient1[c] + sample2[c] * coefficient2[c]) >> 8;
+    int16_t sample = ClampSample16(predicted + signed_nibble * delta[c]);
+
+    sample2[c] = sample1[c];
+    sample1[c] = sample;
+    delta[c] = std::max((kMsAdpcmAdaptationTable[nibble] * delta[c]) >> 8, 16);
+
+    samples_out[(2 + i / num_channels) * num_channels + c] = sample;
+  }
+
+  return num_samples;
+}
+
+const std::vector<int16_t>& GetMsAdpcmStandardCoefficients() {
+  static const std::vector<int16_t> kCoefficients = {
+      256, 0, 512, -256, 0, 0, 192, 64, 240, 0, 460, -208, 392, -232};
+  return kCoefficients;
+}
+}  // namespace Audio
+}  // namespace Symphony
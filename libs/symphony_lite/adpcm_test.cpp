@@ -0,0 +1,87 @@
+#include "adpcm.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace Symphony::Audio;
+
+TEST(Adpcm, ComputesImaAdpcmBlockSizes) {
+  ASSERT_EQ(GetImaAdpcmSamplesPerBlock(512, 1), 1017);
+  ASSERT_EQ(GetImaAdpcmSamplesPerBlock(1024, 2), 1017);
+  ASSERT_EQ(GetImaAdpcmBlockSize(1017, 1), 512);
+  ASSERT_EQ(GetImaAdpcmBlockSize(1017, 2), 1024);
+}
+
+TEST(Adpcm, ComputesMsAdpcmBlockSizes) {
+  ASSERT_EQ(GetMsAdpcmSamplesPerBlock(256, 1), 500);
+  ASSERT_EQ(GetMsAdpcmSamplesPerBlock(512, 2), 500);
+}
+
+TEST(Adpcm, ImaAdpcmRoundTrip) {
+  static constexpr size_t kSamplesPerBlock = 1017;
+  for (size_t num_channels : {1, 2}) {
+    std::vector<int16_t> samples(kSamplesPerBlock * num_channels);
+    for (size_t i = 0; i < kSamplesPerBlock; ++i) {
+      for (size_t c = 0; c < num_channels; ++c) {
+        samples[i * num_channels + c] = (int16_t)(
+            12000.0 * std::sin((double)i * 0.03 * (double)(c + 1)));
+      }
+    }
+
+    std::vector<uint8_t> block(
+        GetImaAdpcmBlockSize(kSamplesPerBlock, num_channels));
+    int step_indices[2] = {0, 0};
+    EncodeImaAdpcmBlock(samples.data(), kSamplesPerBlock, num_channels,
+                        kSamplesPerBlock, step_indices, block.data());
+
+    std::vector<int16_t> decoded(kSamplesPerBlock * num_channels);
+    ASSERT_EQ(DecodeImaAdpcmBlock(block.data(), block.size(), num_channels,
+                                  kSamplesPerBlock, decoded.data()),
+              kSamplesPerBlock);
+
+    // First sample is stored as is.
+    for (size_t c = 0; c < num_channels; ++c) {
+      ASSERT_EQ(decoded[c], samples[c]);
+    }
+    // Encoder starts from the smallest step, skips a few samples while it
+    // adapts.
+    for (size_t i = 16 * num_channels; i < samples.size(); ++i) {
+      ASSERT_NEAR(decoded[i], samples[i], 300) << "sample " << i;
+    }
+  }
+}
+
+TEST(Adpcm, DecodesTruncatedImaAdpcmBlock) {
+  // Header and one group of 8 samples.
+  std::vector<uint8_t> block = {0x10, 0x00, 0x00, 0x00,
+                                0x77, 0x77, 0x77, 0x77};
+  std::vector<int16_t> decoded(1017, 0);
+  ASSERT_EQ(DecodeImaAdpcmBlock(block.data(), block.size(), 1, 1017,
+                                decoded.data()),
+            9);
+  ASSERT_EQ(decoded[0], 16);
+  // Largest positive code: every sample goes up.
+  for (size_t i = 1; i < 9; ++i) {
+    ASSERT_GT(decoded[i], decoded[i - 1]);
+  }
+}
+
+TEST(Adpcm, DecodesMsAdpcmBlock) {
+  // Mono, predictor 0 (coefficients 256, 0), delta 16, sample1 100,
+  // sample2 50, then nibbles 1 and -1.
+  std::vector<uint8_t> block = {0x00, 0x10, 0x00, 0x64,
+                                0x00, 0x32, 0x00, 0x1F};
+  std::vector<int16_t> decoded(4, 0);
+  ASSERT_EQ(DecodeMsAdpcmBlock(block.data(), block.size(), 1, 500,
+                               GetMsAdpcmStandardCoefficients(),
+                               decoded.data()),
+            4);
+  ASSERT_EQ(decoded[0], 50);
+  ASSERT_EQ(decoded[1], 100);
+  // 100 + 1 * 16:
+  ASSERT_EQ(decoded[2], 116);
+  // Delta adapts to 230 * 16 / 256 -> 16 (minimum), 116 - 1 * 16:
+  ASSERT_EQ(decoded[3], 100);
+}
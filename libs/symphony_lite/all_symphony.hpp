@@ -1,25 +1,34 @@
 #pragma once
 
 #include "aa_rect2d.hpp"
+#include "adpcm.hpp"
 #include "angle.hpp"
 #include "animated_sprite.hpp"
 #include "audio.hpp"
+#include "biquad_filter.hpp"
+#include "bm_font_file.hpp"
 #include "bm_font_loader.hpp"
 #include "circle.hpp"
 #include "font.hpp"
 #include "formatted_text.hpp"
 #include "hash.hpp"
 #include "log.hpp"
+#include "lru_cache.hpp"
 #include "measured_text.hpp"
+#include "mixing_kernels.hpp"
 #include "point2d.hpp"
 #include "point3d.hpp"
 #include "random_generator.hpp"
 #include "ray_casting_projection.hpp"
+#include "resampler.hpp"
 #include "segment2d.hpp"
+#include "sound_banks.hpp"
 #include "spatial_bins.hpp"
 #include "sprite_sheet.hpp"
+#include "spsc_queue.hpp"
 #include "text.hpp"
 #include "transformation_matrix3d.hpp"
 #include "vector2d.hpp"
 #include "vector3d.hpp"
 #include "wave_loader.hpp"
+#include "wave_prefetcher.hpp"
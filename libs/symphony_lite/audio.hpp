@@ -4,15 +4,24 @@
 #include <SDL3/SDL_audio.h>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <thread>
-#include <unordered_set>
 #include <vector>
 
+#include "biquad_filter.hpp"
 #include "log.hpp"
+#include "mixing_kernels.hpp"
+#include "spsc_queue.hpp"
 #include "wave_loader.hpp"
+#include "wave_prefetcher.hpp"
 
 namespace Symphony {
 namespace Audio {
@@ -58,54 +67,324 @@ StopControl StopAtEnd() {
   return StopControl{.stop_at_end = true, .fade_out_time_sec = 0.0f};
 }
 
-class Device;
+// Identifies a voice started with Device::Play(). Once the voice has finished,
+// its handle is stale and Device ignores it.
+struct VoiceHandle {
+  uint32_t index{0};
+  // 0 is never used by Device, so default handle is invalid.
+  uint32_t generation{0};
 
-class PlayingStream {
+  bool IsValid() const { return generation != 0; }
+};
+
+// When all voices are busy, a new voice steals the voice with the lowest
+// priority, the quietest one among equal priorities. Voices with higher
+// priority than the new one are never stolen.
+inline constexpr int kPriorityLow = 0;
+inline constexpr int kPriorityNormal = 50;
+inline constexpr int kPriorityHigh = 100;
+
+// Root of the bus tree, see Device::CreateBus().
+inline constexpr size_t kMasterBus = 0;
+
+// Limits how many copies of one sound play at once, see Device::Trigger().
+struct SoundLimits {
+  // 0 is no limit.
+  size_t max_instances{0};
+  // Triggers which come sooner after the last started instance are dropped.
+  float min_retrigger_interval_sec{0.0f};
+  // When max_instances are playing, a new trigger stops the oldest instance,
+  // otherwise the new trigger is dropped.
+  bool steal_oldest{false};
+};
+
+// One sound with its limits and the instances started by Device::Trigger().
+// The sound can have variations, e.g. several screams: limits count instances
+// of all of them, and every started instance picks one of them at random.
+// Should be used with a single Device from the game thread.
+class LimitedSound {
  public:
-  PlayingStream() = default;
-  virtual ~PlayingStream() {}
+  LimitedSound() = default;
+
+  LimitedSound(std::shared_ptr<WaveFile> wave_file, const SoundLimits& limits)
+      : LimitedSound(std::vector<std::shared_ptr<WaveFile>>{wave_file},
+                     limits) {}
+
+  LimitedSound(std::vector<std::shared_ptr<WaveFile>> wave_files,
+               const SoundLimits& limits)
+      : wave_files_(std::move(wave_files)), limits_(limits) {
+    // Variations which aren't loaded are never picked.
+    wave_files_.erase(
+        std::remove(wave_files_.begin(), wave_files_.end(), nullptr),
+        wave_files_.end());
+    instances_.reserve(limits_.max_instances);
+  }
+
+  const std::vector<std::shared_ptr<WaveFile>>& GetWaveFiles() const {
+    return wave_files_;
+  }
+  const SoundLimits& GetLimits() const { return limits_; }
+
+ private:
+  friend class Device;
+
+  struct Instance {
+    VoiceHandle voice;
+    // Device mix position when the instance was started.
+    uint32_t start_position{0};
+    // Triggers merged into this instance.
+    int num_triggers{1};
+  };
+
+  const std::shared_ptr<WaveFile>& pickWaveFile() {
+    // Linear congruential generator, see Numerical Recipes.
+    random_state_ = random_state_ * 1664525u + 1013904223u;
+    return wave_files_[(random_state_ >> 16) % wave_files_.size()];
+  }
+
+  std::vector<std::shared_ptr<WaveFile>> wave_files_;
+  SoundLimits limits_;
+  // Oldest first.
+  std::vector<Instance> instances_;
+  std::optional<uint32_t> last_start_position_;
+  uint32_t random_state_{0};
 };
 
+// All public methods of Device should be called from the game thread. The
+// game thread and the audio callback never share a lock: the game thread sends
+// play/stop commands through a single-producer/single-consumer ring, the
+// callback owns the playing voices and publishes their status through atomics.
+//
+// Voices live in a pool allocated in Init(), so Play() and Stop() of sounds in
+// memory don't allocate.
 class Device {
  public:
+  static inline constexpr size_t kDefaultMaxVoices = 32;
+  static inline constexpr size_t kMaxVoicesLimit = 256;
+  static inline constexpr int kDefaultSampleRate = 22050;
+  static inline constexpr int kMinSampleRate = 8000;
+  static inline constexpr int kMaxSampleRate = 96000;
+  static inline constexpr size_t kDefaultBufferBlocks = 512;
+  static inline constexpr size_t kMinBufferBlocks = 64;
+  static inline constexpr size_t kMaxBufferBlocks = 8192;
+  static inline constexpr size_t kMaxBuses = 8;
+
+  enum class Backend {
+    // Plays through the default SDL playback device.
+    kSdl,
+    // No output device, the mix is pulled with RenderOffline(). Streams are
+    // prefetched on render, so the output doesn't depend on timing.
+    kNull,
+  };
+
   Device() = default;
 
   ~Device();
 
-  void Init();
+  // sample_rate: rate of the mix, SDL converts it to the rate of the device.
+  // buffer_blocks: blocks mixed per callback which are asked from SDL, the
+  // device may pick another period. All buffers of the mix are allocated
+  // here for the period of the device, so the audio callback never allocates.
+  void Init(size_t max_voices = kDefaultMaxVoices,
+            Backend backend = Backend::kSdl,
+            int sample_rate = kDefaultSampleRate,
+            size_t buffer_blocks = kDefaultBufferBlocks);
+
+  int GetSampleRate() const { return sample_rate_; }
+  // Blocks mixed per callback at the sample rate of the mix, as reported by
+  // the device after Init(). Same as buffer_blocks with Backend::kNull.
+  size_t GetBufferBlocks() const { return buffer_blocks_; }
+  // Time between two callbacks of the device.
+  float GetCallbackPeriodSec() const { return callback_period_sec_; }
+  // Estimated time from mixing a block to hearing it: the device plays one
+  // buffer while the next one is mixed. Latency of the system mixer and
+  // the output hardware is not included.
+  float GetOutputLatencySec() const { return callback_period_sec_ * 2.0f; }
+
+  // Applies commands that didn't fit into the command queue and releases
+  // voices finished by the audio callback. Should be called once per frame.
+  void Update();
+
+  // Returns invalid handle when the sound can't be played, e.g. when all voices
+  // are busy with sounds of higher priority.
+  //
+  // start_clock: the voice starts at this block of the audio clock, at the
+  // exact block within the mixed buffer. Voices which are late start at the
+  // beginning of the next mixed buffer, same as without start_clock.
+  VoiceHandle Play(std::shared_ptr<WaveFile> wave_file,
+                   const PlayCount& play_count,
+                   const FadeControl& fade_control = kNoFade,
+                   int priority = kPriorityNormal, size_t bus = kMasterBus,
+                   std::optional<uint32_t> start_clock = std::nullopt);
+
+  // Plays the sound once within its limits. Triggers which come before the
+  // audio callback has mixed the last started instance are merged into it:
+  // the instance is made louder instead of starting one more voice. Returns
+  // invalid handle when the trigger is dropped by the limits.
+  VoiceHandle Trigger(LimitedSound& sound, int priority = kPriorityNormal,
+                      size_t bus = kMasterBus,
+                      std::optional<uint32_t> start_clock = std::nullopt);
+
+  // Plays wave_file fading in while the from voice fades out, both during
+  // fade_time_sec from the same block, e.g. to switch music tracks. The
+  // beginning of wave_file is read ahead by the loader thread first: the
+  // voice waits silently until it is read, so that the audio callback never
+  // reads a cold file during the transition. The from voice plays on until
+  // then. The new voice fades out during fade_time_sec, too, when stopped
+  // without its own fade out time, or at the end when not looped. Looped
+  // voice has no end, so it only fades out when stopped.
+  VoiceHandle Crossfade(VoiceHandle from, std::shared_ptr<WaveFile> wave_file,
+                        const PlayCount& play_count, float fade_time_sec,
+                        int priority = kPriorityNormal,
+                        size_t bus = kMasterBus);
+
+  // Audio clock counts blocks mixed since Init() and wraps around. Between
+  // callbacks it is estimated from the time passed since the last callback:
+  // a voice played at GetAudioClock() starts with the same delay after the
+  // call, wherever the call falls between callbacks. With Backend::kNull it
+  // is the number of blocks rendered.
+  uint32_t GetAudioClock() const;
+
+  // Voices are mixed into their bus, every bus is mixed into its parent with
+  // the bus volume, and kMasterBus goes to the output. Bus volume is applied
+  // once per mixed buffer for the whole bus, so fading or muting a bus doesn't
+  // depend on the number of its voices. Returns kMasterBus when kMaxBuses are
+  // already created. Buses live until the device is destroyed.
+  size_t CreateBus(size_t parent_bus = kMasterBus);
+  // Volume is in [0, 1], changes linearly during fade_time_sec.
+  void SetBusVolume(size_t bus, float volume, float fade_time_sec = 0.0f);
+  // Returns the last volume set, the bus may still be fading to it.
+  float GetBusVolume(size_t bus) const;
+  // Filters the mix of the bus before it goes to its parent, e.g. to muffle
+  // sounds. Coefficients are computed once per change, kNoFilter turns the
+  // filter off.
+  void SetBusFilter(size_t bus, const FilterParams& filter);
+
+  // Volume is applied on top of fades, 1.0 is the volume of the wave file.
+  void SetVolume(VoiceHandle voice, float volume);
+  // Pan is in [-1, 1]: -1 plays in the left channel only, 0 plays in both
+  // channels with full volume, as voices which are not panned. Changes of pan
+  // and volume are ramped over one mixed buffer.
+  void SetPan(VoiceHandle voice, float pan);
+  // Filters the voice alone, before it is mixed into its bus. Filtering a bus
+  // costs the same as filtering one voice, prefer SetBusFilter() for groups
+  // of sounds.
+  void SetFilter(VoiceHandle voice, const FilterParams& filter);
+
+  bool IsPlaying(VoiceHandle voice);
+  size_t GetNumPlaying();
+  size_t GetMaxVoices() const { return voice_slots_.size(); }
+
+  // Voices too quiet to be heard are virtual: they move forward without
+  // reading or mixing samples, and become real again when their gain rises.
+  // When more than max_real_voices voices can be heard, the quietest of them
+  // are virtual too, so that mixing costs depend on what is heard. 0 means no
+  // limit, which is the default.
+  void SetMaxRealVoices(size_t max_real_voices);
+  void Stop(VoiceHandle voice, const StopControl& stop_control);
+  void StopImmediately(VoiceHandle voice);
+
+  // Totals for all streams played from file since Init().
+  struct StreamingStats {
+    uint32_t num_refills{0};
+    uint32_t num_underruns{0};
+  };
+  StreamingStats GetStreamingStats() const;
+
+  static inline constexpr size_t kCallbackTimeHistogramSize = 8;
+
+  // Counters of the audio callback since Init(), blocks are stereo frames.
+  struct Stats {
+    uint32_t num_callbacks{0};
+    uint32_t num_blocks_requested{0};
+    uint32_t num_blocks_delivered{0};
+    // Callbacks which took longer than the audio they mixed.
+    uint32_t num_late_callbacks{0};
+    // Reads of streams which ran out of prefetched blocks.
+    uint32_t num_underruns{0};
+    uint32_t num_playing{0};
+    uint32_t peak_num_playing{0};
+    // Playing voices which were not mixed in the last buffer.
+    uint32_t num_virtual{0};
+    uint32_t num_clipped_samples{0};
+    uint32_t max_callback_time_us{0};
+    // Bucket i counts callbacks faster than GetCallbackTimeBucketLimitUs(i),
+    // the last bucket counts all the slower ones.
+    std::array<uint32_t, kCallbackTimeHistogramSize> callback_time_histogram{};
+  };
+  // Counters are updated by the audio callback without locks, so the snapshot
+  // may mix values of two consecutive callbacks.
+  Stats GetStats() const;
 
-  std::shared_ptr<PlayingStream> Play(
-      std::shared_ptr<WaveFile> wave_file, const PlayCount& play_count,
-      const FadeControl& fade_control = kNoFade);
+  static uint32_t GetCallbackTimeBucketLimitUs(size_t bucket) {
+    return 125u << bucket;
+  }
 
-  bool IsPlaying(std::shared_ptr<PlayingStream> playing_stream);
-  size_t GetNumPlaying();
-  void Stop(std::shared_ptr<PlayingStream> playing_stream,
-            const StopControl& stop_control);
-  void StopImmediately(std::shared_ptr<PlayingStream> playing_stream);
+  // Backend::kNull only, called from the game thread instead of the audio
+  // callback. Mixes next num_blocks stereo blocks to blocks_out, 2 samples
+  // per block.
+  void RenderOffline(size_t num_blocks, int16_t* blocks_out);
+  // Backend::kNull only. Renders next num_blocks to stereo 16-bit wave file.
+  bool RenderToWaveFile(const std::string& file_path, size_t num_blocks);
 
  private:
   static inline constexpr int32_t kMaxGain = 128;
   static int32_t ToIntGain(float gain) { return (int32_t)(gain * 128.0f); }
-  static int32_t ApplyGain(int32_t sample, int32_t gain) {
-    return (sample * gain) >> 7;
-  }
 
-  static inline constexpr int32_t kSampleMax16 = 32767;
-  static inline constexpr int32_t kSampleMin16 = -32768;
+  static inline constexpr size_t kCommandQueueCapacity = 256;
+  // Every voice can have at most two generations waiting to be reported as
+  // finished: the stolen one and the current one.
+  static inline constexpr size_t kFinishedQueueCapacity = kMaxVoicesLimit * 2;
+  static inline constexpr std::chrono::milliseconds kLoaderPeriod{10};
+  // Short enough to free the voice quickly, long enough not to click.
+  static inline constexpr float kStealOldestFadeOutSec = 0.005f;
+  // Mixed buffers read ahead before a crossfade starts.
+  static inline constexpr size_t kCrossfadePrerollBuffers = 4;
+  // Gain of a voice after its bus gains, voices below it are virtual. Samples
+  // are scaled by less than 1/64 there.
+  static inline constexpr int32_t kMinAudibleGain = 2;
+  // Mapped files are paged in by reading one byte of every page.
+  static inline constexpr size_t kPrerollPageSize = 4096;
+
+  // Beginning of a wave file read by the loader thread before the voice
+  // starts, see Crossfade(). Streams are read ahead by their prefetcher,
+  // pages of mapped files are loaded by reading them.
+  struct Preroll {
+    std::shared_ptr<WaveFile> wave_file;
+    size_t num_blocks{0};
+    std::atomic<bool> is_ready{false};
+  };
 
   enum class GainState { kAttack, kSustain, kRelease };
 
-  struct PlayingStreamInternal : public PlayingStream {
-   public:
-    PlayingStreamInternal(std::shared_ptr<WaveFile> new_wave_file,
-                          const PlayCount& new_play_count,
-                          const FadeControl& new_fade_control)
-        : wave_file(new_wave_file),
-          play_count(new_play_count),
-          fade_control(new_fade_control) {}
-
+  // Game thread side of a voice.
+  struct VoiceSlot {
+    uint32_t generation{0};
+    bool is_playing{false};
+    int priority{kPriorityNormal};
+    // Keep resources alive while the callback may use them.
     std::shared_ptr<WaveFile> wave_file;
+    std::shared_ptr<WavePrefetcher> prefetcher;
+    std::shared_ptr<Preroll> preroll;
+
+    // Stolen voice, its resources are released when the callback reports it
+    // finished.
+    uint32_t stolen_generation{0};
+    std::shared_ptr<WaveFile> stolen_wave_file;
+    std::shared_ptr<WavePrefetcher> stolen_prefetcher;
+    std::shared_ptr<Preroll> stolen_preroll;
+  };
+
+  // Audio callback side of a voice.
+  struct Voice {
+    uint32_t generation{0};
+    bool is_active{false};
+    // Position in active_voices_.
+    size_t active_position{0};
+
+    WaveFile* wave_file{nullptr};
+    // Only for wave files which samples are not in memory.
+    WavePrefetcher* prefetcher{nullptr};
     PlayCount play_count;
     int num_plays{0};
     FadeControl fade_control;
@@ -115,76 +394,298 @@ class Device {
     GainState gain_state{GainState::kAttack};
     float cur_gain{1.0f};
     float gain_at_release{0.0f};
-    std::optional<StopControl> stop_control;
+    float volume{1.0f};
+    float pan{0.0f};
+    // Gains the last mixed buffer ended with, the next buffer ramps from
+    // them. The first buffer starts with its gains at once.
+    int32_t last_left_gain{0};
+    int32_t last_right_gain{0};
+    bool has_last_gains{false};
+    size_t bus{kMasterBus};
+    // Blocks to wait before the scheduled start.
+    size_t num_blocks_to_start{0};
     std::optional<StopControl> stop_control_in_callback;
+    // Voice of a crossfade waits for its preroll, then fades out the voice it
+    // replaces.
+    const Preroll* preroll{nullptr};
+    VoiceHandle crossfade_from;
+    // Not mixed in the buffer being mixed, see SetMaxRealVoices().
+    bool is_virtual{false};
+    BiquadFilter filter;
   };
 
-#pragma pack(push, 1)
-  struct StereoBlock16 {
-    int16_t left;
-    int16_t right;
+  // Audio callback side of a bus.
+  struct Bus {
+    size_t parent{kMasterBus};
+    float volume{1.0f};
+    float target_volume{1.0f};
+    size_t num_fade_blocks_left{0};
+    // Gain is ramped over the buffer being mixed, from the gain at the end of
+    // the previous buffer, so that fades don't step once per buffer.
+    StereoGainRamp gain_ramp{GetStereoGainRamp(kMaxGain, kMaxGain, kMaxGain,
+                                               kMaxGain, 1)};
+    int32_t last_gain{kMaxGain};
+    // Louder of the gains at the start and at the end of the ramp.
+    int32_t gain{kMaxGain};
+    // Product of gains of the bus and its parents, voices of a bus which
+    // can't be heard are virtual.
+    int32_t total_gain{kMaxGain};
+    // Bus buffer has samples of the buffer being mixed.
+    bool is_mixed{false};
+    BiquadFilter filter;
   };
 
-  struct StereoBlock32 {
-    int32_t left;
-    int32_t right;
+  enum class CommandType {
+    kPlay,
+    kStop,
+    kStopImmediately,
+    kSetVolume,
+    kSetPan,
+    kSetFilter,
+    kCreateBus,
+    kSetBusVolume,
+    kSetBusFilter
+  };
+
+  // Voice is identified by index and generation: commands for a voice which
+  // has already finished are ignored. Commands set only the fields they use,
+  // the rest keep their defaults.
+  struct Command {
+    CommandType type{CommandType::kPlay};
+    uint32_t index{0};
+    uint32_t generation{0};
+    // Play parameters.
+    WaveFile* wave_file{nullptr};
+    WavePrefetcher* prefetcher{nullptr};
+    PlayCount play_count{};
+    FadeControl fade_control{};
+    // Stop parameters.
+    StopControl stop_control{};
+    // Play and set volume parameters.
+    float volume{1.0f};
+    // Play and set pan parameters.
+    float pan{0.0f};
+    // Play and bus parameters.
+    size_t bus{kMasterBus};
+    size_t parent_bus{kMasterBus};
+    float fade_time_sec{0.0f};
+    // Play parameters.
+    std::optional<uint32_t> start_clock{};
+    const Preroll* preroll{nullptr};
+    VoiceHandle crossfade_from{};
+    // Set filter parameters.
+    FilterParams filter{};
+  };
+
+  struct FinishedVoice {
+    uint32_t index{0};
+    uint32_t generation{0};
+  };
+
+  // Written by the audio callback only.
+  struct CallbackCounters {
+    std::atomic<uint32_t> num_callbacks{0};
+    std::atomic<uint32_t> num_blocks_requested{0};
+    std::atomic<uint32_t> num_blocks_delivered{0};
+    std::atomic<uint32_t> num_late_callbacks{0};
+    std::atomic<uint32_t> peak_num_playing{0};
+    std::atomic<uint32_t> num_clipped_samples{0};
+    std::atomic<uint32_t> max_callback_time_us{0};
+    std::array<std::atomic<uint32_t>, kCallbackTimeHistogramSize>
+        callback_time_histogram{};
   };
-#pragma pack(pop)
 
   static void destroyAudioDevice(SDL_AudioStream* stream);
 
-  static void startPlayingStream(
-      PlayingStreamInternal* playing_stream_internal);
+  static size_t getTotalBlocksToPlay(const WaveFile& wave_file,
+                                     const PlayCount& play_count);
+
+  // n triggers merged into one voice are louder by sqrt(n): it's how loud n
+  // copies started at random times sound, while playing n copies in phase
+  // would make it n times louder and clip.
+  static float getMergedTriggersVolume(int num_triggers);
 
   // Returns: gain.
-  static int32_t updateGainStateInCallback(
-      PlayingStreamInternal* playing_stream_internal);
-
-  static void accumulateStereoSamples(StereoBlock32* accumulate_buffer,
-                                      const StereoBlock16* stream,
-                                      size_t num_blocks);
-  static void accumulateStereoSamplesWithGain(StereoBlock32* accumulate_buffer,
-                                              int32_t gain,
-                                              const StereoBlock16* stream,
-                                              size_t num_blocks);
-  static void accumulateMonoSamples(StereoBlock32* accumulate_buffer,
-                                    const int16_t* stream, size_t num_blocks);
-  static void accumulateMonoSamplesWithGain(StereoBlock32* accumulate_buffer,
-                                            int32_t gain, const int16_t* stream,
-                                            size_t num_blocks);
-  static void accumulateSamples(StereoBlock32* accumulate_buffer, int32_t gain,
+  static int32_t updateGainStateInCallback(Voice& voice);
+  // Ramp of the voice gains over the buffer being mixed, from the gains of
+  // the previous buffer to the gain and pan of this one.
+  static StereoGainRamp updateGainRampInCallback(Voice& voice, int32_t gain,
+                                                 size_t num_blocks);
+
+  // Single writer, so there is no need in read-modify-write.
+  static void addToCounter(std::atomic<uint32_t>& counter, size_t value);
+
+  static void accumulateSamples(StereoBlock32* accumulate_buffer,
+                                const StereoGainRamp& ramp,
                                 size_t num_channels, const int16_t* stream,
                                 size_t num_blocks);
 
-  void allocateMixBuffer(size_t num_blocks);
-  void allocateReadBuffer(size_t num_blocks);
-  void allocateSendBuffer(size_t num_blocks);
+  // Called once from Init(), requests bigger than num_blocks are mixed in
+  // several chunks.
+  void allocateBuffers(size_t num_blocks);
+
+  VoiceHandle playVoice(std::shared_ptr<WaveFile> wave_file,
+                        const PlayCount& play_count,
+                        const FadeControl& fade_control, int priority,
+                        size_t bus, std::optional<uint32_t> start_clock,
+                        std::optional<VoiceHandle> crossfade_from);
+  uint32_t getNextGeneration();
+  bool findVoiceToSteal(int priority, uint32_t& index_out) const;
+  void sendCommand(const Command& command);
+  void flushPendingCommands();
+  void releaseFinishedVoices();
+
+  void startLoader();
+  void stopLoader();
+  void loaderThread();
+  void addPrefetcher(const std::shared_ptr<WavePrefetcher>& prefetcher);
+  void removePrefetcher(const std::shared_ptr<WavePrefetcher>& prefetcher);
+  static void readPreroll(Preroll& preroll);
 
   static void dataCallback(void* userdata, SDL_AudioStream* stream,
                            int additional_amount, int total_amount);
-  void fillMixBuffer(int bytes_amount);
-  void sendMixedToMainStream(int bytes_amount);
-
+  void processCommandsInCallback();
+  // Fades out voices replaced by crossfades which prerolls became ready.
+  void startCrossfadesInCallback();
+  void startVoiceInCallback(const Command& command);
+  void finishVoiceInCallback(uint32_t index);
+  void applyBusCommandInCallback(const Command& command);
+  void updateBusGainsInCallback(size_t num_blocks);
+  // Master bus has its own buffer only while its gain isn't kMaxGain.
+  bool isMasterBusBufferedInCallback() const;
+  // Decides which voices are mixed, after gains of voices and buses are
+  // updated.
+  void updateVirtualVoicesInCallback();
+  // Zeroes the bus buffer when it is used first for the buffer being mixed.
+  StereoBlock32* getBusBufferInCallback(size_t bus, size_t num_blocks);
+  void mixBusesInCallback(size_t num_blocks);
+  void fillMixBuffer(size_t num_requested_blocks);
+  void sendMixedToMainStream(size_t num_requested_blocks);
+  void updateStatsInCallback(std::chrono::steady_clock::time_point start_time,
+                             size_t num_requested_blocks);
+  void publishClockInCallback(std::chrono::steady_clock::time_point start_time,
+                              size_t num_requested_blocks);
+
+  Backend backend_{Backend::kSdl};
+  int sample_rate_{kDefaultSampleRate};
+  size_t buffer_blocks_{kDefaultBufferBlocks};
+  float callback_period_sec_{(float)kDefaultBufferBlocks /
+                             (float)kDefaultSampleRate};
   std::shared_ptr<SDL_AudioStream> sdl_audio_stream_;
-  std::mutex mutex_;
-  std::unordered_set<std::shared_ptr<PlayingStream>> playing_streams_;
+
+  // Game thread only.
+  std::vector<VoiceSlot> voice_slots_;
+  std::vector<uint32_t> free_voices_;
+  uint32_t last_generation_{0};
+  std::vector<Command> pending_commands_;
+  StreamingStats released_streaming_stats_;
+  size_t num_buses_{1};
+  std::array<float, kMaxBuses> bus_volumes_{};
+
+  // Game thread adds and removes prefetchers, loader thread fills them. The
+  // audio callback only reads from prefetchers of its voices.
+  std::vector<std::shared_ptr<WavePrefetcher>> prefetchers_;
+  // Read once, after the prefetchers of the same loader pass are filled.
+  std::vector<std::shared_ptr<Preroll>> prerolls_;
+  std::mutex prefetchers_mutex_;
+  std::condition_variable loader_cv_;
+  bool loader_stop_{false};
+  std::thread loader_thread_;
+
+  SpscQueue<Command, kCommandQueueCapacity> commands_;
+  SpscQueue<FinishedVoice, kFinishedQueueCapacity> finished_voices_;
+  // Read by the audio callback.
+  std::atomic<uint32_t> max_real_voices_{0};
+  // Published by the audio callback.
+  std::atomic<uint32_t> num_playing_{0};
+  std::atomic<uint32_t> num_virtual_{0};
+  // Number of blocks mixed since Init(), wraps around.
+  std::atomic<uint32_t> mix_position_{0};
+  // Mix position, time of the callback which reached it and number of blocks
+  // it mixed. Published together with a sequence lock: the sequence is odd
+  // while they are written.
+  std::atomic<uint32_t> clock_sequence_{0};
+  std::atomic<uint32_t> clock_position_{0};
+  std::atomic<uint32_t> clock_time_us_{0};
+  std::atomic<uint32_t> clock_num_blocks_{0};
+  std::chrono::steady_clock::time_point clock_origin_;
+  std::unique_ptr<std::atomic<int32_t>[]> published_gains_;
+  CallbackCounters callback_counters_;
+
+  // Audio callback only.
+  std::vector<Voice> voices_;
+  std::vector<uint32_t> active_voices_;
+  std::vector<int32_t> gains_;
+  std::vector<StereoGainRamp> gain_ramps_;
+  // Loudest gain of the voice in the buffer being mixed, after bus gains.
+  std::vector<int32_t> audible_gains_;
+  // Active positions of voices which can be heard.
+  std::vector<uint32_t> audible_voices_;
+  std::array<Bus, kMaxBuses> buses_;
+  size_t num_buses_in_callback_{1};
+  // Master bus is mixed straight to mix_buffer_ at full gain.
   std::vector<StereoBlock32> mix_buffer_;
+  std::array<std::vector<StereoBlock32>, kMaxBuses> bus_buffers_;
+  // Filtered voice is mixed here before it goes to its bus.
+  std::vector<StereoBlock32> voice_buffer_;
   std::vector<StereoBlock16> send_buffer_;
-  std::vector<int16_t> read_buffer_;
 };
 
 Device::~Device() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  playing_streams_.clear();
+  if (sdl_audio_stream_) {
+    SDL_PauseAudioStreamDevice(sdl_audio_stream_.get());
+  }
+
+  stopLoader();
 }
 
-void Device::Init() {
+void Device::Init(size_t max_voices, Backend backend, int sample_rate,
+                  size_t buffer_blocks) {
+  backend_ = backend;
+  sample_rate_ = std::clamp(sample_rate, kMinSampleRate, kMaxSampleRate);
+  buffer_blocks_ =
+      std::clamp(buffer_blocks, kMinBufferBlocks, kMaxBufferBlocks);
+  callback_period_sec_ = (float)buffer_blocks_ / (float)sample_rate_;
+  clock_origin_ = std::chrono::steady_clock::now();
+
+  max_voices = std::clamp(max_voices, (size_t)1, kMaxVoicesLimit);
+
+  voice_slots_.resize(max_voices);
+  free_voices_.reserve(max_voices);
+  for (size_t i = max_voices; i-- > 0;) {
+    free_voices_.push_back((uint32_t)i);
+  }
+  prefetchers_.reserve(max_voices * 2);
+
+  published_gains_.reset(new std::atomic<int32_t>[max_voices]);
+  for (size_t i = 0; i < max_voices; ++i) {
+    published_gains_[i].store(0, std::memory_order_relaxed);
+  }
+
+  bus_volumes_[kMasterBus] = 1.0f;
+
+  voices_.resize(max_voices);
+  active_voices_.reserve(max_voices);
+  gains_.resize(max_voices);
+  gain_ramps_.resize(max_voices);
+  audible_gains_.resize(max_voices);
+  audible_voices_.resize(max_voices);
+
+  if (backend_ == Backend::kNull) {
+    allocateBuffers(buffer_blocks_);
+    return;
+  }
+
   SDL_AudioSpec sdl_audio_spec;
 
-  sdl_audio_spec.freq = 22050;
+  sdl_audio_spec.freq = sample_rate_;
   sdl_audio_spec.format = SDL_AUDIO_S16;
   sdl_audio_spec.channels = 2;
 
+  // Only a hint: the device may be shared or may not support the period.
+  SDL_SetHint(SDL_HINT_AUDIO_DEVICE_SAMPLE_FRAMES,
+              std::to_string(buffer_blocks_).c_str());
+
   sdl_audio_stream_.reset(
       SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK,
                                 &sdl_audio_spec, dataCallback, this),
@@ -194,113 +695,486 @@ void Device::Init() {
          SDL_GetError());
   }
 
-  allocateMixBuffer(512);
-  allocateReadBuffer(512);
-  send_buffer_.resize(512);
+  // Stream is opened paused, so buffers are allocated before the first
+  // callback.
+  SDL_AudioSpec device_spec;
+  int device_sample_frames = 0;
+  if (sdl_audio_stream_ &&
+      SDL_GetAudioDeviceFormat(
+          SDL_GetAudioStreamDevice(sdl_audio_stream_.get()), &device_spec,
+          &device_sample_frames) &&
+      device_sample_frames > 0 && device_spec.freq > 0) {
+    callback_period_sec_ =
+        (float)device_sample_frames / (float)device_spec.freq;
+    buffer_blocks_ = std::clamp(
+        (size_t)std::ceil(callback_period_sec_ * (float)sample_rate_),
+        kMinBufferBlocks, kMaxBufferBlocks);
+  }
+  allocateBuffers(buffer_blocks_);
+
+  startLoader();
 
   SDL_ResumeAudioStreamDevice(sdl_audio_stream_.get());
 }
 
-std::shared_ptr<PlayingStream> Device::Play(std::shared_ptr<WaveFile> wave_file,
-                                            const PlayCount& play_count,
-                                            const FadeControl& fade_control) {
-  if (!wave_file->GetNumBlocks()) {
+void Device::Update() {
+  releaseFinishedVoices();
+  flushPendingCommands();
+
+#if defined(__EMSCRIPTEN__)
+  // No threads, game thread keeps prefetchers filled.
+  for (auto& prefetcher : prefetchers_) {
+    prefetcher->Fill();
+  }
+#endif
+}
+
+VoiceHandle Device::Play(std::shared_ptr<WaveFile> wave_file,
+                         const PlayCount& play_count,
+                         const FadeControl& fade_control, int priority,
+                         size_t bus, std::optional<uint32_t> start_clock) {
+  return playVoice(std::move(wave_file), play_count, fade_control, priority,
+                   bus, start_clock, std::nullopt);
+}
+
+VoiceHandle Device::Crossfade(VoiceHandle from,
+                              std::shared_ptr<WaveFile> wave_file,
+                              const PlayCount& play_count, float fade_time_sec,
+                              int priority, size_t bus) {
+  return playVoice(std::move(wave_file), play_count,
+                   FadeInOut(fade_time_sec, fade_time_sec), priority, bus,
+                   std::nullopt, from);
+}
+
+VoiceHandle Device::playVoice(std::shared_ptr<WaveFile> wave_file,
+                              const PlayCount& play_count,
+                              const FadeControl& fade_control, int priority,
+                              size_t bus, std::optional<uint32_t> start_clock,
+                              std::optional<VoiceHandle> crossfade_from) {
+  if (!wave_file || !wave_file->GetNumBlocks()) {
     LOGE("[Symphony::Audio::Device] Not playing empty wave file: {}",
+         wave_file ? wave_file->GetFilePath() : "");
+    return VoiceHandle();
+  }
+
+  if (wave_file->GetSampleRate() != (size_t)sample_rate_) {
+    LOGE(
+        "[Symphony::Audio::Device] Sample rate {} doesn't match the device "
+        "rate {}, load with LoadWave(..., GetSampleRate()): {}",
+        wave_file->GetSampleRate(), sample_rate_, wave_file->GetFilePath());
+  }
+
+  releaseFinishedVoices();
+
+  uint32_t index = 0;
+  bool steal = false;
+  if (!free_voices_.empty()) {
+    index = free_voices_.back();
+  } else if (findVoiceToSteal(priority, index)) {
+    steal = true;
+  } else {
+    LOGD("[Symphony::Audio::Device] No free voice for: {}",
          wave_file->GetFilePath());
-    return nullptr;
+    return VoiceHandle();
   }
 
-  std::shared_ptr<PlayingStream> playing_stream(
-      new PlayingStreamInternal(wave_file, play_count, fade_control));
-  PlayingStreamInternal* playing_stream_internal =
-      (PlayingStreamInternal*)playing_stream.get();
+  if (bus >= num_buses_) {
+    LOGE("[Symphony::Audio::Device] No bus {}, playing to master bus", bus);
+    bus = kMasterBus;
+  }
 
-  startPlayingStream(playing_stream_internal);
+  // Without the loader thread prerolls are read right away.
+  bool is_prerolled_by_loader =
+      crossfade_from.has_value() && loader_thread_.joinable();
+
+  // Streams, mapped files and long compressed sounds are read ahead by a
+  // prefetcher of the voice. Short compressed sounds are decoded when loaded
+  // to memory, so one-shots play without it, see kMaxDecodedAdpcmBlocks.
+  std::shared_ptr<WavePrefetcher> prefetcher;
+  if (!wave_file->IsInMemory()) {
+    prefetcher = std::make_shared<WavePrefetcher>(
+        wave_file, getTotalBlocksToPlay(*wave_file, play_count));
+    if (!prefetcher->IsOpen()) {
+      LOGE("[Symphony::Audio::Device] Can't stream wave file: {}",
+           wave_file->GetFilePath());
+      return VoiceHandle();
+    }
 
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    playing_streams_.insert(playing_stream);
+    // Primes the ring, so that voice starts without underrun.
+    if (!is_prerolled_by_loader) {
+      prefetcher->Fill();
+    }
+    addPrefetcher(prefetcher);
   }
 
-  return playing_stream;
+  std::shared_ptr<Preroll> preroll;
+  if (crossfade_from.has_value()) {
+    preroll = std::make_shared<Preroll>();
+    preroll->wave_file = wave_file;
+    preroll->num_blocks =
+        std::min(kCrossfadePrerollBuffers * buffer_blocks_,
+                 wave_file->GetNumBlocks());
+    if (is_prerolled_by_loader) {
+      {
+        std::lock_guard<std::mutex> lock(prefetchers_mutex_);
+        prerolls_.push_back(preroll);
+      }
+      loader_cv_.notify_one();
+    } else {
+      readPreroll(*preroll);
+    }
+  }
+
+  VoiceSlot& slot = voice_slots_[index];
+  if (steal) {
+    slot.stolen_generation = slot.generation;
+    slot.stolen_wave_file = std::move(slot.wave_file);
+    slot.stolen_prefetcher = std::move(slot.prefetcher);
+    slot.stolen_preroll = std::move(slot.preroll);
+  } else {
+    free_voices_.pop_back();
+  }
+
+  slot.generation = getNextGeneration();
+  slot.is_playing = true;
+  slot.priority = priority;
+  slot.wave_file = wave_file;
+  slot.prefetcher = prefetcher;
+  slot.preroll = preroll;
+
+  published_gains_[index].store(
+      fade_control.fade_in_time_sec > 0.0f ? 0 : kMaxGain,
+      std::memory_order_relaxed);
+
+  sendCommand(Command{.type = CommandType::kPlay,
+                      .index = index,
+                      .generation = slot.generation,
+                      .wave_file = wave_file.get(),
+                      .prefetcher = prefetcher.get(),
+                      .play_count = play_count,
+                      .fade_control = fade_control,
+                      .bus = bus,
+                      .start_clock = start_clock,
+                      .preroll = preroll.get(),
+                      .crossfade_from =
+                          crossfade_from.value_or(VoiceHandle())});
+
+  return VoiceHandle{.index = index, .generation = slot.generation};
+}
+
+VoiceHandle Device::Trigger(LimitedSound& sound, int priority, size_t bus,
+                            std::optional<uint32_t> start_clock) {
+  if (sound.wave_files_.empty()) {
+    return VoiceHandle();
+  }
+
+  releaseFinishedVoices();
+
+  auto& instances = sound.instances_;
+  auto is_finished = [this](const LimitedSound::Instance& instance) {
+    return !IsPlaying(instance.voice);
+  };
+  instances.erase(
+      std::remove_if(instances.begin(), instances.end(), is_finished),
+      instances.end());
+
+  const SoundLimits& limits = sound.limits_;
+  uint32_t position = mix_position_.load(std::memory_order_relaxed);
+
+  if (!instances.empty()) {
+    // Nothing was mixed since the newest instance started, so the merged
+    // trigger starts at the same sample.
+    LimitedSound::Instance& newest = instances.back();
+    if (newest.start_position == position) {
+      newest.num_triggers += 1;
+      SetVolume(newest.voice, getMergedTriggersVolume(newest.num_triggers));
+      return newest.voice;
+    }
+  }
+
+  if (sound.last_start_position_.has_value()) {
+    uint32_t min_retrigger_interval =
+        (uint32_t)(limits.min_retrigger_interval_sec * (float)sample_rate_);
+    if (position - sound.last_start_position_.value() <
+        min_retrigger_interval) {
+      return VoiceHandle();
+    }
+  }
+
+  if (limits.max_instances && instances.size() >= limits.max_instances) {
+    if (!limits.steal_oldest) {
+      return VoiceHandle();
+    }
+
+    Stop(instances.front().voice, StopFade(kStealOldestFadeOutSec));
+    instances.erase(instances.begin());
+  }
+
+  VoiceHandle voice = Play(sound.pickWaveFile(), kPlayOnce, kNoFade, priority,
+                           bus, start_clock);
+  if (voice.IsValid()) {
+    instances.push_back(LimitedSound::Instance{
+        .voice = voice, .start_position = position, .num_triggers = 1});
+    sound.last_start_position_ = position;
+  }
+  return voice;
+}
+
+void Device::SetVolume(VoiceHandle voice, float volume) {
+  if (!IsPlaying(voice)) {
+    return;
+  }
+
+  sendCommand(Command{.type = CommandType::kSetVolume,
+                      .index = voice.index,
+                      .generation = voice.generation,
+                      .volume = volume});
 }
 
-bool Device::IsPlaying(std::shared_ptr<PlayingStream> playing_stream) {
-  if (!playing_stream) {
+void Device::SetPan(VoiceHandle voice, float pan) {
+  if (!IsPlaying(voice)) {
+    return;
+  }
+
+  sendCommand(Command{.type = CommandType::kSetPan,
+                      .index = voice.index,
+                      .generation = voice.generation,
+                      .pan = std::clamp(pan, -1.0f, 1.0f)});
+}
+
+void Device::SetFilter(VoiceHandle voice, const FilterParams& filter) {
+  if (!IsPlaying(voice)) {
+    return;
+  }
+
+  sendCommand(Command{.type = CommandType::kSetFilter,
+                      .index = voice.index,
+                      .generation = voice.generation,
+                      .filter = filter});
+}
+
+size_t Device::CreateBus(size_t parent_bus) {
+  if (num_buses_ == kMaxBuses || parent_bus >= num_buses_) {
+    LOGE("[Symphony::Audio::Device] Can't create bus with parent {}",
+         parent_bus);
+    return kMasterBus;
+  }
+
+  // Parent always has lower index, so buses are mixed from the last one.
+  size_t bus = num_buses_++;
+  bus_volumes_[bus] = 1.0f;
+
+  sendCommand(Command{.type = CommandType::kCreateBus,
+                      .bus = bus,
+                      .parent_bus = parent_bus});
+
+  return bus;
+}
+
+void Device::SetBusVolume(size_t bus, float volume, float fade_time_sec) {
+  if (bus >= num_buses_) {
+    return;
+  }
+
+  volume = std::clamp(volume, 0.0f, 1.0f);
+  bus_volumes_[bus] = volume;
+
+  sendCommand(Command{.type = CommandType::kSetBusVolume,
+                      .volume = volume,
+                      .bus = bus,
+                      .fade_time_sec = fade_time_sec});
+}
+
+float Device::GetBusVolume(size_t bus) const {
+  return bus < num_buses_ ? bus_volumes_[bus] : 0.0f;
+}
+
+void Device::SetBusFilter(size_t bus, const FilterParams& filter) {
+  if (bus >= num_buses_) {
+    return;
+  }
+
+  sendCommand(Command{.type = CommandType::kSetBusFilter,
+                      .bus = bus,
+                      .filter = filter});
+}
+
+void Device::SetMaxRealVoices(size_t max_real_voices) {
+  max_real_voices_.store((uint32_t)max_real_voices, std::memory_order_relaxed);
+}
+
+bool Device::IsPlaying(VoiceHandle voice) {
+  if (!voice.IsValid() || voice.index >= voice_slots_.size()) {
     return false;
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  return playing_streams_.find(playing_stream) != playing_streams_.end();
+  releaseFinishedVoices();
+
+  const VoiceSlot& slot = voice_slots_[voice.index];
+  return slot.is_playing && slot.generation == voice.generation;
+}
+
+uint32_t Device::GetAudioClock() const {
+  uint32_t sequence = 0;
+  uint32_t position = 0;
+  uint32_t time_us = 0;
+  uint32_t num_blocks = 0;
+  do {
+    sequence = clock_sequence_.load(std::memory_order_acquire);
+    position = clock_position_.load(std::memory_order_relaxed);
+    time_us = clock_time_us_.load(std::memory_order_relaxed);
+    num_blocks = clock_num_blocks_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((sequence & 1) ||
+           sequence != clock_sequence_.load(std::memory_order_relaxed));
+
+  if (backend_ == Backend::kNull) {
+    return position;
+  }
+
+  uint32_t now_us =
+      (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - clock_origin_)
+          .count();
+  uint64_t num_blocks_since =
+      (uint64_t)(now_us - time_us) * (uint64_t)sample_rate_ / 1000000;
+  // Doesn't run ahead of the next callback when it is late.
+  return position + (uint32_t)std::min(num_blocks_since, (uint64_t)num_blocks);
 }
 
 size_t Device::GetNumPlaying() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return playing_streams_.size();
+  return num_playing_.load(std::memory_order_relaxed);
+}
+
+Device::StreamingStats Device::GetStreamingStats() const {
+  StreamingStats result = released_streaming_stats_;
+  for (const auto& prefetcher : prefetchers_) {
+    result.num_refills += prefetcher->GetNumRefills();
+    result.num_underruns += prefetcher->GetNumUnderruns();
+  }
+  return result;
 }
 
-void Device::Stop(std::shared_ptr<PlayingStream> playing_stream,
-                  const StopControl& stop_control) {
-  if (!playing_stream) {
+Device::Stats Device::GetStats() const {
+  Stats result;
+  const CallbackCounters& counters = callback_counters_;
+  result.num_callbacks = counters.num_callbacks.load(std::memory_order_relaxed);
+  result.num_blocks_requested =
+      counters.num_blocks_requested.load(std::memory_order_relaxed);
+  result.num_blocks_delivered =
+      counters.num_blocks_delivered.load(std::memory_order_relaxed);
+  result.num_late_callbacks =
+      counters.num_late_callbacks.load(std::memory_order_relaxed);
+  result.num_underruns = GetStreamingStats().num_underruns;
+  result.num_playing = num_playing_.load(std::memory_order_relaxed);
+  result.peak_num_playing =
+      counters.peak_num_playing.load(std::memory_order_relaxed);
+  result.num_virtual = num_virtual_.load(std::memory_order_relaxed);
+  result.num_clipped_samples =
+      counters.num_clipped_samples.load(std::memory_order_relaxed);
+  result.max_callback_time_us =
+      counters.max_callback_time_us.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kCallbackTimeHistogramSize; ++i) {
+    result.callback_time_histogram[i] =
+        counters.callback_time_histogram[i].load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+void Device::RenderOffline(size_t num_blocks, int16_t* blocks_out) {
+  if (backend_ != Backend::kNull) {
+    LOGE("[Symphony::Audio::Device] RenderOffline() needs Backend::kNull");
     return;
   }
 
-  PlayingStreamInternal* playing_stream_internal =
-      static_cast<PlayingStreamInternal*>(playing_stream.get());
+  flushPendingCommands();
+
+  size_t num_blocks_rendered = 0;
+  while (num_blocks_rendered < num_blocks) {
+    size_t num_blocks_to_render =
+        std::min(num_blocks - num_blocks_rendered, mix_buffer_.size());
+
+    for (auto& prefetcher : prefetchers_) {
+      prefetcher->Fill();
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    fillMixBuffer(num_blocks_to_render);
+    addToCounter(callback_counters_.num_clipped_samples,
+                 PackStereoSamples(
+                     (StereoBlock16*)(blocks_out + num_blocks_rendered * 2),
+                     &mix_buffer_[0], num_blocks_to_render));
+    addToCounter(callback_counters_.num_blocks_delivered,
+                 num_blocks_to_render);
+    updateStatsInCallback(start_time, num_blocks_to_render);
+    num_blocks_rendered += num_blocks_to_render;
+
+    releaseFinishedVoices();
+    flushPendingCommands();
+  }
+}
+
+bool Device::RenderToWaveFile(const std::string& file_path,
+                              size_t num_blocks) {
+  std::vector<int16_t> blocks(num_blocks * 2);
+  RenderOffline(num_blocks, blocks.data());
+  return SaveWave(file_path, kWaveFormatPcm, 2, sample_rate_, blocks.data(),
+                  num_blocks);
+}
+
+void Device::Stop(VoiceHandle voice, const StopControl& stop_control) {
+  if (!IsPlaying(voice)) {
+    return;
+  }
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  playing_stream_internal->stop_control = stop_control;
+  sendCommand(Command{.type = CommandType::kStop,
+                      .index = voice.index,
+                      .generation = voice.generation,
+                      .stop_control = stop_control});
 }
 
-void Device::StopImmediately(std::shared_ptr<PlayingStream> playing_stream) {
-  if (!playing_stream) {
+void Device::StopImmediately(VoiceHandle voice) {
+  if (!IsPlaying(voice)) {
     return;
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  playing_streams_.erase(playing_stream);
+  sendCommand(Command{.type = CommandType::kStopImmediately,
+                      .index = voice.index,
+                      .generation = voice.generation});
 }
 
 void Device::destroyAudioDevice(SDL_AudioStream* /*stream*/) {}
 
-void Device::startPlayingStream(
-    PlayingStreamInternal* playing_stream_internal) {
-  if (playing_stream_internal->fade_control.fade_in_time_sec > 0.0f) {
-    playing_stream_internal->gain_state = GainState::kAttack;
-  } else {
-    playing_stream_internal->gain_state = GainState::kSustain;
+size_t Device::getTotalBlocksToPlay(const WaveFile& wave_file,
+                                    const PlayCount& play_count) {
+  if (play_count.loop_infinite) {
+    return 0;
   }
+  return wave_file.GetNumBlocks() * play_count.num_repeats;
+}
 
-  if (!playing_stream_internal->play_count.loop_infinite) {
-    playing_stream_internal->total_blocks_to_play =
-        playing_stream_internal->wave_file->GetNumBlocks() *
-        playing_stream_internal->play_count.num_repeats;
-  } else {
-    playing_stream_internal->total_blocks_to_play = 0;
-  }
+float Device::getMergedTriggersVolume(int num_triggers) {
+  return std::sqrt((float)num_triggers);
 }
 
-int32_t Device::updateGainStateInCallback(
-    PlayingStreamInternal* playing_stream_internal) {
+int32_t Device::updateGainStateInCallback(Voice& voice) {
   int32_t gain = kMaxGain;
 
   // Time to stop, stop_control_in_callback works like one-off signal:
-  if (playing_stream_internal->stop_control_in_callback.has_value()) {
-    const StopControl& stop_control =
-        playing_stream_internal->stop_control_in_callback.value();
+  if (voice.stop_control_in_callback.has_value()) {
+    const StopControl& stop_control = voice.stop_control_in_callback.value();
 
-    playing_stream_internal->fade_control.fade_out_time_sec =
+    voice.fade_control.fade_out_time_sec =
         stop_control.fade_out_time_sec.value_or(
-            playing_stream_internal->fade_control.fade_out_time_sec);
+            voice.fade_control.fade_out_time_sec);
 
     size_t num_blocks_left = 0;
     if (stop_control.stop_at_end) {
-      num_blocks_left = playing_stream_internal->wave_file->GetNumBlocks() -
-                        playing_stream_internal->looped_blocks_streamed;
-      if (playing_stream_internal->total_blocks_to_play) {
+      num_blocks_left =
+          voice.wave_file->GetNumBlocks() - voice.looped_blocks_streamed;
+      if (voice.total_blocks_to_play) {
         size_t num_blocks_left_to_play =
-            playing_stream_internal->total_blocks_to_play -
-            playing_stream_internal->total_blocks_streamed;
+            voice.total_blocks_to_play - voice.total_blocks_streamed;
         if (num_blocks_left_to_play < num_blocks_left) {
           num_blocks_left = num_blocks_left_to_play;
         }
@@ -308,188 +1182,336 @@ int32_t Device::updateGainStateInCallback(
     }
 
     if (num_blocks_left == 0) {
-      num_blocks_left = static_cast<size_t>(
-          playing_stream_internal->wave_file->GetSampleRate() *
-          playing_stream_internal->fade_control.fade_out_time_sec);
+      num_blocks_left =
+          static_cast<size_t>(voice.wave_file->GetSampleRate() *
+                              voice.fade_control.fade_out_time_sec);
     }
 
-    size_t num_blocks_to_fade_out = static_cast<size_t>(
-        playing_stream_internal->wave_file->GetSampleRate() *
-        playing_stream_internal->fade_control.fade_out_time_sec);
+    size_t num_blocks_to_fade_out =
+        static_cast<size_t>(voice.wave_file->GetSampleRate() *
+                            voice.fade_control.fade_out_time_sec);
     if (num_blocks_left < num_blocks_to_fade_out) {
-      playing_stream_internal->fade_control.fade_out_time_sec =
+      voice.fade_control.fade_out_time_sec =
           static_cast<float>(num_blocks_left) /
-          static_cast<float>(
-              playing_stream_internal->wave_file->GetSampleRate());
+          static_cast<float>(voice.wave_file->GetSampleRate());
     }
 
-    playing_stream_internal->total_blocks_to_play =
-        playing_stream_internal->total_blocks_streamed + num_blocks_left;
+    voice.total_blocks_to_play = voice.total_blocks_streamed + num_blocks_left;
 
-    if (playing_stream_internal->gain_state == GainState::kRelease) {
-      playing_stream_internal->gain_at_release =
-          playing_stream_internal->cur_gain;
+    if (voice.gain_state == GainState::kRelease) {
+      voice.gain_at_release = voice.cur_gain;
     }
 
-    playing_stream_internal->stop_control_in_callback = std::nullopt;
+    voice.stop_control_in_callback = std::nullopt;
   }
 
-  if (playing_stream_internal->gain_state == GainState::kAttack) {
+  if (voice.gain_state == GainState::kAttack) {
     // It should be possible to switch to GainState::kRelease in
     // GainState::kAttack too.
-    if (playing_stream_internal->total_blocks_to_play) {
-      size_t num_blocks_to_fade_out = static_cast<size_t>(
-          playing_stream_internal->wave_file->GetSampleRate() *
-          playing_stream_internal->fade_control.fade_out_time_sec);
-
-      if (playing_stream_internal->total_blocks_streamed +
-              num_blocks_to_fade_out >
-          playing_stream_internal->total_blocks_to_play) {
-        playing_stream_internal->gain_at_release =
-            playing_stream_internal->cur_gain;
-        playing_stream_internal->gain_state = GainState::kRelease;
+    if (voice.total_blocks_to_play) {
+      size_t num_blocks_to_fade_out =
+          static_cast<size_t>(voice.wave_file->GetSampleRate() *
+                              voice.fade_control.fade_out_time_sec);
+
+      if (voice.total_blocks_streamed + num_blocks_to_fade_out >
+          voice.total_blocks_to_play) {
+        voice.gain_at_release = voice.cur_gain;
+        voice.gain_state = GainState::kRelease;
       }
     }
   }
 
-  if (playing_stream_internal->gain_state == GainState::kAttack) {
+  if (voice.gain_state == GainState::kAttack) {
     // We didn't switch previously, checks end of GainState::kAttack state:
     size_t num_blocks_to_fade_in =
-        (size_t)(playing_stream_internal->wave_file->GetSampleRate() *
-                 playing_stream_internal->fade_control.fade_in_time_sec);
-    if (playing_stream_internal->total_blocks_streamed >
-        num_blocks_to_fade_in) {
-      playing_stream_internal->cur_gain = 1.0f;
+        (size_t)(voice.wave_file->GetSampleRate() *
+                 voice.fade_control.fade_in_time_sec);
+    if (voice.total_blocks_streamed > num_blocks_to_fade_in) {
+      voice.cur_gain = 1.0f;
       gain = kMaxGain;
 
-      playing_stream_internal->gain_state = GainState::kSustain;
+      voice.gain_state = GainState::kSustain;
     } else {
-      playing_stream_internal->cur_gain =
-          (float)playing_stream_internal->total_blocks_streamed /
-          (float)num_blocks_to_fade_in;
-      gain = ToIntGain(playing_stream_internal->cur_gain);
+      voice.cur_gain =
+          (float)voice.total_blocks_streamed / (float)num_blocks_to_fade_in;
+      gain = ToIntGain(voice.cur_gain);
     }
   }
 
-  if (playing_stream_internal->gain_state == GainState::kSustain) {
-    if (playing_stream_internal->fade_control.fade_out_time_sec > 0.0f) {
-      if (playing_stream_internal->total_blocks_to_play) {
+  if (voice.gain_state == GainState::kSustain) {
+    if (voice.fade_control.fade_out_time_sec > 0.0f) {
+      if (voice.total_blocks_to_play) {
         size_t num_blocks_to_fade_out =
-            (size_t)(playing_stream_internal->wave_file->GetSampleRate() *
-                     playing_stream_internal->fade_control.fade_out_time_sec);
-
-        if (playing_stream_internal->total_blocks_streamed +
-                num_blocks_to_fade_out >
-            playing_stream_internal->total_blocks_to_play) {
-          playing_stream_internal->gain_at_release =
-              playing_stream_internal->cur_gain;
-          playing_stream_internal->gain_state = GainState::kRelease;
+            (size_t)(voice.wave_file->GetSampleRate() *
+                     voice.fade_control.fade_out_time_sec);
+
+        if (voice.total_blocks_streamed + num_blocks_to_fade_out >
+            voice.total_blocks_to_play) {
+          voice.gain_at_release = voice.cur_gain;
+          voice.gain_state = GainState::kRelease;
         }
       }
     }
   }
 
-  if (playing_stream_internal->gain_state == GainState::kRelease) {
-    if (playing_stream_internal->total_blocks_streamed >=
-        playing_stream_internal->total_blocks_to_play) {
-      playing_stream_internal->cur_gain = 0.0f;
+  if (voice.gain_state == GainState::kRelease) {
+    if (voice.total_blocks_streamed >= voice.total_blocks_to_play) {
+      voice.cur_gain = 0.0f;
       gain = 0;
     } else {
       size_t num_blocks_to_fade_out =
-          (size_t)(playing_stream_internal->wave_file->GetSampleRate() *
-                   playing_stream_internal->fade_control.fade_out_time_sec);
+          (size_t)(voice.wave_file->GetSampleRate() *
+                   voice.fade_control.fade_out_time_sec);
 
-      if (playing_stream_internal->total_blocks_streamed +
-              num_blocks_to_fade_out >=
-          playing_stream_internal->total_blocks_to_play) {
+      if (voice.total_blocks_streamed + num_blocks_to_fade_out >=
+          voice.total_blocks_to_play) {
         size_t num_blocks_left_to_play =
-            playing_stream_internal->total_blocks_to_play -
-            playing_stream_internal->total_blocks_streamed;
-        playing_stream_internal->cur_gain =
+            voice.total_blocks_to_play - voice.total_blocks_streamed;
+        voice.cur_gain =
             ((float)num_blocks_left_to_play / (float)num_blocks_to_fade_out) *
-            playing_stream_internal->gain_at_release;
+            voice.gain_at_release;
       }
 
-      gain = ToIntGain(playing_stream_internal->cur_gain);
+      gain = ToIntGain(voice.cur_gain);
     }
   }
 
+  if (voice.volume != 1.0f) {
+    gain = (int32_t)((float)gain * voice.volume);
+  }
+
   return gain;
 }
 
-void Device::accumulateStereoSamples(StereoBlock32* accumulate_buffer,
-                                     const StereoBlock16* stream,
-                                     size_t num_blocks) {
-  for (size_t i = 0; i < num_blocks; ++i) {
-    accumulate_buffer[i].left += stream[i].left;
-    accumulate_buffer[i].right += stream[i].right;
-  }
+void Device::addToCounter(std::atomic<uint32_t>& counter, size_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + (uint32_t)value,
+                std::memory_order_relaxed);
 }
 
-void Device::accumulateStereoSamplesWithGain(StereoBlock32* accumulate_buffer,
-                                             int32_t gain,
-                                             const StereoBlock16* stream,
-                                             size_t num_blocks) {
-  for (size_t i = 0; i < num_blocks; ++i) {
-    accumulate_buffer[i].left += ApplyGain(stream[i].left, gain);
-    accumulate_buffer[i].right += ApplyGain(stream[i].right, gain);
+StereoGainRamp Device::updateGainRampInCallback(Voice& voice, int32_t gain,
+                                                size_t num_blocks) {
+  // Pan turns down one channel only, the center keeps the full gain in both:
+  // sounds which are not panned play as before.
+  gain = std::clamp(gain, 0, kMaxRampGain);
+  int32_t left_gain = gain;
+  int32_t right_gain = gain;
+  if (voice.pan > 0.0f) {
+    left_gain = (int32_t)((float)gain * (1.0f - voice.pan));
+  } else if (voice.pan < 0.0f) {
+    right_gain = (int32_t)((float)gain * (1.0f + voice.pan));
   }
-}
 
-void Device::accumulateMonoSamples(StereoBlock32* accumulate_buffer,
-                                   const int16_t* stream, size_t num_blocks) {
-  for (size_t i = 0; i < num_blocks; ++i) {
-    accumulate_buffer[i].left += stream[i];
-    accumulate_buffer[i].right += stream[i];
+  if (!voice.has_last_gains) {
+    voice.last_left_gain = left_gain;
+    voice.last_right_gain = right_gain;
+    voice.has_last_gains = true;
   }
-}
 
-void Device::accumulateMonoSamplesWithGain(StereoBlock32* accumulate_buffer,
-                                           int32_t gain, const int16_t* stream,
-                                           size_t num_blocks) {
-  for (size_t i = 0; i < num_blocks; ++i) {
-    accumulate_buffer[i].left += ApplyGain(stream[i], gain);
-    accumulate_buffer[i].right += ApplyGain(stream[i], gain);
-  }
+  StereoGainRamp ramp =
+      GetStereoGainRamp(voice.last_left_gain, voice.last_right_gain, left_gain,
+                        right_gain, num_blocks);
+  voice.last_left_gain = left_gain;
+  voice.last_right_gain = right_gain;
+  return ramp;
 }
 
-void Device::accumulateSamples(StereoBlock32* accumulate_buffer, int32_t gain,
+void Device::accumulateSamples(StereoBlock32* accumulate_buffer,
+                               const StereoGainRamp& ramp,
                                size_t num_channels, const int16_t* stream,
                                size_t num_blocks) {
+  // Steady gain which is the same in both channels has cheaper kernels.
+  bool is_steady = !ramp.left_step && !ramp.right_step &&
+                   ramp.left_start == ramp.right_start;
+  int32_t gain = ramp.left_start >> kGainRampFractionBits;
+
   if (num_channels == 1) {
-    if (gain == kMaxGain) {
-      accumulateMonoSamples(accumulate_buffer, stream, num_blocks);
+    if (!is_steady) {
+      AccumulateMonoSamplesWithRamp(accumulate_buffer, ramp, stream,
+                                    num_blocks);
+    } else if (gain == kMaxGain) {
+      AccumulateMonoSamples(accumulate_buffer, stream, num_blocks);
     } else {
-      accumulateMonoSamplesWithGain(accumulate_buffer, gain, stream,
+      AccumulateMonoSamplesWithGain(accumulate_buffer, gain, stream,
                                     num_blocks);
     }
   } else if (num_channels == 2) {
     const StereoBlock16* stereo_blocks_16 = (const StereoBlock16*)stream;
-    if (gain == kMaxGain) {
-      accumulateStereoSamples(accumulate_buffer, stereo_blocks_16, num_blocks);
+    if (!is_steady) {
+      AccumulateStereoSamplesWithRamp(accumulate_buffer, ramp,
+                                      stereo_blocks_16, num_blocks);
+    } else if (gain == kMaxGain) {
+      AccumulateStereoSamples(accumulate_buffer, stereo_blocks_16, num_blocks);
     } else {
-      accumulateStereoSamplesWithGain(accumulate_buffer, gain, stereo_blocks_16,
+      AccumulateStereoSamplesWithGain(accumulate_buffer, gain, stereo_blocks_16,
                                       num_blocks);
     }
   }
 }
 
-void Device::allocateMixBuffer(size_t num_blocks) {
-  if (mix_buffer_.size() < num_blocks) {
-    mix_buffer_.resize(num_blocks);
+void Device::allocateBuffers(size_t num_blocks) {
+  mix_buffer_.resize(num_blocks);
+  voice_buffer_.resize(num_blocks);
+  for (size_t bus = kMasterBus; bus < kMaxBuses; ++bus) {
+    bus_buffers_[bus].resize(num_blocks);
+  }
+  send_buffer_.resize(num_blocks);
+}
+
+uint32_t Device::getNextGeneration() {
+  ++last_generation_;
+  if (last_generation_ == 0) {
+    ++last_generation_;
+  }
+  return last_generation_;
+}
+
+bool Device::findVoiceToSteal(int priority, uint32_t& index_out) const {
+  bool found = false;
+  int victim_priority = 0;
+  int32_t victim_gain = 0;
+  for (size_t i = 0; i < voice_slots_.size(); ++i) {
+    const VoiceSlot& slot = voice_slots_[i];
+    // Voice which was stolen recently is skipped until callback confirms it,
+    // so that a voice has at most one stolen generation in flight.
+    if (!slot.is_playing || slot.stolen_generation ||
+        slot.priority > priority) {
+      continue;
+    }
+
+    int32_t gain = published_gains_[i].load(std::memory_order_relaxed);
+    if (!found || slot.priority < victim_priority ||
+        (slot.priority == victim_priority && gain < victim_gain)) {
+      found = true;
+      victim_priority = slot.priority;
+      victim_gain = gain;
+      index_out = (uint32_t)i;
+    }
+  }
+  return found;
+}
+
+void Device::sendCommand(const Command& command) {
+  // Keeps order of commands: nothing goes to the queue while older commands
+  // are waiting.
+  flushPendingCommands();
+  if (!pending_commands_.empty() || !commands_.Push(command)) {
+    pending_commands_.push_back(command);
+  }
+}
+
+void Device::flushPendingCommands() {
+  size_t num_sent = 0;
+  while (num_sent < pending_commands_.size() &&
+         commands_.Push(pending_commands_[num_sent])) {
+    ++num_sent;
+  }
+  pending_commands_.erase(pending_commands_.begin(),
+                          pending_commands_.begin() + num_sent);
+}
+
+void Device::releaseFinishedVoices() {
+  FinishedVoice finished;
+  while (finished_voices_.Pop(finished)) {
+    VoiceSlot& slot = voice_slots_[finished.index];
+    if (slot.stolen_generation &&
+        slot.stolen_generation == finished.generation) {
+      if (slot.stolen_prefetcher) {
+        removePrefetcher(slot.stolen_prefetcher);
+      }
+      slot.stolen_generation = 0;
+      slot.stolen_wave_file.reset();
+      slot.stolen_prefetcher.reset();
+      slot.stolen_preroll.reset();
+    } else if (slot.is_playing && slot.generation == finished.generation) {
+      if (slot.prefetcher) {
+        removePrefetcher(slot.prefetcher);
+      }
+      slot.is_playing = false;
+      slot.wave_file.reset();
+      slot.prefetcher.reset();
+      slot.preroll.reset();
+      free_voices_.push_back(finished.index);
+    }
+  }
+}
+
+void Device::startLoader() {
+#if !defined(__EMSCRIPTEN__)
+  loader_stop_ = false;
+  loader_thread_ = std::thread(&Device::loaderThread, this);
+#endif
+}
+
+void Device::stopLoader() {
+  if (!loader_thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(prefetchers_mutex_);
+    loader_stop_ = true;
+  }
+  loader_cv_.notify_one();
+  loader_thread_.join();
+}
+
+void Device::loaderThread() {
+  std::vector<std::shared_ptr<WavePrefetcher>> prefetchers;
+  std::vector<std::shared_ptr<Preroll>> prerolls;
+
+  std::unique_lock<std::mutex> lock(prefetchers_mutex_);
+  while (!loader_stop_) {
+    prefetchers = prefetchers_;
+    prerolls.swap(prerolls_);
+
+    // File reads don't block game thread.
+    lock.unlock();
+    for (auto& prefetcher : prefetchers) {
+      prefetcher->Fill();
+    }
+    // Prefetchers of streams which are prerolled are filled above.
+    for (auto& preroll : prerolls) {
+      readPreroll(*preroll);
+    }
+    prefetchers.clear();
+    prerolls.clear();
+    lock.lock();
+
+    loader_cv_.wait_for(lock, kLoaderPeriod);
   }
 }
 
-void Device::allocateReadBuffer(size_t num_blocks) {
-  if (read_buffer_.size() < num_blocks * 2) {
-    read_buffer_.resize(num_blocks * 2);
+void Device::addPrefetcher(const std::shared_ptr<WavePrefetcher>& prefetcher) {
+  {
+    std::lock_guard<std::mutex> lock(prefetchers_mutex_);
+    prefetchers_.push_back(prefetcher);
   }
+  loader_cv_.notify_one();
 }
 
-void Device::allocateSendBuffer(size_t num_blocks) {
-  if (send_buffer_.size() < num_blocks) {
-    send_buffer_.resize(num_blocks);
+void Device::removePrefetcher(
+    const std::shared_ptr<WavePrefetcher>& prefetcher) {
+  released_streaming_stats_.num_refills += prefetcher->GetNumRefills();
+  released_streaming_stats_.num_underruns += prefetcher->GetNumUnderruns();
+
+  std::lock_guard<std::mutex> lock(prefetchers_mutex_);
+  prefetchers_.erase(
+      std::remove(prefetchers_.begin(), prefetchers_.end(), prefetcher),
+      prefetchers_.end());
+}
+
+void Device::readPreroll(Preroll& preroll) {
+  const WaveFile& wave_file = *preroll.wave_file;
+  if (wave_file.IsMemoryMapped() && wave_file.IsInMemory()) {
+    const uint8_t* data = (const uint8_t*)wave_file.GetBufferWhenInMemory(0);
+    size_t size = preroll.num_blocks * wave_file.GetBlockSize();
+    volatile uint8_t page_byte = 0;
+    for (size_t offset = 0; offset < size; offset += kPrerollPageSize) {
+      page_byte = data[offset];
+    }
+    (void)page_byte;
   }
+  preroll.is_ready.store(true, std::memory_order_release);
 }
 
 void Device::dataCallback(void* userdata, SDL_AudioStream* /*stream*/,
@@ -497,138 +1519,477 @@ void Device::dataCallback(void* userdata, SDL_AudioStream* /*stream*/,
   if (additional_amount == 0) {
     return;
   }
+  auto start_time = std::chrono::steady_clock::now();
   auto* device = (Device*)userdata;
-  device->fillMixBuffer(additional_amount);
-  device->sendMixedToMainStream(additional_amount);
+  size_t num_requested_blocks = additional_amount / sizeof(StereoBlock16);
+  // Device may ask for more than its period, e.g. while converting the rate.
+  size_t num_blocks_mixed = 0;
+  while (num_blocks_mixed < num_requested_blocks) {
+    size_t num_blocks_to_mix = std::min(
+        num_requested_blocks - num_blocks_mixed, device->mix_buffer_.size());
+    device->fillMixBuffer(num_blocks_to_mix);
+    device->sendMixedToMainStream(num_blocks_to_mix);
+    num_blocks_mixed += num_blocks_to_mix;
+  }
+  device->updateStatsInCallback(start_time, num_requested_blocks);
 }
 
-void Device::fillMixBuffer(int bytes_amount) {
-  std::vector<std::shared_ptr<PlayingStream>> playing_streams_saved;
-  std::vector<int32_t> gains;
+void Device::processCommandsInCallback() {
+  Command command;
+  while (commands_.Pop(command)) {
+    if (command.type == CommandType::kPlay) {
+      startVoiceInCallback(command);
+      continue;
+    }
 
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
+    if (command.type == CommandType::kCreateBus ||
+        command.type == CommandType::kSetBusVolume ||
+        command.type == CommandType::kSetBusFilter) {
+      applyBusCommandInCallback(command);
+      continue;
+    }
 
-    playing_streams_saved.resize(playing_streams_.size());
+    Voice& voice = voices_[command.index];
+    if (!voice.is_active || voice.generation != command.generation) {
+      // Already finished.
+      continue;
+    }
 
-    for (size_t i = 0; auto playing_stream : playing_streams_) {
-      playing_streams_saved[i] = playing_stream;
-      ++i;
+    if (command.type == CommandType::kStop) {
+      voice.stop_control_in_callback = command.stop_control;
+    } else if (command.type == CommandType::kStopImmediately) {
+      finishVoiceInCallback(command.index);
+    } else if (command.type == CommandType::kSetVolume) {
+      voice.volume = command.volume;
+    } else if (command.type == CommandType::kSetPan) {
+      voice.pan = command.pan;
+    } else if (command.type == CommandType::kSetFilter) {
+      voice.filter.SetParams(command.filter, sample_rate_);
     }
+  }
+}
+
+void Device::startVoiceInCallback(const Command& command) {
+  Voice& voice = voices_[command.index];
+  if (voice.is_active) {
+    // Voice is stolen.
+    finishVoiceInCallback(command.index);
+  }
+
+  voice.generation = command.generation;
+  voice.wave_file = command.wave_file;
+  voice.prefetcher = command.prefetcher;
+  voice.play_count = command.play_count;
+  voice.num_plays = 0;
+  voice.fade_control = command.fade_control;
+  voice.looped_blocks_streamed = 0;
+  voice.total_blocks_streamed = 0;
+  voice.total_blocks_to_play =
+      getTotalBlocksToPlay(*voice.wave_file, voice.play_count);
+  voice.gain_state = voice.fade_control.fade_in_time_sec > 0.0f
+                         ? GainState::kAttack
+                         : GainState::kSustain;
+  voice.cur_gain = 1.0f;
+  voice.gain_at_release = 0.0f;
+  voice.volume = command.volume;
+  voice.pan = command.pan;
+  voice.has_last_gains = false;
+  voice.bus = command.bus;
+  voice.num_blocks_to_start = 0;
+  if (command.start_clock.has_value()) {
+    int32_t delay = (int32_t)(command.start_clock.value() -
+                              mix_position_.load(std::memory_order_relaxed));
+    if (delay > 0) {
+      voice.num_blocks_to_start = (size_t)delay;
+    }
+  }
+  voice.stop_control_in_callback = std::nullopt;
+  voice.preroll = command.preroll;
+  voice.crossfade_from = command.crossfade_from;
+  voice.filter.SetParams(kNoFilter, sample_rate_);
+  voice.filter.Reset();
+
+  voice.is_active = true;
+  voice.active_position = active_voices_.size();
+  active_voices_.push_back(command.index);
+}
 
-    gains.resize(playing_streams_saved.size());
-    for (size_t i = 0; i < playing_streams_saved.size(); ++i) {
-      PlayingStreamInternal* playing_stream_internal =
-          static_cast<PlayingStreamInternal*>(playing_streams_saved[i].get());
+void Device::finishVoiceInCallback(uint32_t index) {
+  Voice& voice = voices_[index];
 
-      if (playing_stream_internal->stop_control.has_value()) {
-        playing_stream_internal->stop_control_in_callback =
-            playing_stream_internal->stop_control;
-        playing_stream_internal->stop_control = std::nullopt;
+  // Finished queue is sized to hold every generation that can be in flight.
+  finished_voices_.Push(
+      FinishedVoice{.index = index, .generation = voice.generation});
+  published_gains_[index].store(0, std::memory_order_relaxed);
+
+  uint32_t last_index = active_voices_.back();
+  active_voices_[voice.active_position] = last_index;
+  voices_[last_index].active_position = voice.active_position;
+  active_voices_.pop_back();
+
+  voice.is_active = false;
+  voice.wave_file = nullptr;
+  voice.prefetcher = nullptr;
+  voice.preroll = nullptr;
+}
+
+void Device::startCrossfadesInCallback() {
+  for (uint32_t index : active_voices_) {
+    Voice& voice = voices_[index];
+    if (!voice.preroll ||
+        !voice.preroll->is_ready.load(std::memory_order_acquire)) {
+      continue;
+    }
+    voice.preroll = nullptr;
+
+    // Both fades start at the first block of this buffer.
+    VoiceHandle from = voice.crossfade_from;
+    if (from.IsValid() && from.index < voices_.size()) {
+      Voice& from_voice = voices_[from.index];
+      if (from_voice.is_active && from_voice.generation == from.generation) {
+        from_voice.stop_control_in_callback =
+            StopFade(voice.fade_control.fade_in_time_sec);
       }
+    }
+  }
+}
+
+void Device::applyBusCommandInCallback(const Command& command) {
+  Bus& bus = buses_[command.bus];
+  if (command.type == CommandType::kCreateBus) {
+    bus = Bus();
+    bus.parent = command.parent_bus;
+    num_buses_in_callback_ = std::max(num_buses_in_callback_, command.bus + 1);
+  } else if (command.type == CommandType::kSetBusVolume) {
+    bus.target_volume = command.volume;
+    bus.num_fade_blocks_left =
+        (size_t)(command.fade_time_sec * (float)sample_rate_);
+    if (!bus.num_fade_blocks_left) {
+      // Volume set without a fade applies from the first block.
+      bus.volume = bus.target_volume;
+      bus.last_gain = std::clamp(ToIntGain(bus.volume), 0, kMaxRampGain);
+    }
+  } else if (command.type == CommandType::kSetBusFilter) {
+    bus.filter.SetParams(command.filter, sample_rate_);
+  }
+}
+
+void Device::updateBusGainsInCallback(size_t num_blocks) {
+  // Parents have lower indices, so they are updated first.
+  for (size_t i = 0; i < num_buses_in_callback_; ++i) {
+    Bus& bus = buses_[i];
+    if (bus.num_fade_blocks_left) {
+      size_t num_fade_blocks = std::min(num_blocks, bus.num_fade_blocks_left);
+      bus.volume += (bus.target_volume - bus.volume) *
+                    (float)num_fade_blocks / (float)bus.num_fade_blocks_left;
+      bus.num_fade_blocks_left -= num_fade_blocks;
+    }
+
+    // Ramps to the volume at the end of the buffer, the fade within the
+    // buffer is linear anyway.
+    int32_t gain = std::clamp(ToIntGain(bus.volume), 0, kMaxRampGain);
+    bus.gain_ramp =
+        GetStereoGainRamp(bus.last_gain, bus.last_gain, gain, gain, num_blocks);
+    bus.gain = std::max(bus.last_gain, gain);
+    bus.last_gain = gain;
+    bus.total_gain = i == kMasterBus
+                         ? bus.gain
+                         : ApplyGain(buses_[bus.parent].total_gain, bus.gain);
+    bus.is_mixed = false;
+  }
+}
+
+bool Device::isMasterBusBufferedInCallback() const {
+  const Bus& master = buses_[kMasterBus];
+  return master.gain != kMaxGain || master.last_gain != kMaxGain;
+}
 
-      // We apply gain to the whole buffer while it is very small.
-      gains[i] = updateGainStateInCallback(playing_stream_internal);
+void Device::updateVirtualVoicesInCallback() {
+  size_t num_active_voices = active_voices_.size();
+  size_t num_audible_voices = 0;
+  for (size_t i = 0; i < num_active_voices; ++i) {
+    Voice& voice = voices_[active_voices_[i]];
+    // Loudest of the channels, at the start or at the end of the ramp.
+    const StereoGainRamp& ramp = gain_ramps_[i];
+    int32_t gain = std::max({ramp.left_start >> kGainRampFractionBits,
+                             ramp.right_start >> kGainRampFractionBits,
+                             voice.last_left_gain, voice.last_right_gain});
+    audible_gains_[i] = ApplyGain(gain, buses_[voice.bus].total_gain);
+
+    voice.is_virtual = audible_gains_[i] < kMinAudibleGain;
+    if (!voice.is_virtual) {
+      audible_voices_[num_audible_voices++] = (uint32_t)i;
     }
   }
 
-  std::unordered_set<std::shared_ptr<PlayingStream>> to_delete;
+  size_t max_real_voices = max_real_voices_.load(std::memory_order_relaxed);
+  if (max_real_voices && num_audible_voices > max_real_voices) {
+    // The loudest stay real.
+    auto audible_begin = audible_voices_.begin();
+    std::nth_element(audible_begin, audible_begin + max_real_voices,
+                     audible_begin + num_audible_voices,
+                     [this](uint32_t a, uint32_t b) {
+                       return audible_gains_[a] > audible_gains_[b];
+                     });
+    for (size_t i = max_real_voices; i < num_audible_voices; ++i) {
+      voices_[active_voices_[audible_voices_[i]]].is_virtual = true;
+    }
+    num_audible_voices = max_real_voices;
+  }
 
-  size_t num_requested_blocks = bytes_amount / (sizeof(StereoBlock16));
+  num_virtual_.store((uint32_t)(num_active_voices - num_audible_voices),
+                     std::memory_order_relaxed);
+}
 
-  allocateMixBuffer(num_requested_blocks);
-  allocateReadBuffer(num_requested_blocks);
+StereoBlock32* Device::getBusBufferInCallback(size_t bus, size_t num_blocks) {
+  if (bus == kMasterBus && !isMasterBusBufferedInCallback()) {
+    return &mix_buffer_[0];
+  }
+
+  std::vector<StereoBlock32>& bus_buffer = bus_buffers_[bus];
+  if (!buses_[bus].is_mixed) {
+    std::fill(bus_buffer.begin(), bus_buffer.begin() + num_blocks,
+              StereoBlock32{.left = 0, .right = 0});
+    buses_[bus].is_mixed = true;
+  }
+  return &bus_buffer[0];
+}
+
+void Device::mixBusesInCallback(size_t num_blocks) {
+  // Children have higher indices, so they are mixed before their parents,
+  // the master bus is mixed to mix_buffer_ last.
+  for (size_t i = num_buses_in_callback_; i-- > kMasterBus;) {
+    Bus& bus = buses_[i];
+    if (!bus.is_mixed) {
+      continue;
+    }
+
+    if (bus.filter.IsActive()) {
+      bus.filter.Process(&bus_buffers_[i][0], num_blocks);
+    }
+
+    StereoBlock32* parent_buffer =
+        i == kMasterBus ? &mix_buffer_[0]
+                        : getBusBufferInCallback(bus.parent, num_blocks);
+    const StereoGainRamp& ramp = bus.gain_ramp;
+    if ((ramp.left_start >> kGainRampFractionBits) != bus.last_gain) {
+      AccumulateMixedSamplesWithRamp(parent_buffer, ramp, &bus_buffers_[i][0],
+                                     num_blocks);
+    } else if (bus.gain == kMaxGain) {
+      AccumulateMixedSamples(parent_buffer, &bus_buffers_[i][0], num_blocks);
+    } else {
+      AccumulateMixedSamplesWithGain(parent_buffer, bus.gain,
+                                     &bus_buffers_[i][0], num_blocks);
+    }
+  }
+
+  // Master bus mixed straight to mix_buffer_ is filtered in place.
+  if (!buses_[kMasterBus].is_mixed && buses_[kMasterBus].filter.IsActive()) {
+    buses_[kMasterBus].filter.Process(&mix_buffer_[0], num_blocks);
+  }
+}
+
+void Device::fillMixBuffer(size_t num_requested_blocks) {
+  auto start_time = std::chrono::steady_clock::now();
+
+  processCommandsInCallback();
+  startCrossfadesInCallback();
+
+  size_t num_active_voices = active_voices_.size();
+  if (num_active_voices >
+      callback_counters_.peak_num_playing.load(std::memory_order_relaxed)) {
+    callback_counters_.peak_num_playing.store((uint32_t)num_active_voices,
+                                              std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < num_active_voices; ++i) {
+    // Gains are updated once per buffer and ramped over it.
+    Voice& voice = voices_[active_voices_[i]];
+    gains_[i] = updateGainStateInCallback(voice);
+    gain_ramps_[i] =
+        updateGainRampInCallback(voice, gains_[i], num_requested_blocks);
+    published_gains_[active_voices_[i]].store(gains_[i],
+                                              std::memory_order_relaxed);
+  }
 
   for (size_t i = 0; i < num_requested_blocks; ++i) {
     mix_buffer_[i].left = 0;
     mix_buffer_[i].right = 0;
   }
 
-  for (size_t playing_stream_index = 0;
-       playing_stream_index < playing_streams_saved.size();
-       ++playing_stream_index) {
-    PlayingStreamInternal* playing_stream_internal =
-        static_cast<PlayingStreamInternal*>(
-            playing_streams_saved[playing_stream_index].get());
+  updateBusGainsInCallback(num_requested_blocks);
+  updateVirtualVoicesInCallback();
+
+  // Iterates backwards: finished voices are swapped with the last one.
+  for (size_t active_position = num_active_voices; active_position-- > 0;) {
+    uint32_t index = active_voices_[active_position];
+    Voice& voice = voices_[index];
+    if (voice.preroll) {
+      // Waits for the preroll silently, without moving forward.
+      continue;
+    }
 
+    const StereoGainRamp& ramp = gain_ramps_[active_position];
+    size_t num_channels = voice.wave_file->GetNumChannels();
+    StereoBlock32* bus_buffer =
+        voice.is_virtual
+            ? nullptr
+            : getBusBufferInCallback(voice.bus, num_requested_blocks);
+    // Filtered voice is mixed alone first, then filtered into its bus.
+    StereoBlock32* voice_buffer = bus_buffer;
+    if (bus_buffer && voice.filter.IsActive()) {
+      voice_buffer = &voice_buffer_[0];
+      std::fill(voice_buffer_.begin(),
+                voice_buffer_.begin() + num_requested_blocks,
+                StereoBlock32{.left = 0, .right = 0});
+    }
+
+    // Scheduled voice starts inside of this buffer or later.
     size_t num_blocks_sent = 0;
+    if (voice.num_blocks_to_start) {
+      num_blocks_sent =
+          std::min(voice.num_blocks_to_start, num_requested_blocks);
+      voice.num_blocks_to_start -= num_blocks_sent;
+    }
     while (num_blocks_sent < num_requested_blocks) {
       bool reset_looped_blocks_streamed = false;
 
       size_t num_blocks_to_read = num_requested_blocks - num_blocks_sent;
-      if (num_blocks_to_read + playing_stream_internal->looped_blocks_streamed >
-          playing_stream_internal->wave_file->GetNumBlocks()) {
+      if (num_blocks_to_read + voice.looped_blocks_streamed >
+          voice.wave_file->GetNumBlocks()) {
         num_blocks_to_read =
-            playing_stream_internal->wave_file->GetNumBlocks() -
-            playing_stream_internal->looped_blocks_streamed;
+            voice.wave_file->GetNumBlocks() - voice.looped_blocks_streamed;
 
         reset_looped_blocks_streamed = true;
 
-        playing_stream_internal->num_plays += 1;
+        voice.num_plays += 1;
       }
 
-      const int16_t* read_buffer = 0;
-      if (playing_stream_internal->wave_file->IsInMemory()) {
-        read_buffer = playing_stream_internal->wave_file->GetBufferWhenInMemory(
-            playing_stream_internal->looped_blocks_streamed);
+      // Samples are accumulated straight from the wave file or from the
+      // prefetcher ring, without copying. Virtual voices only move forward.
+      if (voice.is_virtual) {
+        if (!voice.wave_file->IsInMemory()) {
+          voice.prefetcher->ReadInPlace(
+              num_blocks_to_read,
+              [](size_t /*first_block*/, const int16_t* /*blocks*/,
+                 size_t /*num_blocks*/) {});
+        }
+      } else if (voice.wave_file->IsInMemory()) {
+        accumulateSamples(voice_buffer + num_blocks_sent,
+                          AdvanceStereoGainRamp(ramp, num_blocks_sent),
+                          num_channels,
+                          voice.wave_file->GetBufferWhenInMemory(
+                              voice.looped_blocks_streamed),
+                          num_blocks_to_read);
       } else {
-        playing_stream_internal->wave_file->ReadBlocks(
-            playing_stream_internal->looped_blocks_streamed, num_blocks_to_read,
-            &read_buffer_[0]);
-        read_buffer = &read_buffer_[0];
+        StereoBlock32* accumulate_buffer = voice_buffer + num_blocks_sent;
+        StereoGainRamp read_ramp = AdvanceStereoGainRamp(ramp, num_blocks_sent);
+        // Blocks missing after underrun are silent.
+        voice.prefetcher->ReadInPlace(
+            num_blocks_to_read,
+            [accumulate_buffer, &read_ramp, num_channels](
+                size_t first_block, const int16_t* blocks, size_t num_blocks) {
+              accumulateSamples(accumulate_buffer + first_block,
+                                AdvanceStereoGainRamp(read_ramp, first_block),
+                                num_channels, blocks, num_blocks);
+            });
       }
 
-      playing_stream_internal->looped_blocks_streamed += num_blocks_to_read;
-      playing_stream_internal->total_blocks_streamed += num_blocks_to_read;
-
-      accumulateSamples(&mix_buffer_[num_blocks_sent],
-                        gains[playing_stream_index],
-                        playing_stream_internal->wave_file->GetNumChannels(),
-                        read_buffer, num_blocks_to_read);
+      voice.looped_blocks_streamed += num_blocks_to_read;
+      voice.total_blocks_streamed += num_blocks_to_read;
       num_blocks_sent += num_blocks_to_read;
 
       if (reset_looped_blocks_streamed) {
-        playing_stream_internal->looped_blocks_streamed = 0;
+        voice.looped_blocks_streamed = 0;
       }
 
       // Has total_blocks_to_play specified, can stop playing when reached:
-      if (playing_stream_internal->total_blocks_to_play) {
-        if (playing_stream_internal->total_blocks_streamed >=
-            playing_stream_internal->total_blocks_to_play) {
-          to_delete.insert(playing_streams_saved[playing_stream_index]);
+      if (voice.total_blocks_to_play) {
+        if (voice.total_blocks_streamed >= voice.total_blocks_to_play) {
+          finishVoiceInCallback(index);
           break;
         }
       }
     }
-  }
 
-  for (size_t i = 0; i < num_requested_blocks; ++i) {
-    mix_buffer_[i].left =
-        std::clamp(mix_buffer_[i].left, kSampleMin16, kSampleMax16);
-    mix_buffer_[i].right =
-        std::clamp(mix_buffer_[i].right, kSampleMin16, kSampleMax16);
+    if (voice_buffer != bus_buffer) {
+      voice.filter.Process(voice_buffer, num_requested_blocks);
+      AccumulateMixedSamples(bus_buffer, voice_buffer, num_requested_blocks);
+    }
   }
 
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto playing_stream_to_delete : to_delete) {
-      playing_streams_.erase(playing_stream_to_delete);
-    }
+  mixBusesInCallback(num_requested_blocks);
+
+  num_playing_.store((uint32_t)active_voices_.size(),
+                     std::memory_order_relaxed);
+  mix_position_.store(
+      mix_position_.load(std::memory_order_relaxed) +
+          (uint32_t)num_requested_blocks,
+      std::memory_order_relaxed);
+  publishClockInCallback(start_time, num_requested_blocks);
+}
+
+void Device::sendMixedToMainStream(size_t num_requested_blocks) {
+  addToCounter(callback_counters_.num_clipped_samples,
+               PackStereoSamples(&send_buffer_[0], &mix_buffer_[0],
+                                 num_requested_blocks));
+
+  if (SDL_PutAudioStreamData(sdl_audio_stream_.get(), send_buffer_.data(),
+                             (int)(num_requested_blocks *
+                                   sizeof(StereoBlock16)))) {
+    addToCounter(callback_counters_.num_blocks_delivered,
+                 num_requested_blocks);
   }
 }
 
-void Device::sendMixedToMainStream(int bytes_amount) {
-  size_t num_requested_blocks = bytes_amount / (sizeof(StereoBlock16));
+void Device::publishClockInCallback(
+    std::chrono::steady_clock::time_point start_time,
+    size_t num_requested_blocks) {
+  uint32_t time_us =
+      (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+          start_time - clock_origin_)
+          .count();
+
+  uint32_t sequence = clock_sequence_.load(std::memory_order_relaxed);
+  clock_sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  clock_position_.store(mix_position_.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+  clock_time_us_.store(time_us, std::memory_order_relaxed);
+  clock_num_blocks_.store((uint32_t)num_requested_blocks,
+                          std::memory_order_relaxed);
+  clock_sequence_.store(sequence + 2, std::memory_order_release);
+}
 
-  allocateSendBuffer(num_requested_blocks);
+void Device::updateStatsInCallback(
+    std::chrono::steady_clock::time_point start_time,
+    size_t num_requested_blocks) {
+  uint32_t callback_time_us =
+      (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start_time)
+          .count();
+
+  CallbackCounters& counters = callback_counters_;
+  addToCounter(counters.num_callbacks, 1);
+  addToCounter(counters.num_blocks_requested, num_requested_blocks);
+
+  // Time it takes to play the mixed blocks.
+  size_t budget_us = num_requested_blocks * 1000000 / (size_t)sample_rate_;
+  if (callback_time_us > budget_us) {
+    addToCounter(counters.num_late_callbacks, 1);
+  }
 
-  for (size_t i = 0; i < num_requested_blocks; ++i) {
-    send_buffer_[i].left = (int16_t)mix_buffer_[i].left;
-    send_buffer_[i].right = (int16_t)mix_buffer_[i].right;
+  if (callback_time_us >
+      counters.max_callback_time_us.load(std::memory_order_relaxed)) {
+    counters.max_callback_time_us.store(callback_time_us,
+                                        std::memory_order_relaxed);
   }
 
-  SDL_PutAudioStreamData(sdl_audio_stream_.get(), send_buffer_.data(),
-                         bytes_amount);
+  size_t bucket = 0;
+  while (bucket + 1 < kCallbackTimeHistogramSize &&
+         callback_time_us >= GetCallbackTimeBucketLimitUs(bucket)) {
+    ++bucket;
+  }
+  addToCounter(counters.callback_time_histogram[bucket], 1);
 }
 
 }  // namespace Audio
@@ -0,0 +1,79 @@
+// Renders the mix offline and reports how long it takes per output sample.
+//
+// Usage: audio_benchmark [num_seconds] [num_voices]
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "audio.hpp"
+
+using namespace Symphony::Audio;
+
+namespace {
+inline constexpr size_t kDefaultNumSeconds = 60;
+inline constexpr size_t kDefaultNumVoices = 32;
+
+// Saw tooth, 1 second long.
+std::shared_ptr<WaveFile> LoadTestWave(const std::string& file_path,
+                                       size_t num_channels) {
+  std::vector<int16_t> samples(Device::kDefaultSampleRate * num_channels);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = (int16_t)((i * 64) % 8192 - 4096);
+  }
+
+  SaveWave(file_path, kWaveFormatPcm, num_channels, Device::kDefaultSampleRate,
+           samples.data(), Device::kDefaultSampleRate);
+  return LoadWave(file_path, WaveFile::kModeLoadInMemory);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t num_seconds = argc > 1 ? (size_t)atoi(argv[1]) : kDefaultNumSeconds;
+  size_t num_voices = argc > 2 ? (size_t)atoi(argv[2]) : kDefaultNumVoices;
+
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::shared_ptr<WaveFile> wave_files[] = {
+      LoadTestWave((temp_dir / "audio_benchmark_mono.wav").string(), 1),
+      LoadTestWave((temp_dir / "audio_benchmark_stereo.wav").string(), 2),
+  };
+  for (const auto& wave_file : wave_files) {
+    if (!wave_file) {
+      std::cerr << "Can't create test wave files in: " << temp_dir
+                << std::endl;
+      return 1;
+    }
+  }
+
+  Device device;
+  device.Init(num_voices, Device::Backend::kNull);
+
+  // Half of the voices are faded in, so that both gain paths are measured.
+  for (size_t i = 0; i < num_voices; ++i) {
+    device.Play(wave_files[i % 2], kPlayLooped,
+                i % 4 < 2 ? kNoFade : FadeInOut((float)num_seconds, 0.0f));
+  }
+
+  size_t num_blocks = num_seconds * Device::kDefaultSampleRate;
+  std::vector<int16_t> blocks(num_blocks * 2);
+
+  auto start = std::chrono::steady_clock::now();
+  device.RenderOffline(num_blocks, blocks.data());
+  auto end = std::chrono::steady_clock::now();
+
+  double num_ns =
+      (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+
+  std::cout << "Mixing kernels: " << GetMixingKernelsName() << std::endl;
+  std::cout << "Rendered " << num_seconds << " s with "
+            << device.GetNumPlaying() << " voices in " << num_ns / 1e6
+            << " ms" << std::endl;
+  std::cout << "ns per output sample: " << num_ns / (double)num_blocks
+            << std::endl;
+
+  return 0;
+}
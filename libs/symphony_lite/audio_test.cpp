@@ -0,0 +1,588 @@
+#include "audio.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "wave_test_utils.hpp"
+
+using namespace Symphony::Audio;
+
+namespace {
+// Mono 16-bit wave file with samples 1000 + 0, 1000 + 1, ...
+std::shared_ptr<WaveFile> LoadTestWave(size_t num_blocks,
+                                       WaveFile::Mode mode) {
+  std::vector<int16_t> samples(num_blocks);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = (int16_t)(1000 + i);
+  }
+  return LoadWave(WriteTestWave("audio_test.wav", samples, 1,
+                                 Device::kDefaultSampleRate),
+                  mode);
+}
+
+std::vector<int16_t> Render(Device& device, size_t num_blocks) {
+  std::vector<int16_t> blocks(num_blocks * 2);
+  device.RenderOffline(num_blocks, blocks.data());
+  return blocks;
+}
+}  // namespace
+
+TEST(AudioDevice, RendersSoundOnceThenSilence) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  auto wave_file = LoadTestWave(700, WaveFile::kModeLoadInMemory);
+  ASSERT_TRUE(wave_file);
+
+  VoiceHandle voice = device.Play(wave_file, kPlayOnce);
+  ASSERT_TRUE(device.IsPlaying(voice));
+
+  std::vector<int16_t> blocks = Render(device, 1000);
+  for (size_t i = 0; i < 1000; ++i) {
+    int16_t expected = i < 700 ? (int16_t)(1000 + i) : 0;
+    ASSERT_EQ(blocks[i * 2], expected) << i;
+    ASSERT_EQ(blocks[i * 2 + 1], expected) << i;
+  }
+
+  ASSERT_FALSE(device.IsPlaying(voice));
+  ASSERT_EQ(device.GetNumPlaying(), 0);
+}
+
+TEST(AudioDevice, StreamedSoundMatchesSoundInMemory) {
+  Device in_memory_device;
+  in_memory_device.Init(4, Device::Backend::kNull);
+  in_memory_device.Play(LoadTestWave(3000, WaveFile::kModeLoadInMemory),
+                        PlayTimes(2));
+  std::vector<int16_t> expected = Render(in_memory_device, 7000);
+
+  Device streaming_device;
+  streaming_device.Init(4, Device::Backend::kNull);
+  streaming_device.Play(LoadTestWave(3000, WaveFile::kModeStreamingFromFile),
+                        PlayTimes(2));
+  ASSERT_EQ(Render(streaming_device, 7000), expected);
+  ASSERT_EQ(streaming_device.GetStreamingStats().num_underruns, 0);
+}
+
+TEST(AudioDevice, StopAtEndFinishesCurrentLoop) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  auto wave_file = LoadTestWave(1000, WaveFile::kModeLoadInMemory);
+  VoiceHandle voice = device.Play(wave_file, kPlayLooped);
+
+  Render(device, 1500);
+  device.Stop(voice, StopAtEnd());
+
+  std::vector<int16_t> blocks = Render(device, 1000);
+  ASSERT_EQ(blocks[0], 1500);
+  ASSERT_EQ(blocks[499 * 2], 1999);
+  ASSERT_EQ(blocks[500 * 2], 0);
+  ASSERT_FALSE(device.IsPlaying(voice));
+}
+
+TEST(AudioDevice, FadeInStartsFromSilence) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  // 1 second of fade in.
+  auto wave_file = LoadTestWave(Device::kDefaultSampleRate * 2,
+                                WaveFile::kModeLoadInMemory);
+  device.Play(wave_file, kPlayOnce, FadeInOut(1.0f, 0.0f));
+
+  std::vector<int16_t> first_chunk = Render(device, 512);
+  ASSERT_EQ(first_chunk[0], 0);
+
+  // Gain is updated once per rendered chunk.
+  Render(device, Device::kDefaultSampleRate / 2 - 1024);
+  std::vector<int16_t> middle_chunk = Render(device, 512);
+  int16_t sample = (int16_t)(1000 + Device::kDefaultSampleRate / 2 - 512);
+  ASSERT_GT(middle_chunk[0], sample / 3);
+  ASSERT_LT(middle_chunk[0], sample * 2 / 3);
+
+  Render(device, Device::kDefaultSampleRate);
+  std::vector<int16_t> sustain_chunk = Render(device, 512);
+  ASSERT_EQ(sustain_chunk[0],
+            (int16_t)(1000 + Device::kDefaultSampleRate * 3 / 2));
+}
+
+TEST(AudioDevice, StealsQuietestVoiceOfLowerPriority) {
+  Device device;
+  device.Init(2, Device::Backend::kNull);
+
+  auto wave_file = LoadTestWave(1000, WaveFile::kModeLoadInMemory);
+  VoiceHandle music = device.Play(wave_file, kPlayLooped, kNoFade,
+                                  kPriorityHigh);
+  VoiceHandle quiet = device.Play(wave_file, kPlayLooped,
+                                  FadeInOut(10.0f, 0.0f), kPriorityNormal);
+  Render(device, 512);
+
+  VoiceHandle low = device.Play(wave_file, kPlayOnce, kNoFade, kPriorityLow);
+  ASSERT_FALSE(low.IsValid());
+
+  VoiceHandle effect = device.Play(wave_file, kPlayOnce);
+  ASSERT_TRUE(effect.IsValid());
+  ASSERT_TRUE(device.IsPlaying(music));
+  ASSERT_FALSE(device.IsPlaying(quiet));
+  ASSERT_TRUE(device.IsPlaying(effect));
+
+  Render(device, 512);
+  ASSERT_EQ(device.GetNumPlaying(), 2);
+}
+
+TEST(AudioDevice, RendersToWaveFile) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+  device.Play(LoadTestWave(100, WaveFile::kModeLoadInMemory), kPlayOnce);
+
+  std::string file_path = ::testing::TempDir() + "audio_test_render.wav";
+  ASSERT_TRUE(device.RenderToWaveFile(file_path, 200));
+
+  auto rendered = LoadWave(file_path, WaveFile::kModeLoadInMemory);
+  ASSERT_TRUE(rendered);
+  ASSERT_EQ(rendered->GetNumChannels(), 2);
+  ASSERT_EQ(rendered->GetNumBlocks(), 200);
+  ASSERT_EQ(rendered->GetBufferWhenInMemory(99)[1], 1099);
+  ASSERT_EQ(rendered->GetBufferWhenInMemory(100)[0], 0);
+}
+
+TEST(AudioDevice, CountsRenderedBlocksVoicesAndClipping) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  // Two loud voices clip, one doesn't.
+  auto loud_wave_file = LoadWave(
+      WriteTestWave("audio_test_loud.wav", std::vector<int16_t>(100, 20000), 1,
+                    Device::kDefaultSampleRate),
+      WaveFile::kModeLoadInMemory);
+  device.Play(loud_wave_file, kPlayOnce);
+  Render(device, 100);
+  device.Play(loud_wave_file, kPlayOnce);
+  device.Play(loud_wave_file, kPlayOnce);
+  Render(device, 1000);
+
+  Device::Stats stats = device.GetStats();
+  ASSERT_EQ(stats.num_callbacks, 3);
+  ASSERT_EQ(stats.num_blocks_requested, 1100);
+  ASSERT_EQ(stats.num_blocks_delivered, 1100);
+  ASSERT_EQ(stats.num_playing, 0);
+  ASSERT_EQ(stats.peak_num_playing, 2);
+  ASSERT_EQ(stats.num_clipped_samples, 200);
+
+  uint32_t num_callbacks_in_histogram = 0;
+  for (uint32_t num_callbacks : stats.callback_time_histogram) {
+    num_callbacks_in_histogram += num_callbacks;
+  }
+  ASSERT_EQ(num_callbacks_in_histogram, 3);
+}
+
+TEST(AudioDevice, MergesTriggersWithinOneMixPeriod) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  LimitedSound sound(LoadTestWave(100, WaveFile::kModeLoadInMemory),
+                     SoundLimits());
+  VoiceHandle first = device.Trigger(sound);
+  VoiceHandle second = device.Trigger(sound);
+  VoiceHandle third = device.Trigger(sound);
+  ASSERT_TRUE(first.IsValid());
+  ASSERT_EQ(second.generation, first.generation);
+  ASSERT_EQ(third.generation, first.generation);
+
+  // One voice louder by sqrt(3).
+  std::vector<int16_t> blocks = Render(device, 100);
+  ASSERT_EQ(blocks[0], ApplyGain(1000, (int32_t)(128.0f * std::sqrt(3.0f))));
+  ASSERT_EQ(device.GetStats().peak_num_playing, 1);
+
+  // Next mix period starts a new voice.
+  VoiceHandle next = device.Trigger(sound);
+  ASSERT_TRUE(next.IsValid());
+  ASSERT_NE(next.generation, first.generation);
+}
+
+TEST(AudioDevice, LimitsInstancesOfSound) {
+  Device device;
+  device.Init(8, Device::Backend::kNull);
+
+  auto wave_file = LoadTestWave(10000, WaveFile::kModeLoadInMemory);
+  LimitedSound dropping(wave_file, SoundLimits{.max_instances = 2,
+                                               .min_retrigger_interval_sec = 0,
+                                               .steal_oldest = false});
+  VoiceHandle first = device.Trigger(dropping);
+  Render(device, 10);
+  device.Trigger(dropping);
+  Render(device, 10);
+  ASSERT_FALSE(device.Trigger(dropping).IsValid());
+  ASSERT_TRUE(device.IsPlaying(first));
+
+  LimitedSound stealing(wave_file, SoundLimits{.max_instances = 2,
+                                               .min_retrigger_interval_sec = 0,
+                                               .steal_oldest = true});
+  VoiceHandle oldest = device.Trigger(stealing);
+  Render(device, 10);
+  VoiceHandle newer = device.Trigger(stealing);
+  Render(device, 10);
+  VoiceHandle newest = device.Trigger(stealing);
+  ASSERT_TRUE(newest.IsValid());
+
+  // Oldest instance fades out quickly.
+  Render(device, 512);
+  ASSERT_FALSE(device.IsPlaying(oldest));
+  ASSERT_TRUE(device.IsPlaying(newer));
+  ASSERT_TRUE(device.IsPlaying(newest));
+}
+
+TEST(AudioDevice, LimitsVariationsAsOneSound) {
+  Device device;
+  device.Init(16, Device::Backend::kNull);
+
+  LimitedSound sound(
+      std::vector<std::shared_ptr<WaveFile>>{
+          LoadTestWave(10000, WaveFile::kModeLoadInMemory),
+          LoadTestWave(10000, WaveFile::kModeLoadInMemory),
+          LoadTestWave(10000, WaveFile::kModeLoadInMemory)},
+      SoundLimits{.max_instances = 2,
+                  .min_retrigger_interval_sec = 0,
+                  .steal_oldest = false});
+  ASSERT_TRUE(device.Trigger(sound).IsValid());
+  Render(device, 10);
+  ASSERT_TRUE(device.Trigger(sound).IsValid());
+  Render(device, 10);
+  // Instances of any variation count.
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_FALSE(device.Trigger(sound).IsValid());
+    Render(device, 10);
+  }
+  ASSERT_EQ(device.GetStats().peak_num_playing, 2);
+}
+
+TEST(AudioDevice, DropsTriggersWithinRetriggerInterval) {
+  Device device;
+  device.Init(8, Device::Backend::kNull);
+
+  LimitedSound sound(LoadTestWave(100, WaveFile::kModeLoadInMemory),
+                     SoundLimits{.max_instances = 0,
+                                 .min_retrigger_interval_sec = 0.1f,
+                                 .steal_oldest = false});
+  ASSERT_TRUE(device.Trigger(sound).IsValid());
+  Render(device, Device::kDefaultSampleRate / 20);
+  ASSERT_FALSE(device.Trigger(sound).IsValid());
+  Render(device, Device::kDefaultSampleRate / 10);
+  ASSERT_TRUE(device.Trigger(sound).IsValid());
+}
+
+TEST(AudioDevice, MixesBusesWithTheirVolume) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  size_t music_bus = device.CreateBus();
+  size_t sfx_bus = device.CreateBus();
+  size_t ducked_bus = device.CreateBus(sfx_bus);
+  ASSERT_NE(music_bus, kMasterBus);
+  ASSERT_NE(sfx_bus, kMasterBus);
+  ASSERT_NE(ducked_bus, kMasterBus);
+
+  auto wave_file = LoadTestWave(1000, WaveFile::kModeLoadInMemory);
+  device.Play(wave_file, kPlayLooped, kNoFade, kPriorityNormal, music_bus);
+  device.Play(wave_file, kPlayLooped, kNoFade, kPriorityNormal, ducked_bus);
+  device.SetBusVolume(sfx_bus, 0.5f);
+  device.SetBusVolume(ducked_bus, 0.5f);
+  ASSERT_EQ(device.GetBusVolume(sfx_bus), 0.5f);
+
+  std::vector<int16_t> blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], 1000 + ApplyGain(ApplyGain(1000, 64), 64));
+
+  device.SetBusVolume(sfx_bus, 0.0f);
+  blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], 1010);
+
+  device.SetBusVolume(kMasterBus, 0.5f);
+  blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], ApplyGain(1020, 64));
+}
+
+TEST(AudioDevice, FadesBusVolume) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  size_t bus = device.CreateBus();
+  device.Play(LoadTestWave(Device::kDefaultSampleRate,
+                           WaveFile::kModeLoadInMemory),
+              kPlayLooped, kNoFade, kPriorityNormal, bus);
+  device.SetBusVolume(bus, 0.0f, 1.0f);
+
+  // Volume is ramped over every rendered chunk.
+  std::vector<int16_t> blocks = Render(device, Device::kDefaultSampleRate / 2);
+  size_t last_chunk = Device::kDefaultSampleRate / 2 - 1;
+  ASSERT_GT(blocks[last_chunk * 2], (1000 + (int)last_chunk) / 3);
+  ASSERT_LT(blocks[last_chunk * 2], (1000 + (int)last_chunk) * 2 / 3);
+
+  blocks = Render(device, Device::kDefaultSampleRate / 2 + 512);
+  ASSERT_EQ(blocks[blocks.size() - 2], 0);
+  ASSERT_EQ(device.GetNumPlaying(), 1);
+}
+
+TEST(AudioDevice, RampsBusFadesWithinBuffers) {
+  for (bool is_master : {false, true}) {
+    Device device;
+    device.Init(4, Device::Backend::kNull, Device::kDefaultSampleRate, 512);
+
+    size_t bus = is_master ? kMasterBus : device.CreateBus();
+    device.Play(LoadTestWave(Device::kDefaultSampleRate,
+                             WaveFile::kModeLoadInMemory),
+                kPlayLooped, kNoFade, kPriorityNormal, bus);
+    device.SetBusVolume(bus, 0.0f, 0.25f);
+
+    // Goes down by at most one step of the gain per block, while samples go
+    // up by 1, instead of stepping at the start of every buffer.
+    std::vector<int16_t> blocks =
+        Render(device, Device::kDefaultSampleRate / 4);
+    for (size_t i = 1; i < blocks.size() / 2; ++i) {
+      int max_step = ApplyGain(1000 + (int)i, 1) + 1;
+      ASSERT_LE(blocks[i * 2] - blocks[(i - 1) * 2], 1) << i;
+      ASSERT_GE(blocks[i * 2] - blocks[(i - 1) * 2], -max_step) << i;
+    }
+    ASSERT_LT(blocks[blocks.size() - 2], 32);
+
+    blocks = Render(device, 512);
+    ASSERT_EQ(blocks[0], 0);
+  }
+}
+
+TEST(AudioDevice, StartsScheduledVoiceAtExactBlock) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+  auto wave_file = LoadTestWave(100, WaveFile::kModeLoadInMemory);
+
+  Render(device, 300);
+  ASSERT_EQ(device.GetAudioClock(), 300);
+
+  // Starts in the next rendered chunk and in the one after it.
+  device.Play(wave_file, kPlayOnce, kNoFade, kPriorityNormal, kMasterBus,
+              device.GetAudioClock() + 100);
+  device.Play(wave_file, kPlayOnce, kNoFade, kPriorityNormal, kMasterBus,
+              device.GetAudioClock() + 700);
+
+  std::vector<int16_t> blocks = Render(device, 512);
+  ASSERT_EQ(blocks[99 * 2], 0);
+  ASSERT_EQ(blocks[100 * 2], 1000);
+  ASSERT_EQ(blocks[199 * 2], 1099);
+  ASSERT_EQ(blocks[200 * 2], 0);
+  ASSERT_EQ(blocks[511 * 2], 0);
+
+  blocks = Render(device, 512);
+  ASSERT_EQ(blocks[187 * 2], 0);
+  ASSERT_EQ(blocks[188 * 2], 1000);
+}
+
+TEST(AudioDevice, StartsLateScheduledVoiceRightAway) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  Render(device, 300);
+  device.Play(LoadTestWave(100, WaveFile::kModeLoadInMemory), kPlayOnce,
+              kNoFade, kPriorityNormal, kMasterBus, 100);
+  std::vector<int16_t> blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], 1000);
+}
+
+TEST(AudioDevice, MixesInBuffersOfConfiguredSize) {
+  Device device;
+  device.Init(4, Device::Backend::kNull, 44100, 256);
+  ASSERT_EQ(device.GetSampleRate(), 44100);
+  ASSERT_EQ(device.GetBufferBlocks(), 256);
+  ASSERT_FLOAT_EQ(device.GetCallbackPeriodSec(), 256.0f / 44100.0f);
+  ASSERT_FLOAT_EQ(device.GetOutputLatencySec(), 512.0f / 44100.0f);
+
+  device.Play(LoadTestWave(700, WaveFile::kModeLoadInMemory), kPlayOnce);
+  std::vector<int16_t> blocks = Render(device, 1000);
+  for (size_t i = 0; i < 1000; ++i) {
+    int16_t expected = i < 700 ? (int16_t)(1000 + i) : 0;
+    ASSERT_EQ(blocks[i * 2], expected) << i;
+  }
+
+  Device::Stats stats = device.GetStats();
+  ASSERT_EQ(stats.num_callbacks, 4);
+  ASSERT_EQ(stats.num_blocks_requested, 1000);
+}
+
+TEST(AudioDevice, ClampsConfig) {
+  Device device;
+  device.Init(4, Device::Backend::kNull, 1000000, 1);
+  ASSERT_EQ(device.GetSampleRate(), Device::kMaxSampleRate);
+  ASSERT_EQ(device.GetBufferBlocks(), Device::kMinBufferBlocks);
+}
+
+TEST(AudioDevice, PansVoiceFromTheFirstBlock) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  VoiceHandle voice =
+      device.Play(LoadTestWave(100, WaveFile::kModeLoadInMemory), kPlayOnce);
+  device.SetPan(voice, -1.0f);
+
+  std::vector<int16_t> blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], 1000);
+  ASSERT_EQ(blocks[1], 0);
+}
+
+TEST(AudioDevice, RampsPanOverOneBuffer) {
+  Device device;
+  device.Init(4, Device::Backend::kNull, Device::kDefaultSampleRate, 512);
+
+  VoiceHandle voice = device.Play(
+      LoadTestWave(Device::kDefaultSampleRate, WaveFile::kModeLoadInMemory),
+      kPlayLooped);
+  Render(device, 512);
+  device.SetPan(voice, 1.0f);
+
+  std::vector<int16_t> blocks = Render(device, 512);
+  ASSERT_EQ(blocks[0], 1512);
+  ASSERT_EQ(blocks[256 * 2], ApplyGain(1768, 64));
+  for (size_t i = 0; i < 512; ++i) {
+    ASSERT_EQ(blocks[i * 2 + 1], (int16_t)(1512 + i)) << i;
+    if (i) {
+      // Left channel goes down smoothly, while samples go up by 1.
+      ASSERT_LE(blocks[i * 2] - blocks[(i - 1) * 2], 1) << i;
+      ASSERT_GE(blocks[i * 2] - blocks[(i - 1) * 2], -32) << i;
+    }
+  }
+
+  blocks = Render(device, 512);
+  ASSERT_EQ(blocks[0], 0);
+  ASSERT_EQ(blocks[1], 2024);
+}
+
+TEST(AudioDevice, CrossfadesToPrerolledStream) {
+  Device device;
+  device.Init(4, Device::Backend::kNull, Device::kDefaultSampleRate, 512);
+
+  VoiceHandle from = device.Play(
+      LoadTestWave(1000, WaveFile::kModeLoadInMemory), kPlayLooped);
+  Render(device, 512);
+
+  VoiceHandle to = device.Crossfade(
+      from,
+      LoadTestWave(Device::kDefaultSampleRate,
+                   WaveFile::kModeStreamingFromFile),
+      kPlayLooped, 0.1f);
+  ASSERT_TRUE(device.IsPlaying(to));
+  // Without the loader thread, Crossfade() reads the beginning of the stream
+  // right away.
+
+  // Fades start together: the new stream is silent at the first block.
+  std::vector<int16_t> blocks = Render(device, 512);
+  ASSERT_EQ(blocks[0], 1512);
+
+  blocks = Render(device, Device::kDefaultSampleRate / 10 + 1024);
+  ASSERT_FALSE(device.IsPlaying(from));
+  ASSERT_TRUE(device.IsPlaying(to));
+  ASSERT_EQ(blocks[blocks.size() - 2],
+            (int16_t)(1000 + blocks.size() / 2 + 512 - 1));
+  ASSERT_EQ(device.GetStreamingStats().num_underruns, 0);
+}
+
+TEST(AudioDevice, VirtualVoiceMovesForwardWithoutMixing) {
+  Device device;
+  device.Init(4, Device::Backend::kNull, Device::kDefaultSampleRate, 512);
+
+  VoiceHandle voice = device.Play(
+      LoadTestWave(2000, WaveFile::kModeStreamingFromFile), kPlayOnce);
+  device.SetVolume(voice, 0.01f);
+
+  std::vector<int16_t> blocks = Render(device, 512);
+  ASSERT_EQ(blocks[511 * 2], 0);
+  ASSERT_EQ(device.GetStats().num_virtual, 1);
+
+  // Real again, from where it would be if it was mixed.
+  device.SetVolume(voice, 1.0f);
+  Render(device, 512);
+  ASSERT_EQ(device.GetStats().num_virtual, 0);
+  blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], 1000 + 1024);
+  ASSERT_EQ(device.GetStreamingStats().num_underruns, 0);
+}
+
+TEST(AudioDevice, MixesOnlyLoudestVoicesOverLimit) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+  device.SetMaxRealVoices(1);
+
+  auto wave_file = LoadTestWave(1000, WaveFile::kModeLoadInMemory);
+  VoiceHandle quiet = device.Play(wave_file, kPlayLooped);
+  device.SetVolume(quiet, 0.5f);
+  device.Play(wave_file, kPlayLooped);
+
+  std::vector<int16_t> blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], 1000);
+  ASSERT_EQ(device.GetStats().num_virtual, 1);
+  ASSERT_EQ(device.GetNumPlaying(), 2);
+
+  device.SetMaxRealVoices(0);
+  blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], 1010 + ApplyGain(1010, 64));
+  ASSERT_EQ(device.GetStats().num_virtual, 0);
+}
+
+TEST(AudioDevice, FiltersVoiceBeforeItsBus) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  auto wave_file = LoadTestWave(1000, WaveFile::kModeLoadInMemory);
+  VoiceHandle filtered = device.Play(wave_file, kPlayLooped);
+  device.SetFilter(filtered, HighPass(300.0f));
+  device.Play(wave_file, kPlayLooped);
+
+  std::vector<StereoBlock32> expected(512);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = StereoBlock32{.left = (int32_t)(1000 + i),
+                                .right = (int32_t)(1000 + i)};
+  }
+  BiquadFilter filter;
+  filter.SetParams(HighPass(300.0f), Device::kDefaultSampleRate);
+  filter.Process(expected.data(), expected.size());
+
+  std::vector<int16_t> blocks = Render(device, 512);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(blocks[i * 2], expected[i].left + (int32_t)(1000 + i)) << i;
+    ASSERT_EQ(blocks[i * 2 + 1], expected[i].right + (int32_t)(1000 + i))
+        << i;
+  }
+
+  device.SetFilter(filtered, kNoFilter);
+  blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], 1512 * 2);
+}
+
+TEST(AudioDevice, FiltersMixOfBus) {
+  Device device;
+  device.Init(4, Device::Backend::kNull);
+
+  size_t sfx_bus = device.CreateBus();
+  auto wave_file = LoadTestWave(1000, WaveFile::kModeLoadInMemory);
+  device.Play(wave_file, kPlayLooped, kNoFade, kPriorityNormal, sfx_bus);
+  device.Play(wave_file, kPlayLooped, kNoFade, kPriorityNormal, sfx_bus);
+  device.SetBusFilter(sfx_bus, LowPass(1200.0f));
+  device.SetBusVolume(sfx_bus, 0.5f);
+
+  // Bus is filtered once, then mixed with its volume.
+  std::vector<StereoBlock32> expected(512);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = StereoBlock32{.left = (int32_t)(2000 + i * 2),
+                                .right = (int32_t)(2000 + i * 2)};
+  }
+  BiquadFilter filter;
+  filter.SetParams(LowPass(1200.0f), Device::kDefaultSampleRate);
+  filter.Process(expected.data(), expected.size());
+
+  std::vector<int16_t> blocks = Render(device, 512);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(blocks[i * 2], ApplyGain(expected[i].left, 64)) << i;
+    ASSERT_EQ(blocks[i * 2 + 1], ApplyGain(expected[i].right, 64)) << i;
+  }
+
+  device.SetBusFilter(sfx_bus, kNoFilter);
+  blocks = Render(device, 10);
+  ASSERT_EQ(blocks[0], ApplyGain(1512 * 2, 64));
+}
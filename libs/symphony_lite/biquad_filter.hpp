@@ -0,0 +1,223 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmath>
+
+#include "mixing_kernels.hpp"
+
+namespace Symphony {
+namespace Audio {
+enum class FilterType { kNone, kLowPass, kHighPass, kOnePoleLowPass };
+
+// Q of a Butterworth filter: flat pass band, no resonance at the cutoff.
+inline constexpr float kButterworthQ = 0.7071f;
+
+struct FilterParams {
+  FilterType type{FilterType::kNone};
+  float cutoff_hz{0.0f};
+  // Ignored by one-pole filters.
+  float q{kButterworthQ};
+
+  bool operator==(const FilterParams& other) const = default;
+};
+
+inline constexpr FilterParams kNoFilter{
+    .type = FilterType::kNone, .cutoff_hz = 0.0f, .q = kButterworthQ};
+
+FilterParams LowPass(float cutoff_hz, float q = kButterworthQ) {
+  return FilterParams{
+      .type = FilterType::kLowPass, .cutoff_hz = cutoff_hz, .q = q};
+}
+
+FilterParams HighPass(float cutoff_hz, float q = kButterworthQ) {
+  return FilterParams{
+      .type = FilterType::kHighPass, .cutoff_hz = cutoff_hz, .q = q};
+}
+
+// 6 dB per octave, softer and cheaper to change than LowPass().
+FilterParams OnePoleLowPass(float cutoff_hz) {
+  return FilterParams{.type = FilterType::kOnePoleLowPass,
+                      .cutoff_hz = cutoff_hz,
+                      .q = kButterworthQ};
+}
+
+// Biquad in transposed direct form II, normalized so that a0 is 1:
+//   y = b0 * x + z1
+//   z1 = b1 * x - a1 * y + z2
+//   z2 = b2 * x - a2 * y
+// One-pole filters are biquads with b1, b2 and a2 equal to 0.
+struct BiquadCoefficients {
+  float b0{1.0f};
+  float b1{0.0f};
+  float b2{0.0f};
+  float a1{0.0f};
+  float a2{0.0f};
+};
+
+// Delay line of the left and right channels.
+struct BiquadState {
+  float z1[2]{0.0f, 0.0f};
+  float z2[2]{0.0f, 0.0f};
+};
+
+// Coefficients of the cookbook filters by Robert Bristow-Johnson. Cutoff is
+// clamped below the Nyquist frequency.
+BiquadCoefficients GetBiquadCoefficients(const FilterParams& params,
+                                         int sample_rate);
+
+// Filters mixed samples in place. Left and right channels are filtered
+// together in one vector register with SSE2 or NEON, every block depends on
+// the previous one, so blocks can't be processed in parallel. Vectorized
+// filter gives the same samples as the scalar one, up to rounding of float
+// operations, which may be fused by the compiler in the scalar one.
+void ProcessBiquad(StereoBlock32* blocks, size_t num_blocks,
+                   const BiquadCoefficients& coefficients, BiquadState& state);
+
+// Reference filter.
+void ProcessBiquadScalar(StereoBlock32* blocks, size_t num_blocks,
+                         const BiquadCoefficients& coefficients,
+                         BiquadState& state);
+
+// Filter of a voice or bus. Coefficients are computed when parameters
+// change, not per buffer.
+class BiquadFilter {
+ public:
+  // Keeps the delay line, so that a sweeping cutoff doesn't click.
+  void SetParams(const FilterParams& params, int sample_rate);
+  const FilterParams& GetParams() const { return params_; }
+  bool IsActive() const { return params_.type != FilterType::kNone; }
+
+  void Process(StereoBlock32* blocks, size_t num_blocks) {
+    ProcessBiquad(blocks, num_blocks, coefficients_, state_);
+  }
+
+  void Reset() { state_ = BiquadState(); }
+
+ private:
+  FilterParams params_;
+  int sample_rate_{0};
+  BiquadCoefficients coefficients_;
+  BiquadState state_;
+};
+
+BiquadCoefficients GetBiquadCoefficients(const FilterParams& params,
+                                         int sample_rate) {
+  const float kPi = 3.14159265f;
+  float nyquist_hz = (float)sample_rate * 0.5f;
+  float cutoff_hz = std::fmin(std::fmax(params.cutoff_hz, 1.0f),
+                              nyquist_hz * 0.99f);
+  float w0 = 2.0f * kPi * cutoff_hz / (float)sample_rate;
+
+  BiquadCoefficients result;
+  switch (params.type) {
+    case FilterType::kNone:
+      break;
+    case FilterType::kOnePoleLowPass: {
+      float pole = std::exp(-w0);
+      result.b0 = 1.0f - pole;
+      result.a1 = -pole;
+      break;
+    }
+    case FilterType::kLowPass:
+    case FilterType::kHighPass: {
+      float cos_w0 = std::cos(w0);
+      float alpha = std::sin(w0) / (2.0f * std::fmax(params.q, 0.01f));
+      float a0 = 1.0f + alpha;
+      if (params.type == FilterType::kLowPass) {
+        result.b0 = (1.0f - cos_w0) * 0.5f / a0;
+        result.b1 = (1.0f - cos_w0) / a0;
+      } else {
+        result.b0 = (1.0f + cos_w0) * 0.5f / a0;
+        result.b1 = -(1.0f + cos_w0) / a0;
+      }
+      result.b2 = result.b0;
+      result.a1 = -2.0f * cos_w0 / a0;
+      result.a2 = (1.0f - alpha) / a0;
+      break;
+    }
+  }
+  return result;
+}
+
+void ProcessBiquad(StereoBlock32* blocks, size_t num_blocks,
+                   const BiquadCoefficients& coefficients,
+                   BiquadState& state) {
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2) || \
+    defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  // Lanes are left and right, the upper two are unused.
+  const __m128 b0 = _mm_set1_ps(coefficients.b0);
+  const __m128 b1 = _mm_set1_ps(coefficients.b1);
+  const __m128 b2 = _mm_set1_ps(coefficients.b2);
+  const __m128 a1 = _mm_set1_ps(coefficients.a1);
+  const __m128 a2 = _mm_set1_ps(coefficients.a2);
+  __m128 z1 = _mm_setr_ps(state.z1[0], state.z1[1], 0.0f, 0.0f);
+  __m128 z2 = _mm_setr_ps(state.z2[0], state.z2[1], 0.0f, 0.0f);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    __m128i* block = (__m128i*)(blocks + i);
+    __m128 x = _mm_cvtepi32_ps(_mm_loadl_epi64(block));
+    __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+    z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+    z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+    _mm_storel_epi64(block, _mm_cvtps_epi32(y));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, z1);
+  state.z1[0] = lanes[0];
+  state.z1[1] = lanes[1];
+  _mm_storeu_ps(lanes, z2);
+  state.z2[0] = lanes[0];
+  state.z2[1] = lanes[1];
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON) && defined(__aarch64__)
+  float32x2_t z1 = vld1_f32(state.z1);
+  float32x2_t z2 = vld1_f32(state.z2);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    int32_t* block = (int32_t*)(blocks + i);
+    float32x2_t x = vcvt_f32_s32(vld1_s32(block));
+    float32x2_t y = vadd_f32(vmul_n_f32(x, coefficients.b0), z1);
+    z1 = vadd_f32(vsub_f32(vmul_n_f32(x, coefficients.b1),
+                           vmul_n_f32(y, coefficients.a1)),
+                  z2);
+    z2 = vsub_f32(vmul_n_f32(x, coefficients.b2),
+                  vmul_n_f32(y, coefficients.a2));
+    vst1_s32(block, vcvtn_s32_f32(y));
+  }
+  vst1_f32(state.z1, z1);
+  vst1_f32(state.z2, z2);
+#else
+  ProcessBiquadScalar(blocks, num_blocks, coefficients, state);
+#endif
+}
+
+void ProcessBiquadScalar(StereoBlock32* blocks, size_t num_blocks,
+                         const BiquadCoefficients& coefficients,
+                         BiquadState& state) {
+  const BiquadCoefficients& c = coefficients;
+  for (size_t i = 0; i < num_blocks; ++i) {
+    int32_t* samples[2] = {&blocks[i].left, &blocks[i].right};
+    for (size_t channel = 0; channel < 2; ++channel) {
+      float x = (float)*samples[channel];
+      float y = c.b0 * x + state.z1[channel];
+      state.z1[channel] = c.b1 * x - c.a1 * y + state.z2[channel];
+      state.z2[channel] = c.b2 * x - c.a2 * y;
+      *samples[channel] = (int32_t)std::lrint(y);
+    }
+  }
+}
+
+void BiquadFilter::SetParams(const FilterParams& params, int sample_rate) {
+  if (params == params_ && sample_rate == sample_rate_) {
+    return;
+  }
+
+  if (!IsActive()) {
+    // Starts from silence, not from the delay line of an old filter.
+    Reset();
+  }
+  params_ = params;
+  sample_rate_ = sample_rate;
+  coefficients_ = GetBiquadCoefficients(params, sample_rate);
+}
+}  // namespace Audio
+}  // namespace Symphony
@@ -0,0 +1,134 @@
+#include "biquad_filter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "mixing_test_utils.hpp"
+
+using namespace Symphony::Audio;
+
+namespace {
+static constexpr int kSampleRate = 48000;
+static constexpr size_t kNumBlocks = 4096;
+static const FilterParams kAllParams[] = {
+    LowPass(1200.0f),  LowPass(100.0f, 4.0f),  HighPass(300.0f),
+    HighPass(8000.0f), OnePoleLowPass(500.0f), LowPass(100000.0f),
+};
+
+std::vector<StereoBlock32> MakeConstant(size_t num_blocks, int32_t value) {
+  return std::vector<StereoBlock32>(
+      num_blocks, StereoBlock32{.left = value, .right = -value});
+}
+
+// Every other sample is negated: the Nyquist frequency.
+std::vector<StereoBlock32> MakeNyquist(size_t num_blocks, int32_t value) {
+  std::vector<StereoBlock32> result(num_blocks);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    int32_t sample = i % 2 ? -value : value;
+    result[i] = StereoBlock32{.left = sample, .right = sample};
+  }
+  return result;
+}
+}  // namespace
+
+TEST(BiquadFilter, ProcessMatchesScalar) {
+  for (const auto& params : kAllParams) {
+    BiquadCoefficients coefficients =
+        GetBiquadCoefficients(params, kSampleRate);
+    auto expected = MakeMixed(kNumBlocks, 100000, 1);
+    auto actual = expected;
+    BiquadState expected_state;
+    BiquadState actual_state;
+
+    // In pieces, so that the delay line is carried from call to call.
+    for (size_t first = 0; first < kNumBlocks; first += 1000) {
+      size_t num_blocks = std::min((size_t)1000, kNumBlocks - first);
+      ProcessBiquadScalar(expected.data() + first, num_blocks, coefficients,
+                          expected_state);
+      ProcessBiquad(actual.data() + first, num_blocks, coefficients,
+                    actual_state);
+    }
+
+    // Float operations may be fused differently.
+    for (size_t i = 0; i < kNumBlocks; ++i) {
+      ASSERT_LE(std::abs(expected[i].left - actual[i].left), 1)
+          << "block " << i;
+      ASSERT_LE(std::abs(expected[i].right - actual[i].right), 1)
+          << "block " << i;
+    }
+  }
+}
+
+TEST(BiquadFilter, NoFilterKeepsSamples) {
+  auto expected = MakeMixed(kNumBlocks, 100000, 2);
+  auto actual = expected;
+
+  BiquadFilter filter;
+  filter.SetParams(kNoFilter, kSampleRate);
+  EXPECT_FALSE(filter.IsActive());
+  filter.Process(actual.data(), actual.size());
+
+  for (size_t i = 0; i < kNumBlocks; ++i) {
+    ASSERT_EQ(expected[i].left, actual[i].left) << "block " << i;
+    ASSERT_EQ(expected[i].right, actual[i].right) << "block " << i;
+  }
+}
+
+TEST(BiquadFilter, LowPassKeepsConstantAndRemovesNyquist) {
+  for (const auto& params : {LowPass(1200.0f), OnePoleLowPass(1200.0f)}) {
+    BiquadFilter filter;
+    filter.SetParams(params, kSampleRate);
+
+    auto constant = MakeConstant(kNumBlocks, 10000);
+    filter.Process(constant.data(), constant.size());
+    EXPECT_NEAR(constant.back().left, 10000, 1);
+    EXPECT_NEAR(constant.back().right, -10000, 1);
+
+    filter.Reset();
+    auto nyquist = MakeNyquist(kNumBlocks, 10000);
+    filter.Process(nyquist.data(), nyquist.size());
+    // One-pole filter rolls off slower, by 6 dB per octave.
+    EXPECT_LE(std::abs(nyquist.back().left), 1000);
+    EXPECT_LE(std::abs(nyquist.back().right), 1000);
+  }
+}
+
+TEST(BiquadFilter, HighPassRemovesConstantAndKeepsNyquist) {
+  BiquadFilter filter;
+  filter.SetParams(HighPass(300.0f), kSampleRate);
+
+  auto constant = MakeConstant(kNumBlocks, 10000);
+  filter.Process(constant.data(), constant.size());
+  EXPECT_NEAR(constant.back().left, 0, 1);
+  EXPECT_NEAR(constant.back().right, 0, 1);
+
+  filter.Reset();
+  auto nyquist = MakeNyquist(kNumBlocks, 10000);
+  filter.Process(nyquist.data(), nyquist.size());
+  EXPECT_NEAR(std::abs(nyquist.back().left), 10000, 100);
+  EXPECT_NEAR(std::abs(nyquist.back().right), 10000, 100);
+}
+
+TEST(BiquadFilter, SameParamsKeepFilterRunning) {
+  auto expected = MakeMixed(kNumBlocks, 100000, 3);
+  auto actual = expected;
+
+  BiquadFilter expected_filter;
+  expected_filter.SetParams(LowPass(1200.0f), kSampleRate);
+  expected_filter.Process(expected.data(), expected.size());
+
+  // Setting the same params every buffer doesn't reset the delay line.
+  BiquadFilter actual_filter;
+  for (size_t first = 0; first < kNumBlocks; first += 256) {
+    actual_filter.SetParams(LowPass(1200.0f), kSampleRate);
+    actual_filter.Process(actual.data() + first, 256);
+  }
+
+  for (size_t i = 0; i < kNumBlocks; ++i) {
+    ASSERT_EQ(expected[i].left, actual[i].left) << "block " << i;
+    ASSERT_EQ(expected[i].right, actual[i].right) << "block " << i;
+  }
+}
@@ -0,0 +1,750 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Symphony {
+namespace Text {
+// Contents of an AngelCode BMFont descriptor.
+struct BmFontFile {
+  struct Info {
+    std::string face;
+    int size{0};
+    int bold{0};
+    int italic{0};
+    std::string charset;
+    int unicode{0};
+    int stretch_h{0};
+    int smooth{0};
+    int aa{0};
+    int padding[4]{0, 0, 0, 0};
+    int spacing[2]{0, 0};
+    int outline{0};
+
+    bool operator==(const Info& other) const = default;
+  };
+
+  struct Common {
+    int line_height{0};
+    int base{0};
+    int scale_w{0};
+    int scale_h{0};
+    int pages{0};
+    int packed{0};
+    int alpha_chnl{0};
+    int red_chnl{0};
+    int green_chnl{0};
+    int blue_chnl{0};
+
+    bool operator==(const Common& other) const = default;
+  };
+
+  struct Page {
+    int id{0};
+    std::string file;
+
+    bool operator==(const Page& other) const = default;
+  };
+
+  struct Char {
+    int id{0};
+    int x{0};
+    int y{0};
+    int width{0};
+    int height{0};
+    int x_offset{0};
+    int y_offset{0};
+    int x_advance{0};
+    int page{0};
+    int chnl{0};
+
+    bool operator==(const Char& other) const = default;
+  };
+
+  struct Kerning {
+    int first{0};
+    int second{0};
+    int amount{0};
+
+    bool operator==(const Kerning& other) const = default;
+  };
+
+  Info info;
+  Common common;
+  std::vector<Page> pages;
+  std::vector<Char> chars;
+  std::vector<Kerning> kernings;
+};
+
+// Parses the text format, file_path is only for messages.
+bool ParseBmFontText(const std::string& content, const std::string& file_path,
+                     BmFontFile& result);
+
+// Parses the binary format of version 3.
+bool ParseBmFontBinary(const std::string& content,
+                       const std::string& file_path, BmFontFile& result);
+
+// Reads the file with one read and parses it in the binary format when it
+// starts with "BMF", or in the text format.
+bool LoadBmFontFile(const std::string& file_path, BmFontFile& result);
+
+bool SaveBmFontBinary(const std::string& file_path,
+                      const BmFontFile& font_file);
+
+// Cooked fonts keep chars and kernings as they are in memory, so they are
+// read with one read and copied into place. They are only valid for builds
+// with the same layout of BmFontFile::Char and BmFontFile::Kerning.
+bool SaveCookedBmFont(const std::string& file_path,
+                      const BmFontFile& font_file);
+
+bool LoadCookedBmFont(const std::string& file_path, BmFontFile& result);
+
+namespace {
+inline constexpr char kBmFontBinaryMagic[3] = {'B', 'M', 'F'};
+inline constexpr uint8_t kBmFontBinaryVersion = 3;
+
+enum BmFontBinaryBlock : uint8_t {
+  kBmFontBinaryBlockInfo = 1,
+  kBmFontBinaryBlockCommon = 2,
+  kBmFontBinaryBlockPages = 3,
+  kBmFontBinaryBlockChars = 4,
+  kBmFontBinaryBlockKerningPairs = 5,
+};
+
+inline constexpr size_t kBmFontBinaryInfoSize = 14;
+inline constexpr size_t kBmFontBinaryCommonSize = 15;
+inline constexpr size_t kBmFontBinaryCharSize = 20;
+inline constexpr size_t kBmFontBinaryKerningSize = 10;
+
+inline constexpr char kCookedBmFontMagic[4] = {'S', 'B', 'M', 'F'};
+inline constexpr uint32_t kCookedBmFontVersion = 1;
+
+static_assert(std::is_trivially_copyable_v<BmFontFile::Common> &&
+                  std::is_trivially_copyable_v<BmFontFile::Char> &&
+                  std::is_trivially_copyable_v<BmFontFile::Kerning>,
+              "Cooked fonts copy these structs as they are");
+
+// Followed by the face, the charset, then every page as its id, the length of
+// its file name and the file name, then chars and kernings.
+struct CookedBmFontHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t char_size;
+  uint32_t kerning_size;
+  BmFontFile::Common common;
+  int size;
+  int bold;
+  int italic;
+  int unicode;
+  int stretch_h;
+  int smooth;
+  int aa;
+  int padding[4];
+  int spacing[2];
+  int outline;
+  uint32_t face_length;
+  uint32_t charset_length;
+  uint32_t num_pages;
+  uint32_t num_chars;
+  uint32_t num_kernings;
+};
+
+bool readWholeFile(const std::string& file_path, std::string& content) {
+  std::ifstream file;
+
+  file.open(file_path, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  file.seekg(0, std::ios::end);
+  size_t file_size = file.tellg();
+  content.resize(file_size);
+
+  file.seekg(0, std::ios::beg);
+  file.read(content.data(), file_size);
+  return (size_t)file.gcount() == file_size;
+}
+
+bool writeWholeFile(const std::string& file_path, const std::string& content) {
+  std::ofstream file;
+
+  file.open(file_path, std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "[Symphony::Text::BmFontFile] Can't create file, file_path: "
+              << file_path << std::endl;
+    return false;
+  }
+
+  file.write(content.data(), content.size());
+  return file.good();
+}
+
+// Binary fonts are little-endian.
+uint32_t readBinaryUInt(const char* data, size_t size) {
+  uint32_t result = 0;
+  for (size_t i = 0; i < size; ++i) {
+    result |= (uint32_t)(uint8_t)data[i] << (i * 8);
+  }
+  return result;
+}
+
+int readBinaryInt16(const char* data) {
+  return (int)(int16_t)(uint16_t)readBinaryUInt(data, 2);
+}
+
+void writeBinaryUInt(std::string& content, uint32_t value, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    content.push_back((char)((value >> (i * 8)) & 0xFF));
+  }
+}
+
+template <typename T>
+void appendCooked(std::string& content, const T* items, size_t num_items) {
+  content.append(reinterpret_cast<const char*>(items), num_items * sizeof(T));
+}
+
+// Counts of cooked files aren't trusted: they are checked against the rest of
+// the content before anything is allocated or multiplied by them.
+bool hasCookedItems(const std::string& content, size_t offset,
+                    size_t num_items, size_t item_size) {
+  return num_items <= (content.size() - offset) / item_size;
+}
+
+// Returns false when there are less than num_items left.
+template <typename T>
+bool readCooked(const std::string& content, size_t& offset, T* items,
+                size_t num_items) {
+  if (!hasCookedItems(content, offset, num_items, sizeof(T))) {
+    return false;
+  }
+  size_t size = num_items * sizeof(T);
+  if (size) {
+    memcpy(reinterpret_cast<char*>(items), content.data() + offset, size);
+  }
+  offset += size;
+  return true;
+}
+
+bool readCookedString(const std::string& content, size_t& offset,
+                      size_t length, std::string& result) {
+  if (content.size() - offset < length) {
+    return false;
+  }
+  result.assign(content.data() + offset, length);
+  offset += length;
+  return true;
+}
+}  // namespace
+
+bool ParseBmFontText(const std::string& content, const std::string& file_path,
+                     BmFontFile& result) {
+  enum BlockType {
+    kBlockInfo,
+    kBlockCommon,
+    kBlockPage,
+    kBlockChars,
+    kBlockChar,
+    kBlockKerning,
+    kBlockUnknown,
+  };
+
+  std::istringstream content_stream(content);
+  size_t num_chars = 0;
+
+  std::string block_content;
+  while (std::getline(content_stream, block_content)) {
+    std::istringstream block_stream(block_content);
+
+    std::string block_type_string;
+    block_stream >> block_type_string;
+
+    BlockType block_type = kBlockUnknown;
+    if (block_type_string == "info") {
+      block_type = kBlockInfo;
+    } else if (block_type_string == "common") {
+      block_type = kBlockCommon;
+    } else if (block_type_string == "page") {
+      block_type = kBlockPage;
+      result.pages.push_back(BmFontFile::Page());
+    } else if (block_type_string == "chars") {
+      block_type = kBlockChars;
+    } else if (block_type_string == "char") {
+      block_type = kBlockChar;
+      result.chars.push_back(BmFontFile::Char());
+    } else if (block_type_string == "kerning") {
+      block_type = kBlockKerning;
+      result.kernings.push_back(BmFontFile::Kerning());
+    } else if (block_type == kBlockUnknown) {
+      continue;
+    }
+
+    while (!block_stream.eof()) {
+      while (block_stream.peek() == ' ') {
+        block_stream.get();
+      }
+
+      std::string key;
+      std::getline(block_stream, key, '=');
+
+      std::string value;
+      if (block_stream.peek() == '\"') {
+        block_stream.get();
+        std::getline(block_stream, value, '\"');
+      } else {
+        block_stream >> value;
+      }
+
+      if (block_type == kBlockInfo) {
+        BmFontFile::Info& info = result.info;
+        if (key == "face") {
+          info.face = value;
+        } else if (key == "size") {
+          info.size = std::stoi(value);
+        } else if (key == "bold") {
+          info.bold = std::stoi(value);
+        } else if (key == "italic") {
+          info.italic = std::stoi(value);
+        } else if (key == "charset") {
+          info.charset = value;
+        } else if (key == "unicode") {
+          info.unicode = std::stoi(value);
+        } else if (key == "stretchH") {
+          info.stretch_h = std::stoi(value);
+        } else if (key == "smooth") {
+          info.smooth = std::stoi(value);
+        } else if (key == "aa") {
+          info.aa = std::stoi(value);
+        } else if (key == "padding") {
+          std::istringstream value_stream(value);
+          value_stream >> info.padding[0];
+          value_stream >> info.padding[1];
+          value_stream >> info.padding[2];
+          value_stream >> info.padding[3];
+        } else if (key == "spacing") {
+          std::istringstream value_stream(value);
+          value_stream >> info.spacing[0];
+          value_stream >> info.spacing[1];
+        }
+      } else if (block_type == kBlockCommon) {
+        BmFontFile::Common& common = result.common;
+        if (key == "lineHeight") {
+          common.line_height = std::stoi(value);
+        } else if (key == "base") {
+          common.base = std::stoi(value);
+        } else if (key == "scaleW") {
+          common.scale_w = std::stoi(value);
+        } else if (key == "scaleH") {
+          common.scale_h = std::stoi(value);
+        } else if (key == "pages") {
+          common.pages = std::stoi(value);
+        } else if (key == "packed") {
+          common.packed = std::stoi(value);
+        } else if (key == "alphaChnl") {
+          common.alpha_chnl = std::stoi(value);
+        } else if (key == "redChnl") {
+          common.red_chnl = std::stoi(value);
+        } else if (key == "greenChnl") {
+          common.green_chnl = std::stoi(value);
+        } else if (key == "blueChnl") {
+          common.blue_chnl = std::stoi(value);
+        }
+      } else if (block_type == kBlockPage) {
+        if (key == "id") {
+          result.pages.back().id = std::stoi(value);
+        } else if (key == "file") {
+          result.pages.back().file = value;
+        }
+      } else if (block_type == kBlockChars) {
+        if (key == "count") {
+          num_chars = (size_t)std::stoi(value);
+        }
+      } else if (block_type == kBlockChar) {
+        BmFontFile::Char& c = result.chars.back();
+        if (key == "id") {
+          c.id = std::stoi(value);
+        } else if (key == "x") {
+          c.x = std::stoi(value);
+        } else if (key == "y") {
+          c.y = std::stoi(value);
+        } else if (key == "width") {
+          c.width = std::stoi(value);
+        } else if (key == "height") {
+          c.height = std::stoi(value);
+        } else if (key == "xoffset") {
+          c.x_offset = std::stoi(value);
+        } else if (key == "yoffset") {
+          c.y_offset = std::stoi(value);
+        } else if (key == "xadvance") {
+          c.x_advance = std::stoi(value);
+        } else if (key == "page") {
+          c.page = std::stoi(value);
+        } else if (key == "chnl") {
+          c.chnl = std::stoi(value);
+        }
+      } else if (block_type == kBlockKerning) {
+        BmFontFile::Kerning& kerning = result.kernings.back();
+        if (key == "first") {
+          kerning.first = std::stoi(value);
+        } else if (key == "second") {
+          kerning.second = std::stoi(value);
+        } else if (key == "amount") {
+          kerning.amount = std::stoi(value);
+        }
+      }
+    }
+  }
+
+  if (num_chars != result.chars.size()) {
+    std::cerr << "[Symphony::Text::BmFontFile] Wrong count in 'chars' block "
+                 "and number of 'char' blocks, file_path: "
+              << file_path << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool ParseBmFontBinary(const std::string& content,
+                       const std::string& file_path, BmFontFile& result) {
+  if (content.size() < 4 ||
+      memcmp(content.data(), kBmFontBinaryMagic, 3) != 0 ||
+      (uint8_t)content[3] != kBmFontBinaryVersion) {
+    std::cerr << "[Symphony::Text::BmFontFile] Only version 3 of the binary "
+                 "format is supported, file_path: "
+              << file_path << std::endl;
+    return false;
+  }
+
+  auto report_broken_block = [&file_path](int block_type) {
+    std::cerr << "[Symphony::Text::BmFontFile] Broken block, file_path: "
+              << file_path << ", block: " << block_type << std::endl;
+    return false;
+  };
+
+  size_t offset = 4;
+  while (offset < content.size()) {
+    if (content.size() - offset < 5) {
+      return report_broken_block(-1);
+    }
+    int block_type = (uint8_t)content[offset];
+    size_t block_size = readBinaryUInt(content.data() + offset + 1, 4);
+    offset += 5;
+    if (content.size() - offset < block_size) {
+      return report_broken_block(block_type);
+    }
+    const char* block = content.data() + offset;
+    offset += block_size;
+
+    if (block_type == kBmFontBinaryBlockInfo) {
+      if (block_size < kBmFontBinaryInfoSize) {
+        return report_broken_block(block_type);
+      }
+      BmFontFile::Info& info = result.info;
+      info.size = readBinaryInt16(block);
+      uint32_t bits = (uint8_t)block[2];
+      info.smooth = bits & 1;
+      info.unicode = (bits >> 1) & 1;
+      info.italic = (bits >> 2) & 1;
+      info.bold = (bits >> 3) & 1;
+      // Only the id of the charset is kept, unicode fonts have none.
+      info.charset = info.unicode ? "" : std::to_string((uint8_t)block[3]);
+      info.stretch_h = (int)readBinaryUInt(block + 4, 2);
+      info.aa = (uint8_t)block[6];
+      for (size_t i = 0; i < 4; ++i) {
+        info.padding[i] = (uint8_t)block[7 + i];
+      }
+      info.spacing[0] = (uint8_t)block[11];
+      info.spacing[1] = (uint8_t)block[12];
+      info.outline = (uint8_t)block[13];
+      const char* face = block + kBmFontBinaryInfoSize;
+      info.face.assign(face, strnlen(face, block_size - kBmFontBinaryInfoSize));
+    } else if (block_type == kBmFontBinaryBlockCommon) {
+      if (block_size < kBmFontBinaryCommonSize) {
+        return report_broken_block(block_type);
+      }
+      BmFontFile::Common& common = result.common;
+      common.line_height = (int)readBinaryUInt(block, 2);
+      common.base = (int)readBinaryUInt(block + 2, 2);
+      common.scale_w = (int)readBinaryUInt(block + 4, 2);
+      common.scale_h = (int)readBinaryUInt(block + 6, 2);
+      common.pages = (int)readBinaryUInt(block + 8, 2);
+      common.packed = ((uint8_t)block[10] >> 7) & 1;
+      common.alpha_chnl = (uint8_t)block[11];
+      common.red_chnl = (uint8_t)block[12];
+      common.green_chnl = (uint8_t)block[13];
+      common.blue_chnl = (uint8_t)block[14];
+    } else if (block_type == kBmFontBinaryBlockPages) {
+      // Names have the same length and end with zeros.
+      size_t name_size = strnlen(block, block_size) + 1;
+      if (name_size > block_size || block_size % name_size != 0) {
+        return report_broken_block(block_type);
+      }
+      for (size_t i = 0; i < block_size / name_size; ++i) {
+        result.pages.push_back(BmFontFile::Page{
+            .id = (int)i, .file = std::string(block + i * name_size)});
+      }
+    } else if (block_type == kBmFontBinaryBlockChars) {
+      if (block_size % kBmFontBinaryCharSize != 0) {
+        return report_broken_block(block_type);
+      }
+      result.chars.resize(block_size / kBmFontBinaryCharSize);
+      for (auto& c : result.chars) {
+        c.id = (int)readBinaryUInt(block, 4);
+        c.x = (int)readBinaryUInt(block + 4, 2);
+        c.y = (int)readBinaryUInt(block + 6, 2);
+        c.width = (int)readBinaryUInt(block + 8, 2);
+        c.height = (int)readBinaryUInt(block + 10, 2);
+        c.x_offset = readBinaryInt16(block + 12);
+        c.y_offset = readBinaryInt16(block + 14);
+        c.x_advance = readBinaryInt16(block + 16);
+        c.page = (uint8_t)block[18];
+        c.chnl = (uint8_t)block[19];
+        block += kBmFontBinaryCharSize;
+      }
+    } else if (block_type == kBmFontBinaryBlockKerningPairs) {
+      if (block_size % kBmFontBinaryKerningSize != 0) {
+        return report_broken_block(block_type);
+      }
+      result.kernings.resize(block_size / kBmFontBinaryKerningSize);
+      for (auto& kerning : result.kernings) {
+        kerning.first = (int)readBinaryUInt(block, 4);
+        kerning.second = (int)readBinaryUInt(block + 4, 4);
+        kerning.amount = readBinaryInt16(block + 8);
+        block += kBmFontBinaryKerningSize;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool LoadBmFontFile(const std::string& file_path, BmFontFile& result) {
+  std::string content;
+  if (!readWholeFile(file_path, content)) {
+    std::cerr << "[Symphony::Text::BmFontFile] Can't open file, file_path: "
+              << file_path << std::endl;
+    return false;
+  }
+
+  if (content.size() >= 3 &&
+      memcmp(content.data(), kBmFontBinaryMagic, 3) == 0) {
+    return ParseBmFontBinary(content, file_path, result);
+  }
+  return ParseBmFontText(content, file_path, result);
+}
+
+bool SaveBmFontBinary(const std::string& file_path,
+                      const BmFontFile& font_file) {
+  std::string content(kBmFontBinaryMagic, 3);
+  content.push_back((char)kBmFontBinaryVersion);
+
+  const BmFontFile::Info& info = font_file.info;
+  content.push_back((char)kBmFontBinaryBlockInfo);
+  writeBinaryUInt(content, kBmFontBinaryInfoSize + info.face.size() + 1, 4);
+  writeBinaryUInt(content, (uint32_t)info.size, 2);
+  writeBinaryUInt(content,
+                  (info.smooth ? 1 : 0) | (info.unicode ? 2 : 0) |
+                      (info.italic ? 4 : 0) | (info.bold ? 8 : 0),
+                  1);
+  writeBinaryUInt(
+      content, info.charset.empty() ? 0 : (uint32_t)atoi(info.charset.c_str()),
+      1);
+  writeBinaryUInt(content, (uint32_t)info.stretch_h, 2);
+  writeBinaryUInt(content, (uint32_t)info.aa, 1);
+  for (int padding : info.padding) {
+    writeBinaryUInt(content, (uint32_t)padding, 1);
+  }
+  writeBinaryUInt(content, (uint32_t)info.spacing[0], 1);
+  writeBinaryUInt(content, (uint32_t)info.spacing[1], 1);
+  writeBinaryUInt(content, (uint32_t)info.outline, 1);
+  content.append(info.face.c_str(), info.face.size() + 1);
+
+  const BmFontFile::Common& common = font_file.common;
+  content.push_back((char)kBmFontBinaryBlockCommon);
+  writeBinaryUInt(content, kBmFontBinaryCommonSize, 4);
+  writeBinaryUInt(content, (uint32_t)common.line_height, 2);
+  writeBinaryUInt(content, (uint32_t)common.base, 2);
+  writeBinaryUInt(content, (uint32_t)common.scale_w, 2);
+  writeBinaryUInt(content, (uint32_t)common.scale_h, 2);
+  writeBinaryUInt(content, (uint32_t)common.pages, 2);
+  writeBinaryUInt(content, common.packed ? 0x80 : 0, 1);
+  writeBinaryUInt(content, (uint32_t)common.alpha_chnl, 1);
+  writeBinaryUInt(content, (uint32_t)common.red_chnl, 1);
+  writeBinaryUInt(content, (uint32_t)common.green_chnl, 1);
+  writeBinaryUInt(content, (uint32_t)common.blue_chnl, 1);
+
+  if (!font_file.pages.empty()) {
+    size_t name_size = 0;
+    for (const auto& page : font_file.pages) {
+      name_size = std::max(name_size, page.file.size() + 1);
+    }
+    content.push_back((char)kBmFontBinaryBlockPages);
+    writeBinaryUInt(content, name_size * font_file.pages.size(), 4);
+    for (const auto& page : font_file.pages) {
+      std::string name = page.file;
+      name.resize(name_size, '\0');
+      content += name;
+    }
+  }
+
+  content.push_back((char)kBmFontBinaryBlockChars);
+  writeBinaryUInt(content, kBmFontBinaryCharSize * font_file.chars.size(), 4);
+  for (const auto& c : font_file.chars) {
+    writeBinaryUInt(content, (uint32_t)c.id, 4);
+    writeBinaryUInt(content, (uint32_t)c.x, 2);
+    writeBinaryUInt(content, (uint32_t)c.y, 2);
+    writeBinaryUInt(content, (uint32_t)c.width, 2);
+    writeBinaryUInt(content, (uint32_t)c.height, 2);
+    writeBinaryUInt(content, (uint32_t)c.x_offset, 2);
+    writeBinaryUInt(content, (uint32_t)c.y_offset, 2);
+    writeBinaryUInt(content, (uint32_t)c.x_advance, 2);
+    writeBinaryUInt(content, (uint32_t)c.page, 1);
+    writeBinaryUInt(content, (uint32_t)c.chnl, 1);
+  }
+
+  if (!font_file.kernings.empty()) {
+    content.push_back((char)kBmFontBinaryBlockKerningPairs);
+    writeBinaryUInt(content,
+                    kBmFontBinaryKerningSize * font_file.kernings.size(), 4);
+    for (const auto& kerning : font_file.kernings) {
+      writeBinaryUInt(content, (uint32_t)kerning.first, 4);
+      writeBinaryUInt(content, (uint32_t)kerning.second, 4);
+      writeBinaryUInt(content, (uint32_t)kerning.amount, 2);
+    }
+  }
+
+  return writeWholeFile(file_path, content);
+}
+
+bool SaveCookedBmFont(const std::string& file_path,
+                      const BmFontFile& font_file) {
+  const BmFontFile::Info& info = font_file.info;
+  CookedBmFontHeader header{
+      .magic = {kCookedBmFontMagic[0], kCookedBmFontMagic[1],
+                kCookedBmFontMagic[2], kCookedBmFontMagic[3]},
+      .version = kCookedBmFontVersion,
+      .char_size = sizeof(BmFontFile::Char),
+      .kerning_size = sizeof(BmFontFile::Kerning),
+      .common = font_file.common,
+      .size = info.size,
+      .bold = info.bold,
+      .italic = info.italic,
+      .unicode = info.unicode,
+      .stretch_h = info.stretch_h,
+      .smooth = info.smooth,
+      .aa = info.aa,
+      .padding = {info.padding[0], info.padding[1], info.padding[2],
+                  info.padding[3]},
+      .spacing = {info.spacing[0], info.spacing[1]},
+      .outline = info.outline,
+      .face_length = (uint32_t)info.face.size(),
+      .charset_length = (uint32_t)info.charset.size(),
+      .num_pages = (uint32_t)font_file.pages.size(),
+      .num_chars = (uint32_t)font_file.chars.size(),
+      .num_kernings = (uint32_t)font_file.kernings.size(),
+  };
+
+  std::string content;
+  appendCooked(content, &header, 1);
+  content += info.face;
+  content += info.charset;
+  for (const auto& page : font_file.pages) {
+    uint32_t file_length = (uint32_t)page.file.size();
+    appendCooked(content, &page.id, 1);
+    appendCooked(content, &file_length, 1);
+    content += page.file;
+  }
+  appendCooked(content, font_file.chars.data(), font_file.chars.size());
+  appendCooked(content, font_file.kernings.data(), font_file.kernings.size());
+
+  return writeWholeFile(file_path, content);
+}
+
+bool LoadCookedBmFont(const std::string& file_path, BmFontFile& result) {
+  std::string content;
+  if (!readWholeFile(file_path, content)) {
+    return false;
+  }
+
+  size_t offset = 0;
+  CookedBmFontHeader header;
+  if (!readCooked(content, offset, &header, 1) ||
+      memcmp(header.magic, kCookedBmFontMagic, 4) != 0 ||
+      header.version != kCookedBmFontVersion ||
+      header.char_size != sizeof(BmFontFile::Char) ||
+      header.kerning_size != sizeof(BmFontFile::Kerning)) {
+    std::cerr << "[Symphony::Text::BmFontFile] Cooked font is from another "
+                 "build, file_path: "
+              << file_path << std::endl;
+    return false;
+  }
+
+  BmFontFile::Info& info = result.info;
+  result.common = header.common;
+  info.size = header.size;
+  info.bold = header.bold;
+  info.italic = header.italic;
+  info.unicode = header.unicode;
+  info.stretch_h = header.stretch_h;
+  info.smooth = header.smooth;
+  info.aa = header.aa;
+  memcpy(info.padding, header.padding, sizeof(info.padding));
+  memcpy(info.spacing, header.spacing, sizeof(info.spacing));
+  info.outline = header.outline;
+
+  bool is_complete =
+      readCookedString(content, offset, header.face_length, info.face) &&
+      readCookedString(content, offset, header.charset_length, info.charset);
+  // Every page takes at least its id and the length of its file name.
+  is_complete = is_complete &&
+                hasCookedItems(content, offset, header.num_pages,
+                               sizeof(BmFontFile::Page::id) + sizeof(uint32_t));
+  result.pages.resize(is_complete ? header.num_pages : 0);
+  for (auto& page : result.pages) {
+    uint32_t file_length = 0;
+    is_complete = is_complete && readCooked(content, offset, &page.id, 1) &&
+                  readCooked(content, offset, &file_length, 1) &&
+                  readCookedString(content, offset, file_length, page.file);
+  }
+  // Chars and kernings take the rest of the content.
+  is_complete = is_complete &&
+                hasCookedItems(content, offset, header.num_chars,
+                               sizeof(BmFontFile::Char));
+  size_t chars_size =
+      is_complete ? header.num_chars * sizeof(BmFontFile::Char) : 0;
+  is_complete = is_complete &&
+                hasCookedItems(content, offset + chars_size,
+                               header.num_kernings,
+                               sizeof(BmFontFile::Kerning)) &&
+                content.size() - offset - chars_size ==
+                    header.num_kernings * sizeof(BmFontFile::Kerning);
+  if (is_complete) {
+    result.chars.resize(header.num_chars);
+    result.kernings.resize(header.num_kernings);
+    is_complete = readCooked(content, offset, result.chars.data(),
+                             result.chars.size()) &&
+                  readCooked(content, offset, result.kernings.data(),
+                             result.kernings.size());
+  }
+
+  if (!is_complete) {
+    std::cerr << "[Symphony::Text::BmFontFile] Cooked font is cut, file_path: "
+              << file_path << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace Text
+}  // namespace Symphony
@@ -0,0 +1,201 @@
+#include "bm_font_file.hpp"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+using namespace Symphony::Text;
+
+namespace {
+const char kTextFont[] =
+    "info face=\"SysfontC\" size=20 bold=0 italic=0 charset=\"\" unicode=1 "
+    "stretchH=100 smooth=1 aa=1 padding=1,1,1,1 spacing=1,1\n"
+    "common lineHeight=21 base=14 scaleW=512 scaleH=64 pages=1 packed=0\n"
+    "page id=0 file=\"sysfont_20.png\"\n"
+    "chars count=3\n"
+    "char id=32 x=0 y=0 width=0 height=0 xoffset=0 yoffset=0 xadvance=5 "
+    "page=0 chnl=15\n"
+    "char id=65 x=44 y=18 width=5 height=14 xoffset=-1 yoffset=1 xadvance=5 "
+    "page=0 chnl=15\n"
+    "char id=1046 x=280 y=18 width=12 height=14 xoffset=0 yoffset=-2 "
+    "xadvance=13 page=0 chnl=15\n"
+    "kernings count=1\n"
+    "kerning first=65 second=1046 amount=-2\n";
+
+BmFontFile ParseTextFont() {
+  BmFontFile result;
+  EXPECT_TRUE(ParseBmFontText(kTextFont, "text_font.fnt", result));
+  return result;
+}
+
+void ExpectSameFont(const BmFontFile& expected, const BmFontFile& actual) {
+  EXPECT_EQ(expected.info, actual.info);
+  EXPECT_EQ(expected.common, actual.common);
+  EXPECT_EQ(expected.pages, actual.pages);
+  EXPECT_EQ(expected.chars, actual.chars);
+  EXPECT_EQ(expected.kernings, actual.kernings);
+}
+}  // namespace
+
+TEST(BmFontFile, ParsesText) {
+  BmFontFile font_file = ParseTextFont();
+
+  EXPECT_EQ(font_file.info.face, "SysfontC");
+  EXPECT_EQ(font_file.info.size, 20);
+  EXPECT_EQ(font_file.info.unicode, 1);
+  EXPECT_EQ(font_file.common.line_height, 21);
+  EXPECT_EQ(font_file.common.base, 14);
+  ASSERT_EQ(font_file.pages.size(), 1);
+  EXPECT_EQ(font_file.pages[0].file, "sysfont_20.png");
+  ASSERT_EQ(font_file.chars.size(), 3);
+  EXPECT_EQ(font_file.chars[2], (BmFontFile::Char{.id = 1046,
+                                                  .x = 280,
+                                                  .y = 18,
+                                                  .width = 12,
+                                                  .height = 14,
+                                                  .x_offset = 0,
+                                                  .y_offset = -2,
+                                                  .x_advance = 13,
+                                                  .page = 0,
+                                                  .chnl = 15}));
+  ASSERT_EQ(font_file.kernings.size(), 1);
+  EXPECT_EQ(font_file.kernings[0].amount, -2);
+}
+
+TEST(BmFontFile, ParsesBinary) {
+  // Blocks as BMFont writes them: type, size, then little-endian fields.
+  const unsigned char kBinaryFont[] = {
+      'B', 'M', 'F', 3,
+      // Info, unicode and smooth.
+      1, 16, 0, 0, 0, 20, 0, 0x03, 0, 100, 0, 1, 1, 2, 3, 4, 1, 1, 0, 'F', 0,
+      // Common.
+      2, 15, 0, 0, 0, 21, 0, 14, 0, 0, 2, 64, 0, 1, 0, 0, 0, 4, 4, 4,
+      // Pages.
+      3, 6, 0, 0, 0, 'a', '.', 'p', 'n', 'g', 0,
+      // Chars.
+      4, 20, 0, 0, 0, 0x16, 0x04, 0, 0, 0x2C, 0x01, 5, 0, 9, 0, 14, 0, 0xFF,
+      0xFF, 2, 0, 10, 0, 0, 15,
+      // Kerning pairs.
+      5, 10, 0, 0, 0, 65, 0, 0, 0, 86, 0, 0, 0, 0xFE, 0xFF};
+
+  BmFontFile font_file;
+  ASSERT_TRUE(ParseBmFontBinary(
+      std::string(reinterpret_cast<const char*>(kBinaryFont),
+                  sizeof(kBinaryFont)),
+      "binary_font.fnt", font_file));
+
+  EXPECT_EQ(font_file.info.face, "F");
+  EXPECT_EQ(font_file.info.size, 20);
+  EXPECT_EQ(font_file.info.smooth, 1);
+  EXPECT_EQ(font_file.info.unicode, 1);
+  EXPECT_EQ(font_file.info.bold, 0);
+  EXPECT_EQ(font_file.info.stretch_h, 100);
+  EXPECT_EQ(font_file.info.padding[3], 4);
+  EXPECT_EQ(font_file.common.line_height, 21);
+  EXPECT_EQ(font_file.common.scale_w, 512);
+  EXPECT_EQ(font_file.common.pages, 1);
+  EXPECT_EQ(font_file.common.red_chnl, 4);
+  ASSERT_EQ(font_file.pages.size(), 1);
+  EXPECT_EQ(font_file.pages[0].file, "a.png");
+  ASSERT_EQ(font_file.chars.size(), 1);
+  EXPECT_EQ(font_file.chars[0], (BmFontFile::Char{.id = 0x416,
+                                                  .x = 300,
+                                                  .y = 5,
+                                                  .width = 9,
+                                                  .height = 14,
+                                                  .x_offset = -1,
+                                                  .y_offset = 2,
+                                                  .x_advance = 10,
+                                                  .page = 0,
+                                                  .chnl = 15}));
+  ASSERT_EQ(font_file.kernings.size(), 1);
+  EXPECT_EQ(font_file.kernings[0],
+            (BmFontFile::Kerning{.first = 65, .second = 86, .amount = -2}));
+}
+
+TEST(BmFontFile, RejectsCutBinary) {
+  const char kCutFont[] = {'B', 'M', 'F', 3, 4, 20, 0, 0, 0, 32, 0};
+
+  BmFontFile font_file;
+  EXPECT_FALSE(ParseBmFontBinary(std::string(kCutFont, sizeof(kCutFont)),
+                                 "cut_font.fnt", font_file));
+}
+
+TEST(BmFontFile, LoadsSavedBinary) {
+  BmFontFile expected = ParseTextFont();
+  std::string file_path = ::testing::TempDir() + "bm_font_file_test.fnt";
+  ASSERT_TRUE(SaveBmFontBinary(file_path, expected));
+
+  BmFontFile actual;
+  ASSERT_TRUE(LoadBmFontFile(file_path, actual));
+  ExpectSameFont(expected, actual);
+}
+
+TEST(BmFontFile, LoadsSavedCooked) {
+  BmFontFile expected = ParseTextFont();
+  std::string file_path = ::testing::TempDir() + "bm_font_file_test.cooked";
+  ASSERT_TRUE(SaveCookedBmFont(file_path, expected));
+
+  BmFontFile actual;
+  ASSERT_TRUE(LoadCookedBmFont(file_path, actual));
+  ExpectSameFont(expected, actual);
+}
+
+TEST(BmFontFile, RejectsCutCooked) {
+  std::string file_path = ::testing::TempDir() + "bm_font_file_test.cooked";
+  ASSERT_TRUE(SaveCookedBmFont(file_path, ParseTextFont()));
+
+  std::string content;
+  {
+    std::ifstream file(file_path, std::ios::binary);
+    content.assign(std::istreambuf_iterator<char>(file), {});
+  }
+  {
+    std::ofstream file(file_path, std::ios::binary);
+    file.write(content.data(), content.size() - 1);
+  }
+
+  BmFontFile actual;
+  EXPECT_FALSE(LoadCookedBmFont(file_path, actual));
+}
+
+TEST(BmFontFile, RejectsCookedWithWrongCounts) {
+  std::string file_path = ::testing::TempDir() + "bm_font_file_test.cooked";
+  ASSERT_TRUE(SaveCookedBmFont(file_path, ParseTextFont()));
+
+  std::string content;
+  {
+    std::ifstream file(file_path, std::ios::binary);
+    content.assign(std::istreambuf_iterator<char>(file), {});
+  }
+
+  // Counts which would take gigabytes or overflow the sizes of arrays.
+  auto expect_rejected = [&](auto change_header) {
+    CookedBmFontHeader header;
+    memcpy(&header, content.data(), sizeof(header));
+    change_header(header);
+    std::string changed_content = content;
+    memcpy(changed_content.data(), &header, sizeof(header));
+    {
+      std::ofstream file(file_path, std::ios::binary);
+      file.write(changed_content.data(), changed_content.size());
+    }
+
+    BmFontFile actual;
+    EXPECT_FALSE(LoadCookedBmFont(file_path, actual));
+  };
+  expect_rejected([](CookedBmFontHeader& header) {
+    header.num_pages = 0xFFFFFFFF;
+  });
+  expect_rejected([](CookedBmFontHeader& header) {
+    header.num_chars = 0xFFFFFFFF;
+  });
+  expect_rejected([](CookedBmFontHeader& header) {
+    header.num_kernings = 0xFFFFFFFF;
+  });
+  expect_rejected([](CookedBmFontHeader& header) {
+    header.num_chars = 0x80000000;
+    header.num_kernings = 0x80000000;
+  });
+}
@@ -3,6 +3,8 @@
 #include <SDL3/SDL.h>
 #include <SDL3_image/SDL_image.h>
 
+#include <algorithm>
+#include <array>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -10,66 +12,20 @@
 #include <memory>
 #include <sstream>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "bm_font_file.hpp"
 #include "font.hpp"
 
 namespace Symphony {
 namespace Text {
 class BmFont : public Font {
  public:
-  struct Info {
-    std::string face;
-    int size{0};
-    int bold{0};
-    int italic{0};
-    std::string charset;
-    int unicode{0};
-    int stretch_h{0};
-    int smooth{0};
-    int aa{0};
-    int padding[4];
-    int spacing[2];
-    int outline{0};
-  };
-
-  struct Common {
-    int line_height{0};
-    int base{0};
-    int scale_w{0};
-    int scale_h{0};
-    int pages{0};
-    int packed{0};
-    int alpha_chnl{0};
-    int red_chnl{0};
-    int green_chnl{0};
-    int blue_chnl{0};
-  };
-
-  struct Page {
-    int id{0};
-    std::string file;
-  };
-
-  struct Char {
-    int id{0};
-    int x{0};
-    int y{0};
-    int width{0};
-    int height{0};
-    int x_offset{0};
-    int y_offset{0};
-    int x_advance{0};
-    int page{0};
-    int chnl{0};
-  };
-
-  struct Kerning {
-    int first{0};
-    int second{0};
-    int amount{0};
-  };
+  using Info = BmFontFile::Info;
+  using Common = BmFontFile::Common;
+  using Page = BmFontFile::Page;
+  using Char = BmFontFile::Char;
+  using Kerning = BmFontFile::Kerning;
 
   enum CharChannel {
     kCharChannelBlue = 1,
@@ -88,52 +44,62 @@ class BmFont : public Font {
   BmFont() = default;
   ~BmFont() = default;
 
+  // Loads the text or the binary format.
   bool Load(const std::string& file_path);
+  // Loads the cooked font when it isn't older than the font file, otherwise
+  // loads the font file.
+  bool Load(const std::string& file_path, const std::string& cooked_file_path);
   bool LoadTexture(std::shared_ptr<SDL_Renderer> renderer);
 
-  const Info GetInfo() const { return info_; }
+  const Info GetInfo() const { return font_file_.info; }
+
+  const Common GetCommon() const { return font_file_.common; }
 
-  const Common GetCommon() const { return common_; }
+  const std::vector<Page> GetPages() const { return font_file_.pages; }
 
-  const std::vector<Page> GetPages() const { return pages_; }
+  const std::vector<Char> GetChars() const { return font_file_.chars; }
 
-  const std::vector<Char> GetChars() const { return chars_; }
+  const std::vector<Kerning> GetKernings() const {
+    return font_file_.kernings;
+  }
 
-  const std::vector<Kerning> GetKernings() const { return kernings_; }
+  const BmFontFile& GetFontFile() const { return font_file_; }
 
   FontMeasurements GetFontMeasurements() const override {
     FontMeasurements result;
-    result.line_height = common_.line_height;
-    result.base = common_.base;
+    result.line_height = font_file_.common.line_height;
+    result.base = font_file_.common.base;
     return result;
   }
 
   Glyph GetGlyph(uint32_t code_position) const override;
 
+  const Glyph* GetAsciiGlyphs() const override { return basic_latin_.data(); }
+
   void* GetTexture() override { return sdl_texture_.get(); }
 
  private:
-  enum BlockType {
-    kBlockInfo,
-    kBlockCommon,
-    kBlockPage,
-    kBlockChars,
-    kBlockChar,
-    kBlockKerning,
-    kBlockUnknown,
-  };
-
   static void deleteTexture(SDL_Texture* sdl_texture) {
     SDL_DestroyTexture(sdl_texture);
   }
 
+  static constexpr uint32_t kNumBasicLatin = 0x80;
+  static constexpr uint32_t kFirstCyrillic = 0x400;
+  static constexpr uint32_t kNumCyrillic = 0x100;
+
+  // Checks that the font is supported and builds glyphs of its chars.
+  bool finishLoading(const std::string& file_path);
+
+  const Glyph& findOtherGlyph(uint32_t code_position) const;
+
   std::string file_path_;
-  Info info_;
-  Common common_;
-  std::vector<Page> pages_;
-  std::vector<Char> chars_;
-  std::vector<Kerning> kernings_;
-  std::unordered_map<uint32_t, size_t> code_position_to_char_;
+  BmFontFile font_file_;
+  // Glyphs are indexed by the code position in Basic Latin and Cyrillic,
+  // missing chars have empty glyphs. Other glyphs are sorted by the code
+  // position.
+  std::array<Glyph, kNumBasicLatin> basic_latin_;
+  std::array<Glyph, kNumCyrillic> cyrillic_;
+  std::vector<Glyph> other_glyphs_;
   std::shared_ptr<SDL_Texture> sdl_texture_;
 };
 
@@ -203,179 +169,51 @@ std::string BmFont::KerningToString(const Kerning& kerning) {
 }
 
 bool BmFont::Load(const std::string& file_path) {
-  std::ifstream file;
-
-  file.open(file_path);
-  if (!file.is_open()) {
-    std::cerr << "[Symphony::Text::BmFont] Can't open file, file_path: "
-              << file_path << std::endl;
+  font_file_ = BmFontFile();
+  if (!LoadBmFontFile(file_path, font_file_)) {
     return false;
   }
 
-  size_t num_chars = 0;
-
-  std::string block_content;
-  while (std::getline(file, block_content)) {
-    std::istringstream block_stream(block_content);
-
-    std::string block_type_string;
-    block_stream >> block_type_string;
-
-    BlockType block_type = kBlockUnknown;
-    if (block_type_string == "info") {
-      block_type = kBlockInfo;
-    } else if (block_type_string == "common") {
-      block_type = kBlockCommon;
-    } else if (block_type_string == "page") {
-      block_type = kBlockPage;
-      pages_.push_back(Page());
-    } else if (block_type_string == "chars") {
-      block_type = kBlockChars;
-    } else if (block_type_string == "char") {
-      block_type = kBlockChar;
-      chars_.push_back(Char());
-    } else if (block_type_string == "kerning") {
-      block_type = kBlockKerning;
-      kernings_.push_back(Kerning());
-    } else if (block_type == kBlockUnknown) {
-      continue;
-    }
+  return finishLoading(file_path);
+}
 
-    while (!block_stream.eof()) {
-      while (block_stream.peek() == ' ') {
-        block_stream.get();
-      }
-
-      std::string key;
-      std::getline(block_stream, key, '=');
-
-      std::string value;
-      if (block_stream.peek() == '\"') {
-        block_stream.get();
-        std::getline(block_stream, value, '\"');
-      } else {
-        block_stream >> value;
-      }
-
-      if (block_type == kBlockInfo) {
-        if (key == "face") {
-          info_.face = value;
-        } else if (key == "size") {
-          info_.size = std::stoi(value);
-        } else if (key == "bold") {
-          info_.bold = std::stoi(value);
-        } else if (key == "italic") {
-          info_.italic = std::stoi(value);
-        } else if (key == "charset") {
-          info_.charset = value;
-        } else if (key == "unicode") {
-          info_.unicode = std::stoi(value);
-        } else if (key == "stretchH") {
-          info_.stretch_h = std::stoi(value);
-        } else if (key == "smooth") {
-          info_.smooth = std::stoi(value);
-        } else if (key == "aa") {
-          info_.aa = std::stoi(value);
-        } else if (key == "padding") {
-          std::istringstream value_stream(value);
-          value_stream >> info_.padding[0];
-          value_stream >> info_.padding[1];
-          value_stream >> info_.padding[2];
-          value_stream >> info_.padding[3];
-        } else if (key == "spacing") {
-          std::istringstream value_stream(value);
-          value_stream >> info_.spacing[0];
-          value_stream >> info_.spacing[1];
-          ;
-        }
-      } else if (block_type == kBlockCommon) {
-        if (key == "lineHeight") {
-          common_.line_height = std::stoi(value);
-        } else if (key == "base") {
-          common_.base = std::stoi(value);
-        } else if (key == "scaleW") {
-          common_.scale_w = std::stoi(value);
-        } else if (key == "scaleH") {
-          common_.scale_h = std::stoi(value);
-        } else if (key == "pages") {
-          common_.pages = std::stoi(value);
-        } else if (key == "packed") {
-          common_.packed = std::stoi(value);
-        } else if (key == "alphaChnl") {
-          common_.alpha_chnl = std::stoi(value);
-        } else if (key == "redChnl") {
-          common_.red_chnl = std::stoi(value);
-        } else if (key == "greenChnl") {
-          common_.green_chnl = std::stoi(value);
-        } else if (key == "blueChnl") {
-          common_.blue_chnl = std::stoi(value);
-        }
-      } else if (block_type == kBlockPage) {
-        if (key == "id") {
-          pages_.back().id = std::stoi(value);
-        } else if (key == "file") {
-          pages_.back().file = value;
-        }
-      } else if (block_type == kBlockChars) {
-        if (key == "count") {
-          num_chars = (size_t)std::stoi(value);
-        }
-      } else if (block_type == kBlockChar) {
-        if (key == "id") {
-          chars_.back().id = std::stoi(value);
-        } else if (key == "x") {
-          chars_.back().x = std::stoi(value);
-        } else if (key == "y") {
-          chars_.back().y = std::stoi(value);
-        } else if (key == "width") {
-          chars_.back().width = std::stoi(value);
-        } else if (key == "height") {
-          chars_.back().height = std::stoi(value);
-        } else if (key == "xoffset") {
-          chars_.back().x_offset = std::stoi(value);
-        } else if (key == "yoffset") {
-          chars_.back().y_offset = std::stoi(value);
-        } else if (key == "xadvance") {
-          chars_.back().x_advance = std::stoi(value);
-        } else if (key == "page") {
-          chars_.back().page = std::stoi(value);
-        } else if (key == "chnl") {
-          chars_.back().chnl = std::stoi(value);
-        }
-      } else if (block_type == kBlockKerning) {
-        if (key == "first") {
-          kernings_.back().first = std::stoi(value);
-        } else if (key == "second") {
-          kernings_.back().second = std::stoi(value);
-        } else if (key == "amount") {
-          kernings_.back().amount = std::stoi(value);
-        }
-      }
+bool BmFont::Load(const std::string& file_path,
+                  const std::string& cooked_file_path) {
+  std::error_code error_code;
+  auto file_time = std::filesystem::last_write_time(file_path, error_code);
+  bool is_file_found = !error_code;
+  auto cooked_file_time =
+      std::filesystem::last_write_time(cooked_file_path, error_code);
+  bool is_cooked_file_found = !error_code;
+
+  // Cooked fonts are shipped without font files too.
+  if (is_cooked_file_found &&
+      (!is_file_found || cooked_file_time >= file_time)) {
+    font_file_ = BmFontFile();
+    if (LoadCookedBmFont(cooked_file_path, font_file_)) {
+      return finishLoading(file_path);
     }
   }
 
-  if (pages_.size() != 1) {
+  return Load(file_path);
+}
+
+bool BmFont::finishLoading(const std::string& file_path) {
+  if (font_file_.pages.size() != 1) {
     std::cerr << "[Symphony::Text::BmFont] Only fonts with single page are "
                  "supported, file_path: "
               << file_path << std::endl;
     return false;
   }
 
-  if (common_.packed != 0) {
+  if (font_file_.common.packed != 0) {
     std::cerr << "[Symphony::Text::BmFont] Characters shouldn't be packed in "
                  "separate color channels, file_path: "
               << file_path << std::endl;
     return false;
   }
 
-  if (num_chars != chars_.size()) {
-    std::cerr << "[Symphony::Text::BmFont] Wrong count in 'chars' block and "
-                 "number of 'char' blocks, file_path: "
-              << file_path << std::endl;
-    return false;
-  }
-
-  for (const auto& c : chars_) {
+  for (const auto& c : font_file_.chars) {
     if (c.chnl != kCharChannelAll) {
       std::cerr << "[Symphony::Text::BmFont] Only characters across all color "
                    "channels are supported, file_path: "
@@ -384,10 +222,31 @@ bool BmFont::Load(const std::string& file_path) {
     }
   }
 
-  for (size_t index = 0; const auto& c : chars_) {
-    code_position_to_char_[(uint32_t)c.id] = index;
-    ++index;
+  basic_latin_.fill(Glyph());
+  cyrillic_.fill(Glyph());
+  other_glyphs_.clear();
+  for (const auto& c : font_file_.chars) {
+    Glyph glyph{.texture_x = c.x,
+                .texture_y = c.y,
+                .texture_width = c.width,
+                .texture_height = c.height,
+                .x_offset = c.x_offset,
+                .y_offset = c.y_offset,
+                .x_advance = c.x_advance,
+                .code_position = (uint32_t)c.id};
+
+    if (glyph.code_position < kNumBasicLatin) {
+      basic_latin_[glyph.code_position] = glyph;
+    } else if (glyph.code_position - kFirstCyrillic < kNumCyrillic) {
+      cyrillic_[glyph.code_position - kFirstCyrillic] = glyph;
+    } else {
+      other_glyphs_.push_back(glyph);
+    }
   }
+  std::stable_sort(other_glyphs_.begin(), other_glyphs_.end(),
+                   [](const Glyph& left, const Glyph& right) {
+                     return left.code_position < right.code_position;
+                   });
 
   file_path_ = file_path;
 
@@ -396,7 +255,7 @@ bool BmFont::Load(const std::string& file_path) {
 
 bool BmFont::LoadTexture(std::shared_ptr<SDL_Renderer> sdl_renderer) {
   auto font_path = std::filesystem::path(file_path_);
-  auto texture_path = font_path.parent_path() / pages_[0].file;
+  auto texture_path = font_path.parent_path() / font_file_.pages[0].file;
 
   sdl_texture_.reset(IMG_LoadTexture(sdl_renderer.get(), texture_path.c_str()),
                      &deleteTexture);
@@ -411,24 +270,28 @@ bool BmFont::LoadTexture(std::shared_ptr<SDL_Renderer> sdl_renderer) {
 }
 
 Glyph BmFont::GetGlyph(uint32_t code_position) const {
-  Glyph result;
-
-  auto it = code_position_to_char_.find(code_position);
-  if (it == code_position_to_char_.end()) {
-    return result;
+  if (code_position < kNumBasicLatin) {
+    return basic_latin_[code_position];
   }
+  // Code positions before Cyrillic wrap around to big numbers.
+  if (code_position - kFirstCyrillic < kNumCyrillic) {
+    return cyrillic_[code_position - kFirstCyrillic];
+  }
+  return findOtherGlyph(code_position);
+}
 
-  const auto& c = chars_[it->second];
-  result.texture_x = c.x;
-  result.texture_y = c.y;
-  result.texture_width = c.width;
-  result.texture_height = c.height;
-  result.x_offset = c.x_offset;
-  result.y_offset = c.y_offset;
-  result.x_advance = c.x_advance;
-  result.code_position = code_position;
+const Glyph& BmFont::findOtherGlyph(uint32_t code_position) const {
+  static const Glyph kMissingGlyph;
 
-  return result;
+  auto it = std::lower_bound(other_glyphs_.begin(), other_glyphs_.end(),
+                             code_position,
+                             [](const Glyph& glyph, uint32_t value) {
+                               return glyph.code_position < value;
+                             });
+  if (it == other_glyphs_.end() || it->code_position != code_position) {
+    return kMissingGlyph;
+  }
+  return *it;
 }
 
 std::shared_ptr<BmFont> LoadBmFont(const std::string& file_path) {
@@ -439,5 +302,14 @@ std::shared_ptr<BmFont> LoadBmFont(const std::string& file_path) {
   return result;
 }
 
+std::shared_ptr<BmFont> LoadBmFont(const std::string& file_path,
+                                   const std::string& cooked_file_path) {
+  std::shared_ptr<BmFont> result(new BmFont());
+  if (!result->Load(file_path, cooked_file_path)) {
+    result.reset();
+  }
+  return result;
+}
+
 }  // namespace Text
 }  // namespace Symphony
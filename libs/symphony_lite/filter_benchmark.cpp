@@ -0,0 +1,84 @@
+// Filters mixed buffers with the vectorized and the scalar biquad filters and
+// reports how long each of them takes per output sample.
+//
+// Usage: filter_benchmark [num_seconds] [num_filters]
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "biquad_filter.hpp"
+
+using namespace Symphony::Audio;
+
+namespace {
+inline constexpr size_t kDefaultNumSeconds = 60;
+inline constexpr size_t kDefaultNumFilters = 32;
+inline constexpr int kSampleRate = 48000;
+// Blocks in one buffer of the device.
+inline constexpr size_t kNumBufferBlocks = 1024;
+
+using ProcessFunction = void (*)(StereoBlock32*, size_t,
+                                 const BiquadCoefficients&, BiquadState&);
+
+// Every filter processes its own buffer, as voices and buses do.
+double Measure(ProcessFunction process, size_t num_seconds,
+               size_t num_filters, int64_t& checksum) {
+  std::vector<StereoBlock32> buffers(num_filters * kNumBufferBlocks);
+  std::vector<BiquadCoefficients> coefficients(num_filters);
+  std::vector<BiquadState> states(num_filters);
+  for (size_t i = 0; i < num_filters; ++i) {
+    float cutoff_hz = 200.0f + (float)i * 100.0f;
+    coefficients[i] = GetBiquadCoefficients(
+        i % 2 ? HighPass(cutoff_hz) : LowPass(cutoff_hz), kSampleRate);
+  }
+
+  size_t num_buffers = num_seconds * kSampleRate / kNumBufferBlocks;
+  checksum = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t b = 0; b < num_buffers; ++b) {
+    for (size_t i = 0; i < num_filters; ++i) {
+      StereoBlock32* buffer = &buffers[i * kNumBufferBlocks];
+      // Saw tooth, as from a mixed voice.
+      for (size_t k = 0; k < kNumBufferBlocks; ++k) {
+        int32_t sample = (int32_t)((k * 64) % 8192) - 4096;
+        buffer[k] = StereoBlock32{.left = sample, .right = -sample};
+      }
+      process(buffer, kNumBufferBlocks, coefficients[i], states[i]);
+      checksum += buffer[kNumBufferBlocks - 1].left;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double num_ns =
+      (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  return num_ns / (double)(num_buffers * kNumBufferBlocks);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t num_seconds = argc > 1 ? (size_t)atoi(argv[1]) : kDefaultNumSeconds;
+  size_t num_filters = argc > 2 ? (size_t)atoi(argv[2]) : kDefaultNumFilters;
+
+  int64_t vector_checksum = 0;
+  int64_t scalar_checksum = 0;
+  double vector_ns =
+      Measure(ProcessBiquad, num_seconds, num_filters, vector_checksum);
+  double scalar_ns =
+      Measure(ProcessBiquadScalar, num_seconds, num_filters, scalar_checksum);
+
+  std::cout << "Mixing kernels: " << GetMixingKernelsName() << std::endl;
+  std::cout << "Filtered " << num_seconds << " s with " << num_filters
+            << " filters" << std::endl;
+  std::cout << "ns per output sample, vectorized: " << vector_ns
+            << ", scalar: " << scalar_ns << std::endl;
+  // Keeps the output from being optimized out.
+  std::cout << "Checksums: " << vector_checksum << ", " << scalar_checksum
+            << std::endl;
+
+  return 0;
+}
@@ -33,6 +33,11 @@ class Font {
 
   virtual Glyph GetGlyph(uint32_t code_position) const = 0;
 
+  // Glyphs of the code positions 0-127, indexed by the code position, which
+  // lets ASCII text be measured without a call per glyph. nullptr if the font
+  // has no such table.
+  virtual const Glyph* GetAsciiGlyphs() const { return nullptr; }
+
   virtual void* GetTexture() = 0;
 };
 }  // namespace Text
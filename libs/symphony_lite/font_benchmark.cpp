@@ -0,0 +1,120 @@
+// Loads fonts in the text, binary and cooked formats, as on start of a game,
+// and reports how long loading of one font takes.
+//
+// Usage: font_benchmark [num_starts] [num_fonts]
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bm_font_file.hpp"
+
+using namespace Symphony::Text;
+
+namespace {
+inline constexpr size_t kDefaultNumStarts = 60;
+inline constexpr size_t kDefaultNumFonts = 32;
+
+// Basic Latin, Latin-1 and Cyrillic, as a font for a translated game has.
+void SaveTextFont(const std::string& file_path) {
+  std::ofstream file(file_path, std::ios::binary);
+
+  std::vector<int> ids;
+  for (int id = 32; id < 127; ++id) {
+    ids.push_back(id);
+  }
+  for (int id = 160; id < 256; ++id) {
+    ids.push_back(id);
+  }
+  for (int id = 0x400; id < 0x460; ++id) {
+    ids.push_back(id);
+  }
+
+  file << "info face=\"Benchmark\" size=20 bold=0 italic=0 charset=\"\" "
+          "unicode=1 stretchH=100 smooth=1 aa=1 padding=1,1,1,1 spacing=1,1\n"
+       << "common lineHeight=21 base=14 scaleW=512 scaleH=512 pages=1 "
+          "packed=0\n"
+       << "page id=0 file=\"benchmark.png\"\n"
+       << "chars count=" << ids.size() << "\n";
+  for (size_t i = 0; i < ids.size(); ++i) {
+    file << "char id=" << ids[i] << " x=" << (i % 32) * 16
+         << " y=" << (i / 32) * 21 << " width=" << 8 + i % 5
+         << " height=14 xoffset=" << (int)(i % 3) - 1
+         << " yoffset=" << i % 4 << " xadvance=" << 9 + i % 5
+         << " page=0 chnl=15\n";
+  }
+  file << "kernings count=" << ids.size() / 2 << "\n";
+  for (size_t i = 0; i + 1 < ids.size(); i += 2) {
+    file << "kerning first=" << ids[i] << " second=" << ids[i + 1]
+         << " amount=-1\n";
+  }
+}
+
+template <typename LoadFunction>
+double Measure(LoadFunction load, const std::string& file_path,
+               size_t num_starts, size_t num_fonts, size_t& num_chars) {
+  num_chars = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_starts * num_fonts; ++i) {
+    BmFontFile font_file;
+    if (!load(file_path, font_file)) {
+      std::cout << "Can't load " << file_path << std::endl;
+      exit(1);
+    }
+    num_chars += font_file.chars.size();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double num_us =
+      (double)std::chrono::duration_cast<std::chrono::microseconds>(end -
+                                                                    start)
+          .count();
+  return num_us / (double)(num_starts * num_fonts);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t num_starts = argc > 1 ? (size_t)atoi(argv[1]) : kDefaultNumStarts;
+  size_t num_fonts = argc > 2 ? (size_t)atoi(argv[2]) : kDefaultNumFonts;
+
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+  std::string text_path = (temp_dir / "font_benchmark_text.fnt").string();
+  std::string binary_path = (temp_dir / "font_benchmark_binary.fnt").string();
+  std::string cooked_path = (temp_dir / "font_benchmark.cooked").string();
+
+  SaveTextFont(text_path);
+  BmFontFile font_file;
+  if (!LoadBmFontFile(text_path, font_file) ||
+      !SaveBmFontBinary(binary_path, font_file) ||
+      !SaveCookedBmFont(cooked_path, font_file)) {
+    std::cout << "Can't prepare fonts" << std::endl;
+    return 1;
+  }
+
+  size_t text_chars = 0;
+  size_t binary_chars = 0;
+  size_t cooked_chars = 0;
+  double text_us =
+      Measure(LoadBmFontFile, text_path, num_starts, num_fonts, text_chars);
+  double binary_us =
+      Measure(LoadBmFontFile, binary_path, num_starts, num_fonts, binary_chars);
+  double cooked_us = Measure(LoadCookedBmFont, cooked_path, num_starts,
+                             num_fonts, cooked_chars);
+
+  std::cout << "Loaded " << num_fonts << " fonts of "
+            << font_file.chars.size() << " chars " << num_starts << " times"
+            << std::endl;
+  std::cout << "us per font, text: " << text_us << ", binary: " << binary_us
+            << ", cooked: " << cooked_us << std::endl;
+  // Keeps the loading from being optimized out.
+  std::cout << "Chars: " << text_chars << ", " << binary_chars << ", "
+            << cooked_chars << std::endl;
+
+  return 0;
+}
@@ -227,9 +227,22 @@ struct Paragraph {
   std::vector<StyleRun> style_runs;
 };
 
+// Where the value of a <sub> tag is in the formatted text: values can be
+// replaced in place, without parsing the text again.
+struct VariableSlot {
+  std::string variable_name;
+  size_t paragraph_index{0};
+  size_t style_run_index{0};
+  // Of the value in the text of the style run.
+  size_t offset{0};
+  size_t length{0};
+};
+
 struct FormattedText {
   // TODO(truvorskameikin): Switch to using lists.
   std::vector<Paragraph> paragraphs;
+  // In the order of the text.
+  std::vector<VariableSlot> variable_slots;
 };
 
 std::optional<FormattedText> FormatText(
@@ -247,6 +260,20 @@ std::optional<FormattedText> FormatText(
   std::stack<StyleWithParagraphParameters> styles_stack;
   styles_stack.push(default_style_with_aligment);
 
+  // Style runs which hold values of variables are kept even when they are
+  // empty: a value can become non-empty later, in place.
+  auto can_reuse_style_run = [&result]() {
+    const Paragraph& paragraph = result.paragraphs.back();
+    if (!paragraph.style_runs.back().text.empty()) {
+      return false;
+    }
+    return result.variable_slots.empty() ||
+           result.variable_slots.back().paragraph_index !=
+               result.paragraphs.size() - 1 ||
+           result.variable_slots.back().style_run_index !=
+               paragraph.style_runs.size() - 1;
+  };
+
   std::istringstream input_stream(input);
   while (!input_stream.eof()) {
     int next_char = input_stream.peek();
@@ -281,7 +308,7 @@ std::optional<FormattedText> FormatText(
           if (styles_stack.size() > 1) {
             styles_stack.pop();
 
-            if (!result.paragraphs.back().style_runs.back().text.empty()) {
+            if (!can_reuse_style_run()) {
               result.paragraphs.back().style_runs.push_back(StyleRun());
               result.paragraphs.back().style_runs.back().style =
                   StyleFromStyleWithParagraphParameters(styles_stack.top());
@@ -311,6 +338,7 @@ std::optional<FormattedText> FormatText(
       }
 
       StyleWithParagraphParameters style_with_alignment = styles_stack.top();
+      std::string variable_name;
       std::string variable_value;
 
       while (input_stream.peek() != '>') {
@@ -373,7 +401,7 @@ std::optional<FormattedText> FormatText(
               return std::nullopt;
             }
 
-            std::string variable_name = value.substr(1);
+            variable_name = value.substr(1);
 
             auto variable_it = variables.find(variable_name);
             if (variable_it == variables.end()) {
@@ -409,7 +437,7 @@ std::optional<FormattedText> FormatText(
               style_with_alignment.wrapping_opt.value();
         }
 
-        if (!result.paragraphs.back().style_runs.back().text.empty()) {
+        if (!can_reuse_style_run()) {
           result.paragraphs.back().style_runs.push_back(StyleRun());
         }
 
@@ -418,9 +446,15 @@ std::optional<FormattedText> FormatText(
 
         styles_stack.push(style_with_alignment);
       } else if (tag == kTagSub) {
-        result.paragraphs.back().style_runs.back().text.insert(
-            result.paragraphs.back().style_runs.back().text.end(),
-            variable_value.begin(), variable_value.end());
+        Paragraph& paragraph = result.paragraphs.back();
+        std::string& text = paragraph.style_runs.back().text;
+        result.variable_slots.push_back(
+            VariableSlot{.variable_name = variable_name,
+                         .paragraph_index = result.paragraphs.size() - 1,
+                         .style_run_index = paragraph.style_runs.size() - 1,
+                         .offset = text.size(),
+                         .length = variable_value.size()});
+        text.insert(text.end(), variable_value.begin(), variable_value.end());
       }
     } else {
       char c = 0;
@@ -437,10 +471,17 @@ std::optional<FormattedText> FormatText(
     }
   }
 
+  // Style runs up to the last one with a variable slot are kept.
+  std::vector<size_t> num_kept_style_runs(result.paragraphs.size(), 0);
+  for (const auto& slot : result.variable_slots) {
+    num_kept_style_runs[slot.paragraph_index] = slot.style_run_index + 1;
+  }
+
   // We don't need empty style runs in the end of paragraph. But let's keep
   // empty paragraphs.
-  for (auto& paragraph : result.paragraphs) {
-    while (!paragraph.style_runs.empty() &&
+  for (size_t i = 0; i < result.paragraphs.size(); ++i) {
+    auto& paragraph = result.paragraphs[i];
+    while (paragraph.style_runs.size() > num_kept_style_runs[i] &&
            paragraph.style_runs.back().text.empty()) {
       paragraph.style_runs.pop_back();
     }
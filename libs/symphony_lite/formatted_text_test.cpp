@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
+#include <string>
+
 using namespace Symphony::Text;
 
 TEST(FormattedText, SingleLine) {
@@ -106,6 +109,111 @@ TEST(FormattedText, AlignsParagraphs) {
             "Again left align");
 }
 
+TEST(FormattedText, RecordsVariableSlots) {
+  auto formatted_text = FormatText(
+      "Time: <sub variable=\"$minutes\">:<sub variable=\"$seconds\">\n"
+      "<style color=\"red\">Fps: <sub variable=\"$fps_count\"></>",
+      Style(), ParagraphParameters(),
+      {{"minutes", "1"}, {"seconds", "05"}, {"fps_count", "60"}});
+  ASSERT_TRUE(formatted_text.has_value());
+  ASSERT_EQ((int)formatted_text->variable_slots.size(), 3);
+
+  const auto& minutes = formatted_text->variable_slots[0];
+  ASSERT_EQ(minutes.variable_name, "minutes");
+  ASSERT_EQ((int)minutes.paragraph_index, 0);
+  ASSERT_EQ((int)minutes.style_run_index, 0);
+  ASSERT_EQ((int)minutes.offset, 6);
+  ASSERT_EQ((int)minutes.length, 1);
+
+  const auto& seconds = formatted_text->variable_slots[1];
+  ASSERT_EQ(seconds.variable_name, "seconds");
+  ASSERT_EQ((int)seconds.paragraph_index, 0);
+  ASSERT_EQ((int)seconds.style_run_index, 0);
+  ASSERT_EQ((int)seconds.offset, 8);
+  ASSERT_EQ((int)seconds.length, 2);
+
+  const auto& fps_count = formatted_text->variable_slots[2];
+  ASSERT_EQ(fps_count.variable_name, "fps_count");
+  ASSERT_EQ((int)fps_count.paragraph_index, 1);
+  ASSERT_EQ((int)fps_count.style_run_index, 0);
+  ASSERT_EQ(formatted_text->paragraphs[1]
+                .style_runs[0]
+                .text.substr(fps_count.offset, fps_count.length),
+            "60");
+}
+
+namespace {
+// Replaces values in place, as TextRenderer does when only values change.
+void ReplaceValues(FormattedText& formatted_text,
+                   const std::map<std::string, std::string>& variables) {
+  auto& slots = formatted_text.variable_slots;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    VariableSlot& slot = slots[i];
+    const std::string& value = variables.at(slot.variable_name);
+    formatted_text.paragraphs[slot.paragraph_index]
+        .style_runs[slot.style_run_index]
+        .text.replace(slot.offset, slot.length, value);
+    for (size_t j = i + 1; j < slots.size() &&
+                           slots[j].paragraph_index == slot.paragraph_index &&
+                           slots[j].style_run_index == slot.style_run_index;
+         ++j) {
+      slots[j].offset = slots[j].offset + value.size() - slot.length;
+    }
+    slot.length = value.size();
+  }
+}
+
+void ExpectSameRuns(const FormattedText& expected,
+                    const FormattedText& actual) {
+  ASSERT_EQ(expected.paragraphs.size(), actual.paragraphs.size());
+  for (size_t i = 0; i < expected.paragraphs.size(); ++i) {
+    const auto& expected_runs = expected.paragraphs[i].style_runs;
+    const auto& actual_runs = actual.paragraphs[i].style_runs;
+    ASSERT_EQ(expected_runs.size(), actual_runs.size());
+    for (size_t j = 0; j < expected_runs.size(); ++j) {
+      EXPECT_EQ(expected_runs[j].text, actual_runs[j].text);
+      EXPECT_EQ(expected_runs[j].style.font, actual_runs[j].style.font);
+      EXPECT_EQ(expected_runs[j].style.color, actual_runs[j].style.color);
+    }
+  }
+}
+}  // namespace
+
+TEST(FormattedText, KeepsSlotsOfEmptyValues) {
+  const std::string kText =
+      "<style font=\"keys.fnt\"><sub variable=\"$keys\"></><style "
+      "font=\"fps.fnt\">Fps</>\nKeys: <sub variable=\"$keys\">";
+  auto format = [&kText](const std::string& keys) {
+    return FormatText(kText, Style(), ParagraphParameters(),
+                      {{"keys", keys}});
+  };
+
+  auto empty_text = format("");
+  ASSERT_TRUE(empty_text.has_value());
+  ASSERT_EQ((int)empty_text->variable_slots.size(), 2);
+  EXPECT_EQ((int)empty_text->variable_slots[0].length, 0);
+  EXPECT_EQ((int)empty_text->variable_slots[1].length, 0);
+  // Runs which hold empty values are neither reused nor dropped.
+  ASSERT_EQ((int)empty_text->paragraphs[0].style_runs.size(), 2);
+  EXPECT_EQ(empty_text->paragraphs[0].style_runs[0].style.font, "keys.fnt");
+  EXPECT_EQ(empty_text->paragraphs[0].style_runs[1].style.font, "fps.fnt");
+  EXPECT_EQ(empty_text->paragraphs[0].style_runs[1].text, "Fps");
+  ASSERT_EQ((int)empty_text->paragraphs[1].style_runs.size(), 1);
+  EXPECT_EQ(empty_text->paragraphs[1].style_runs[0].text, "Keys: ");
+
+  // A value goes non-empty and empty again in place, and the text is the
+  // same as formatted from scratch.
+  auto keys_text = format("W A");
+  ASSERT_TRUE(keys_text.has_value());
+  FormattedText text = empty_text.value();
+  ReplaceValues(text, {{"keys", "W A"}});
+  ExpectSameRuns(keys_text.value(), text);
+  ReplaceValues(text, {{"keys", ""}});
+  ExpectSameRuns(empty_text.value(), text);
+  ReplaceValues(text, {{"keys", "W A"}});
+  ExpectSameRuns(keys_text.value(), text);
+}
+
 TEST(FormattedText, Stress) {
   auto formatted_text = FormatText(
       "<style font=\"system_30.fnt\" align=\"left\" "
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+namespace Symphony {
+namespace Text {
+// Keeps at most max_num_items values, the least recently used one is dropped
+// first. Items are searched one by one, the cache is meant for a few dozen of
+// items with cheap to compare keys.
+template <typename Key, typename Value>
+class LruCache {
+ public:
+  explicit LruCache(size_t max_num_items) : max_num_items_(max_num_items) {
+    items_.reserve(max_num_items_);
+  }
+
+  LruCache(const LruCache&) = delete;
+  LruCache& operator=(const LruCache&) = delete;
+
+  // Returns nullptr when there's no value for the key. The found value becomes
+  // the most recently used one.
+  const Value* Find(const Key& key) {
+    for (auto& item : items_) {
+      if (item.key == key) {
+        item.last_use = ++num_uses_;
+        return &item.value;
+      }
+    }
+    return nullptr;
+  }
+
+  // Replaces the value for the key, or the least recently used value when the
+  // cache is full.
+  void Insert(Key key, Value value) {
+    if (!max_num_items_) {
+      return;
+    }
+
+    Item* item_to_replace = nullptr;
+    for (auto& item : items_) {
+      if (item.key == key) {
+        item_to_replace = &item;
+        break;
+      }
+    }
+    if (!item_to_replace && items_.size() == max_num_items_) {
+      item_to_replace = &items_.front();
+      for (auto& item : items_) {
+        if (item.last_use < item_to_replace->last_use) {
+          item_to_replace = &item;
+        }
+      }
+    }
+
+    if (item_to_replace) {
+      item_to_replace->key = std::move(key);
+      item_to_replace->value = std::move(value);
+      item_to_replace->last_use = ++num_uses_;
+    } else {
+      items_.push_back(Item{.key = std::move(key),
+                            .value = std::move(value),
+                            .last_use = ++num_uses_});
+    }
+  }
+
+  void Clear() { items_.clear(); }
+
+  size_t GetSize() const { return items_.size(); }
+
+  size_t GetMaxSize() const { return max_num_items_; }
+
+ private:
+  struct Item {
+    Key key;
+    Value value;
+    uint64_t last_use{0};
+  };
+
+  size_t max_num_items_{0};
+  std::vector<Item> items_;
+  uint64_t num_uses_{0};
+};
+}  // namespace Text
+}  // namespace Symphony
@@ -0,0 +1,56 @@
+#include "lru_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace Symphony::Text;
+
+TEST(LruCache, FindsInsertedValues) {
+  LruCache<std::string, int> cache(/*max_num_items*/ 4);
+  ASSERT_EQ(cache.Find("one"), nullptr);
+
+  cache.Insert("one", 1);
+  cache.Insert("two", 2);
+  ASSERT_EQ(cache.GetSize(), 2);
+  ASSERT_NE(cache.Find("one"), nullptr);
+  EXPECT_EQ(*cache.Find("one"), 1);
+  ASSERT_NE(cache.Find("two"), nullptr);
+  EXPECT_EQ(*cache.Find("two"), 2);
+  EXPECT_EQ(cache.Find("three"), nullptr);
+}
+
+TEST(LruCache, InsertReplacesValueOfSameKey) {
+  LruCache<std::string, int> cache(/*max_num_items*/ 4);
+  cache.Insert("one", 1);
+  cache.Insert("one", 10);
+
+  ASSERT_EQ(cache.GetSize(), 1);
+  ASSERT_NE(cache.Find("one"), nullptr);
+  EXPECT_EQ(*cache.Find("one"), 10);
+}
+
+TEST(LruCache, DropsLeastRecentlyUsed) {
+  LruCache<std::string, int> cache(/*max_num_items*/ 3);
+  cache.Insert("one", 1);
+  cache.Insert("two", 2);
+  cache.Insert("three", 3);
+
+  // "two" becomes the least recently used.
+  ASSERT_NE(cache.Find("one"), nullptr);
+  cache.Insert("four", 4);
+
+  ASSERT_EQ(cache.GetSize(), 3);
+  EXPECT_EQ(cache.Find("two"), nullptr);
+  EXPECT_NE(cache.Find("one"), nullptr);
+  EXPECT_NE(cache.Find("three"), nullptr);
+  EXPECT_NE(cache.Find("four"), nullptr);
+}
+
+TEST(LruCache, ZeroSizeKeepsNothing) {
+  LruCache<std::string, int> cache(/*max_num_items*/ 0);
+  cache.Insert("one", 1);
+
+  EXPECT_EQ(cache.GetSize(), 0);
+  EXPECT_EQ(cache.Find("one"), nullptr);
+}
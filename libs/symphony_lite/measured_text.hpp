@@ -1,10 +1,14 @@
 #pragma once
 
+#include <stdint.h>
+
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <memory>
-#include <stack>
-#include <tuple>
-#include <unordered_map>
+#include <optional>
+#include <span>
+#include <vector>
 
 #include "font.hpp"
 #include "formatted_text.hpp"
@@ -34,6 +38,14 @@ struct MeasuredGlyph {
   Font* from_font{nullptr};
 };
 
+// Glyphs of one font in a line: first and count are a range in
+// MeasuredText::font_glyphs.
+struct FontGlyphRange {
+  Font* font{nullptr};
+  size_t first{0};
+  size_t count{0};
+};
+
 // See: https://www.angelcode.com/products/bmfont/doc/render_text.html.
 struct MeasuredTextLine {
   HorizontalAlignment align{HorizontalAlignment::kLeft};
@@ -43,38 +55,145 @@ struct MeasuredTextLine {
   int line_height{0};
   int base{0};
   int align_offset{0};
-  std::list<MeasuredGlyph> glyphs;
-  std::unordered_map<Font*, std::list<MeasuredGlyph*>> font_to_glyph;
+  // Range in MeasuredText::glyphs.
+  size_t first_glyph{0};
+  size_t num_glyphs{0};
+  // Range in MeasuredText::font_ranges.
+  size_t first_font_range{0};
+  size_t num_font_ranges{0};
 };
 
-namespace {
-MeasuredGlyph* addGlyph(MeasuredTextLine& measured_line, const Glyph& glyph) {
-  measured_line.glyphs.push_back(MeasuredGlyph());
-  auto* cur_measured_glyph_ptr = &measured_line.glyphs.back();
+// Lines, glyphs and their grouping by font are kept in flat arrays, which
+// keep their capacity when the text is measured again: measuring a text of
+// the same size doesn't allocate.
+struct MeasuredText {
+  std::span<const MeasuredGlyph> GetGlyphs(
+      const MeasuredTextLine& measured_line) const {
+    return std::span<const MeasuredGlyph>(
+        glyphs.data() + measured_line.first_glyph, measured_line.num_glyphs);
+  }
+
+  std::span<const FontGlyphRange> GetFontRanges(
+      const MeasuredTextLine& measured_line) const {
+    return std::span<const FontGlyphRange>(
+        font_ranges.data() + measured_line.first_font_range,
+        measured_line.num_font_ranges);
+  }
 
-  if (measured_line.glyphs.size() == 1) {
-    measured_line.line_x_advance = -glyph.x_offset;
+  // Keeps capacity.
+  void Clear() {
+    measured_lines.clear();
+    glyphs.clear();
+    font_glyphs.clear();
+    font_ranges.clear();
+    paragraph_num_lines.clear();
   }
 
-  cur_measured_glyph_ptr->glyph = glyph;
+  std::vector<MeasuredTextLine> measured_lines;
+  // Glyphs of all lines, line after line.
+  std::vector<MeasuredGlyph> glyphs;
+  // Indices in glyphs, grouped by font line after line, so that a line is
+  // drawn with one call per font.
+  std::vector<uint32_t> font_glyphs;
+  std::vector<FontGlyphRange> font_ranges;
+  // Lines of every paragraph of the formatted text, in order.
+  std::vector<size_t> paragraph_num_lines;
+  std::map<std::string, std::shared_ptr<Font>> fonts;
+};
 
-  cur_measured_glyph_ptr->line_x_advance_before_this_glyph =
+namespace {
+// Places the glyph at the end of the line, the glyph should be right after the
+// last glyph of the line in MeasuredText::glyphs.
+void placeGlyph(MeasuredTextLine& measured_line,
+                MeasuredGlyph& measured_glyph) {
+  if (measured_line.num_glyphs == 0) {
+    measured_line.line_x_advance = -measured_glyph.glyph.x_offset;
+  }
+  ++measured_line.num_glyphs;
+
+  measured_glyph.line_x_advance_before_this_glyph =
       measured_line.line_x_advance;
-  cur_measured_glyph_ptr->line_width_before_this_glyph =
-      measured_line.line_width;
+  measured_glyph.line_width_before_this_glyph = measured_line.line_width;
   measured_line.line_width = measured_line.line_x_advance +
-                             cur_measured_glyph_ptr->glyph.x_offset +
-                             cur_measured_glyph_ptr->glyph.texture_width;
-  measured_line.line_x_advance += cur_measured_glyph_ptr->glyph.x_advance;
+                             measured_glyph.glyph.x_offset +
+                             measured_glyph.glyph.texture_width;
+  measured_line.line_x_advance += measured_glyph.glyph.x_advance;
+}
+
+// Lines from first_line, font glyphs from first_font_glyph and font ranges
+// from first_font_range refer to glyphs and font ranges which have moved by
+// the deltas. Font glyphs move with glyphs: a line has as many of them as
+// glyphs.
+void moveMeasuredRanges(MeasuredText& measured_text, size_t first_line,
+                        size_t first_font_glyph, size_t first_font_range,
+                        ptrdiff_t glyphs_delta, ptrdiff_t font_ranges_delta) {
+  for (size_t i = first_line; i < measured_text.measured_lines.size(); ++i) {
+    measured_text.measured_lines[i].first_glyph += glyphs_delta;
+    measured_text.measured_lines[i].first_font_range += font_ranges_delta;
+  }
+  for (size_t i = first_font_glyph; i < measured_text.font_glyphs.size();
+       ++i) {
+    measured_text.font_glyphs[i] += (uint32_t)glyphs_delta;
+  }
+  for (size_t i = first_font_range; i < measured_text.font_ranges.size();
+       ++i) {
+    measured_text.font_ranges[i].first += glyphs_delta;
+  }
+}
 
-  return cur_measured_glyph_ptr;
+// Replaces num_old items from first with items of source.
+template <typename T>
+void replaceItems(std::vector<T>& items, size_t first, size_t num_old,
+                  const std::vector<T>& source) {
+  size_t num_common = std::min(num_old, source.size());
+  std::copy(source.begin(), source.begin() + num_common,
+            items.begin() + first);
+  if (num_old > source.size()) {
+    items.erase(items.begin() + first + num_common,
+                items.begin() + first + num_old);
+  } else {
+    items.insert(items.begin() + first + num_common,
+                 source.begin() + num_common, source.end());
+  }
 }
 }  // namespace
 
-struct MeasuredText {
-  std::list<MeasuredTextLine> measured_lines;
-  std::map<std::string, std::shared_ptr<Font>> fonts;
-};
+// Appends lines of the paragraph to measured_text and their number to
+// paragraph_num_lines. Paragraphs don't depend on each other, so a paragraph
+// which text has changed can be measured again alone.
+bool MeasureParagraph(
+    int container_width, const Paragraph& paragraph, size_t paragraph_index,
+    const std::map<std::string, std::shared_ptr<Font>>& fonts,
+    MeasuredText& measured_text);
+
+// Replaces lines of the paragraph with the only paragraph of
+// measured_paragraph.
+void ReplaceMeasuredParagraph(MeasuredText& measured_text,
+                              size_t paragraph_index,
+                              const MeasuredText& measured_paragraph);
+
+// Measures into result, reusing its capacity. Fonts are kept in result.
+bool MeasureText(int container_width, const FormattedText& formatted_text,
+                 const std::map<std::string, std::shared_ptr<Font>>& fonts,
+                 MeasuredText& result) {
+  result.Clear();
+  if (result.fonts != fonts) {
+    result.fonts = fonts;
+  }
+
+  result.paragraph_num_lines.reserve(formatted_text.paragraphs.size());
+  for (size_t paragraph_index = 0;
+       const auto& paragraph : formatted_text.paragraphs) {
+    if (!MeasureParagraph(container_width, paragraph, paragraph_index, fonts,
+                          result)) {
+      return false;
+    }
+
+    ++paragraph_index;
+  }
+
+  return true;
+}
 
 std::optional<MeasuredText> MeasureText(
     int container_width, const FormattedText& formatted_text,
@@ -83,122 +202,175 @@ std::optional<MeasuredText> MeasureText(
   (void)variables;
 
   MeasuredText result;
-  result.fonts = fonts;
-
-  if (formatted_text.paragraphs.empty()) {
-    return result;
+  if (!MeasureText(container_width, formatted_text, fonts, result)) {
+    return std::nullopt;
   }
+  return result;
+}
 
-  for (size_t paragraph_index = 0;
-       const auto& paragraph : formatted_text.paragraphs) {
-    result.measured_lines.push_back(MeasuredTextLine());
-    auto* cur_measured_line_ptr = &result.measured_lines.back();
+bool MeasureParagraph(
+    int container_width, const Paragraph& paragraph, size_t paragraph_index,
+    const std::map<std::string, std::shared_ptr<Font>>& fonts,
+    MeasuredText& measured_text) {
+  std::vector<MeasuredTextLine>& measured_lines = measured_text.measured_lines;
+  std::vector<MeasuredGlyph>& glyphs = measured_text.glyphs;
+
+  // Glyphs are decoded first. Until they are placed on lines,
+  // line_x_advance_before_this_glyph is the advance from the start of the
+  // paragraph.
+  size_t first_glyph = glyphs.size();
+  int paragraph_x_advance = 0;
+  for (const auto& style_run : paragraph.style_runs) {
+    auto style_font_it = fonts.find(style_run.style.font);
+    if (style_font_it == fonts.end()) {
+      LOGE("[Symphony::Text::MeasuredText] Unknown font, paragraph: {}",
+           paragraph_index);
+      return false;
+    }
+
+    Font* font = style_font_it->second.get();
+    const Glyph* ascii_glyphs = font->GetAsciiGlyphs();
+    uint32_t color = style_run.style.color;
+
+    auto add_glyph = [&](const Glyph& glyph) {
+      glyphs.push_back(MeasuredGlyph());
+      MeasuredGlyph& cur_measured_glyph = glyphs.back();
+      cur_measured_glyph.glyph = glyph;
+      cur_measured_glyph.color = color;
+      cur_measured_glyph.from_font = font;
+      cur_measured_glyph.line_x_advance_before_this_glyph =
+          paragraph_x_advance;
+      paragraph_x_advance += glyph.x_advance;
+    };
+
+    const char* text = style_run.text.data();
+    size_t text_length = style_run.text.size();
+
+    while (text_length) {
+      // A run of ASCII chars is looked up in the table of the font at once.
+      if (ascii_glyphs) {
+        size_t ascii_length = 0;
+        while (ascii_length < text_length &&
+               (uint8_t)text[ascii_length] < 0x80) {
+          ++ascii_length;
+        }
+        for (size_t i = 0; i < ascii_length; ++i) {
+          add_glyph(ascii_glyphs[(uint8_t)text[i]]);
+        }
+
+        text += ascii_length;
+        text_length -= ascii_length;
+        if (!text_length) {
+          break;
+        }
+      }
 
-    cur_measured_line_ptr->align = paragraph.paragraph_parameters.align;
-    cur_measured_line_ptr->wrapping = paragraph.paragraph_parameters.wrapping;
+      auto utf_result = ParseUtf8Sequence<false>(text, text_length);
+      if (!utf_result.code_position.has_value()) {
+        LOGE(
+            "[Symphony::Text::MeasuredText] Not a valid UTF-8 text, "
+            "paragraph: {}",
+            paragraph_index);
+        return false;
+      }
 
-    auto paragraph_font_it = fonts.find(paragraph.font);
-    if (paragraph_font_it != fonts.end()) {
-      auto font_measurements = paragraph_font_it->second->GetFontMeasurements();
-      result.measured_lines.back().line_height = font_measurements.line_height;
+      text += utf_result.parsed_sequence_length;
+      text_length -= utf_result.parsed_sequence_length;
+
+      add_glyph(font->GetGlyph(utf_result.code_position.value()));
     }
+  }
+  size_t end_glyph = glyphs.size();
+
+  size_t first_line_index = measured_lines.size();
+  measured_lines.push_back(MeasuredTextLine());
+  measured_lines.back().first_glyph = first_glyph;
+  measured_lines.back().align = paragraph.paragraph_parameters.align;
+  measured_lines.back().wrapping = paragraph.paragraph_parameters.wrapping;
+
+  auto paragraph_font_it = fonts.find(paragraph.font);
+  if (paragraph_font_it != fonts.end()) {
+    auto font_measurements = paragraph_font_it->second->GetFontMeasurements();
+    measured_lines.back().line_height = font_measurements.line_height;
+  }
+
+  // Lines are broken by glyph index, glyphs stay where they are decoded.
+  if (paragraph.paragraph_parameters.wrapping == Wrapping::kWordWrap) {
+    // Width of glyphs from first to last placed on a line.
+    auto get_line_width = [&glyphs](size_t first, size_t last) {
+      const MeasuredGlyph& first_measured_glyph = glyphs[first];
+      const MeasuredGlyph& last_measured_glyph = glyphs[last];
+      return last_measured_glyph.line_x_advance_before_this_glyph -
+             first_measured_glyph.line_x_advance_before_this_glyph -
+             first_measured_glyph.glyph.x_offset +
+             last_measured_glyph.glyph.x_offset +
+             last_measured_glyph.glyph.texture_width;
+    };
 
     bool has_prev_not_whitespace = false;
-    auto line_prev_whitespace_it = cur_measured_line_ptr->glyphs.end();
-
-    for (const auto& style_run : paragraph.style_runs) {
-      auto style_font_it = fonts.find(style_run.style.font);
-      if (style_font_it == fonts.end()) {
-        LOGE("[Symphony::Text::MeasuredText] Unknown font, paragraph: {}",
-             paragraph_index);
-        return std::nullopt;
+    constexpr size_t kNoWhitespace = (size_t)-1;
+    size_t line_prev_whitespace_index = kNoWhitespace;
+    for (size_t i = first_glyph; i < end_glyph; ++i) {
+      if (IsWhitespace(glyphs[i].glyph.code_position)) {
+        if (has_prev_not_whitespace) {
+          has_prev_not_whitespace = false;
+
+          line_prev_whitespace_index = i;
+        }
+        continue;
       }
 
-      uint32_t color = style_run.style.color;
+      has_prev_not_whitespace = true;
+      MeasuredTextLine& cur_measured_line = measured_lines.back();
+      if (line_prev_whitespace_index == kNoWhitespace ||
+          get_line_width(cur_measured_line.first_glyph, i) <=
+              container_width) {
+        continue;
+      }
 
-      const char* text = style_run.text.data();
-      size_t text_length = style_run.text.size();
+      cur_measured_line.num_glyphs =
+          line_prev_whitespace_index - cur_measured_line.first_glyph;
 
-      while (text_length) {
-        auto utf_result = ParseUtf8Sequence<false>(text, text_length);
-        if (!utf_result.code_position.has_value()) {
-          LOGE(
-              "[Symphony::Text::MeasuredText] Not a valid UTF-8 text, "
-              "paragraph: {}",
-              paragraph_index);
-          return std::nullopt;
-        }
+      // Whitespaces at the break are dropped, glyphs after them start the
+      // next line.
+      size_t not_whitespace_index = line_prev_whitespace_index;
+      while (IsWhitespace(glyphs[not_whitespace_index].glyph.code_position)) {
+        ++not_whitespace_index;
+      }
 
-        text += utf_result.parsed_sequence_length;
-        text_length -= utf_result.parsed_sequence_length;
-
-        auto* cur_measured_glyph_ptr = addGlyph(
-            *cur_measured_line_ptr,
-            style_font_it->second->GetGlyph(utf_result.code_position.value()));
-        cur_measured_glyph_ptr->color = color;
-        cur_measured_glyph_ptr->from_font = style_font_it->second.get();
-
-        if (paragraph.paragraph_parameters.wrapping == Wrapping::kWordWrap) {
-          if (IsWhitespace(cur_measured_glyph_ptr->glyph.code_position)) {
-            if (has_prev_not_whitespace) {
-              has_prev_not_whitespace = false;
-
-              line_prev_whitespace_it = cur_measured_line_ptr->glyphs.end();
-              --line_prev_whitespace_it;
-            }
-          } else {
-            has_prev_not_whitespace = true;
-            if (cur_measured_line_ptr->line_width > container_width) {
-              if (line_prev_whitespace_it !=
-                  cur_measured_line_ptr->glyphs.end()) {
-                // Reduce current line width:
-                cur_measured_line_ptr->line_width =
-                    line_prev_whitespace_it->line_width_before_this_glyph;
-
-                result.measured_lines.push_back(MeasuredTextLine());
-
-                auto* next_measured_line_ptr = &result.measured_lines.back();
-                next_measured_line_ptr->align =
-                    paragraph.paragraph_parameters.align;
-
-                // Find first not whitespace glyph:
-                auto not_whitespace_it = line_prev_whitespace_it;
-                while (not_whitespace_it !=
-                           cur_measured_line_ptr->glyphs.end() &&
-                       IsWhitespace(not_whitespace_it->glyph.code_position)) {
-                  ++not_whitespace_it;
-                }
-
-                if (not_whitespace_it != cur_measured_line_ptr->glyphs.end()) {
-                  for (auto it = not_whitespace_it;
-                       it != cur_measured_line_ptr->glyphs.end(); ++it) {
-                    auto* next_line_measured_glyph_ptr =
-                        addGlyph(*next_measured_line_ptr, it->glyph);
-                    next_line_measured_glyph_ptr->color = it->color;
-                    next_line_measured_glyph_ptr->from_font = it->from_font;
-                  }
-                }
-
-                cur_measured_line_ptr->glyphs.erase(
-                    line_prev_whitespace_it,
-                    cur_measured_line_ptr->glyphs.end());
-
-                // New line:
-                cur_measured_line_ptr = next_measured_line_ptr;
-
-                has_prev_not_whitespace = false;
-                line_prev_whitespace_it = next_measured_line_ptr->glyphs.end();
-              }
-            }
-          }
-        }
+      measured_lines.push_back(MeasuredTextLine());
+      measured_lines.back().align = paragraph.paragraph_parameters.align;
+      measured_lines.back().first_glyph = not_whitespace_index;
+
+      has_prev_not_whitespace = false;
+      line_prev_whitespace_index = kNoWhitespace;
+    }
+  }
+  measured_lines.back().num_glyphs =
+      end_glyph - measured_lines.back().first_glyph;
+
+  // Places glyphs on their lines, moving them over the dropped whitespaces.
+  size_t num_placed_glyphs = first_glyph;
+  for (size_t line_index = first_line_index;
+       line_index < measured_lines.size(); ++line_index) {
+    auto& measured_line = measured_lines[line_index];
+    size_t line_first_glyph = measured_line.first_glyph;
+    size_t line_end_glyph = line_first_glyph + measured_line.num_glyphs;
+
+    measured_line.first_glyph = num_placed_glyphs;
+    measured_line.num_glyphs = 0;
+    for (size_t i = line_first_glyph; i < line_end_glyph; ++i) {
+      if (i != num_placed_glyphs) {
+        glyphs[num_placed_glyphs] = glyphs[i];
       }
+      placeGlyph(measured_line, glyphs[num_placed_glyphs]);
+      ++num_placed_glyphs;
     }
-
-    ++paragraph_index;
   }
-
-  for (auto& measured_line : result.measured_lines) {
+  glyphs.erase(glyphs.begin() + num_placed_glyphs, glyphs.end());
+  for (size_t line_index = first_line_index;
+       line_index < measured_lines.size(); ++line_index) {
+    auto& measured_line = measured_lines[line_index];
     if (measured_line.align == HorizontalAlignment::kLeft) {
       measured_line.align_offset = 0;
     } else if (measured_line.align == HorizontalAlignment::kCenter) {
@@ -208,7 +380,10 @@ std::optional<MeasuredText> MeasureText(
       measured_line.align_offset = container_width - measured_line.line_width;
     }
 
-    for (auto& measured_glyph : measured_line.glyphs) {
+    size_t first_glyph = measured_line.first_glyph;
+    size_t end_glyph = first_glyph + measured_line.num_glyphs;
+    for (size_t i = first_glyph; i < end_glyph; ++i) {
+      auto& measured_glyph = glyphs[i];
       auto font_measurements = measured_glyph.from_font->GetFontMeasurements();
       measured_line.line_height =
           std::max(measured_line.line_height, font_measurements.line_height);
@@ -216,8 +391,12 @@ std::optional<MeasuredText> MeasureText(
       measured_glyph.base = font_measurements.base;
     }
 
+    // Counts glyphs of every font, lines have few fonts.
+    std::vector<FontGlyphRange>& font_ranges = measured_text.font_ranges;
+    measured_line.first_font_range = font_ranges.size();
     int base = measured_line.base;
-    for (auto& measured_glyph : measured_line.glyphs) {
+    for (size_t i = first_glyph; i < end_glyph; ++i) {
+      auto& measured_glyph = glyphs[i];
       measured_glyph.x = measured_glyph.line_x_advance_before_this_glyph +
                          measured_glyph.glyph.x_offset;
 
@@ -225,12 +404,119 @@ std::optional<MeasuredText> MeasureText(
           measured_glyph.base - measured_glyph.glyph.y_offset;
       measured_glyph.y = base - above_base_height;
 
-      measured_line.font_to_glyph[measured_glyph.from_font].push_back(
-          &measured_glyph);
+      auto range_it = std::find_if(
+          font_ranges.begin() + measured_line.first_font_range,
+          font_ranges.end(), [&measured_glyph](const FontGlyphRange& range) {
+            return range.font == measured_glyph.from_font;
+          });
+      if (range_it == font_ranges.end()) {
+        font_ranges.push_back(FontGlyphRange{
+            .font = measured_glyph.from_font, .first = 0, .count = 0});
+        range_it = font_ranges.end() - 1;
+      }
+      ++range_it->count;
+    }
+    measured_line.num_font_ranges =
+        font_ranges.size() - measured_line.first_font_range;
+
+    // Then places glyph indices font after font, in the order of the line.
+    std::vector<uint32_t>& font_glyphs = measured_text.font_glyphs;
+    size_t first_font_glyph = font_glyphs.size();
+    font_glyphs.resize(first_font_glyph + measured_line.num_glyphs);
+    for (size_t r = measured_line.first_font_range; r < font_ranges.size();
+         ++r) {
+      font_ranges[r].first = first_font_glyph;
+      first_font_glyph += font_ranges[r].count;
+      font_ranges[r].count = 0;
+    }
+    for (size_t i = first_glyph; i < end_glyph; ++i) {
+      for (size_t r = measured_line.first_font_range; r < font_ranges.size();
+           ++r) {
+        FontGlyphRange& range = font_ranges[r];
+        if (range.font == glyphs[i].from_font) {
+          font_glyphs[range.first + range.count++] = (uint32_t)i;
+          break;
+        }
+      }
     }
   }
 
-  return result;
+  measured_text.paragraph_num_lines.push_back(measured_lines.size() -
+                                              first_line_index);
+  return true;
+}
+
+void ReplaceMeasuredParagraph(MeasuredText& measured_text,
+                              size_t paragraph_index,
+                              const MeasuredText& measured_paragraph) {
+  std::vector<MeasuredTextLine>& measured_lines = measured_text.measured_lines;
+
+  size_t first_line = 0;
+  for (size_t i = 0; i < paragraph_index; ++i) {
+    first_line += measured_text.paragraph_num_lines[i];
+  }
+  size_t num_old_lines = measured_text.paragraph_num_lines[paragraph_index];
+
+  // Ranges of the old lines, lines of a paragraph are next to each other.
+  const MeasuredTextLine& first_old_line = measured_lines[first_line];
+  const MeasuredTextLine& last_old_line =
+      measured_lines[first_line + num_old_lines - 1];
+  size_t first_glyph = first_old_line.first_glyph;
+  size_t num_old_glyphs =
+      last_old_line.first_glyph + last_old_line.num_glyphs - first_glyph;
+  size_t first_font_range = first_old_line.first_font_range;
+  size_t num_old_font_ranges = last_old_line.first_font_range +
+                               last_old_line.num_font_ranges -
+                               first_font_range;
+  // Font glyphs of a line take as many places as its glyphs, in the order of
+  // font ranges.
+  size_t first_font_glyph =
+      first_font_range < measured_text.font_ranges.size()
+          ? measured_text.font_ranges[first_font_range].first
+          : measured_text.font_glyphs.size();
+
+  ptrdiff_t glyphs_delta =
+      (ptrdiff_t)measured_paragraph.glyphs.size() - (ptrdiff_t)num_old_glyphs;
+  ptrdiff_t font_ranges_delta =
+      (ptrdiff_t)measured_paragraph.font_ranges.size() -
+      (ptrdiff_t)num_old_font_ranges;
+  ptrdiff_t lines_delta = (ptrdiff_t)measured_paragraph.measured_lines.size() -
+                          (ptrdiff_t)num_old_lines;
+
+  replaceItems(measured_lines, first_line, num_old_lines,
+               measured_paragraph.measured_lines);
+  replaceItems(measured_text.glyphs, first_glyph, num_old_glyphs,
+               measured_paragraph.glyphs);
+  replaceItems(measured_text.font_glyphs, first_font_glyph, num_old_glyphs,
+               measured_paragraph.font_glyphs);
+  replaceItems(measured_text.font_ranges, first_font_range,
+               num_old_font_ranges, measured_paragraph.font_ranges);
+  measured_text.paragraph_num_lines[paragraph_index] =
+      measured_paragraph.measured_lines.size();
+
+  // New items are relative to the start of measured_paragraph.
+  size_t num_new_lines = measured_paragraph.measured_lines.size();
+  size_t num_new_glyphs = measured_paragraph.glyphs.size();
+  size_t num_new_font_ranges = measured_paragraph.font_ranges.size();
+  for (size_t i = first_line; i < first_line + num_new_lines; ++i) {
+    measured_lines[i].first_glyph += first_glyph;
+    measured_lines[i].first_font_range += first_font_range;
+  }
+  for (size_t i = first_font_glyph; i < first_font_glyph + num_new_glyphs;
+       ++i) {
+    measured_text.font_glyphs[i] += (uint32_t)first_glyph;
+  }
+  for (size_t i = first_font_range; i < first_font_range + num_new_font_ranges;
+       ++i) {
+    measured_text.font_ranges[i].first += first_font_glyph;
+  }
+
+  if (glyphs_delta || font_ranges_delta || lines_delta) {
+    moveMeasuredRanges(measured_text, first_line + num_new_lines,
+                       first_font_glyph + num_new_glyphs,
+                       first_font_range + num_new_font_ranges, glyphs_delta,
+                       font_ranges_delta);
+  }
 }
 }  // namespace Text
 }  // namespace Symphony
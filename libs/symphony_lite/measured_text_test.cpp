@@ -3,6 +3,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <random>
+
 using namespace Symphony::Text;
 using namespace testing;
 
@@ -41,12 +43,173 @@ class MonoFont : public Font {
   int width_{0};
 };
 
-std::string ToStringWhenAscii(const std::list<MeasuredGlyph*>& glyphs) {
+// Same glyphs, with ASCII ones also in a table.
+class AsciiTableFont : public MonoFont {
+ public:
+  AsciiTableFont(int line_height, int base, int width)
+      : MonoFont(line_height, base, width) {
+    for (uint32_t code_position = 0; code_position < 128; ++code_position) {
+      ascii_glyphs_[code_position] = GetGlyph(code_position);
+    }
+  }
+
+  const Glyph* GetAsciiGlyphs() const override { return ascii_glyphs_; }
+
+ private:
+  Glyph ascii_glyphs_[128];
+};
+
+// Glyphs of different widths, offsets and advances, as a proportional font
+// has.
+class VaryingFont : public Font {
+ public:
+  VaryingFont(int line_height, int base, int width, int x_offset)
+      : line_height_(line_height),
+        base_(base),
+        width_(width),
+        x_offset_(x_offset) {}
+
+  FontMeasurements GetFontMeasurements() const override {
+    FontMeasurements result;
+    result.line_height = line_height_;
+    result.base = base_;
+    return result;
+  }
+
+  Glyph GetGlyph(uint32_t code_position) const override {
+    Glyph result;
+    result.texture_x = 0;
+    result.texture_y = 0;
+    result.texture_width = width_ + (int)(code_position % 3);
+    result.texture_height = line_height_;
+    result.x_offset = x_offset_ - (int)(code_position % 2);
+    result.y_offset = (int)(code_position % 4);
+    result.x_advance = width_ + (int)(code_position % 5) - 2;
+    result.code_position = code_position;
+    return result;
+  }
+
+  void* GetTexture() override { return nullptr; }
+
+ private:
+  int line_height_{0};
+  int base_{0};
+  int width_{0};
+  int x_offset_{0};
+};
+
+// Word wrap as it was before lines were broken by glyph index: glyphs are
+// placed on the line as they are decoded. When a word overflows the line,
+// the whitespaces before it are erased and the glyphs after them are placed
+// again on a new line.
+void ReferenceBreakLines(
+    int container_width, const Paragraph& paragraph,
+    const std::map<std::string, std::shared_ptr<Font>>& fonts,
+    std::vector<MeasuredTextLine>& measured_lines,
+    std::vector<MeasuredGlyph>& glyphs) {
+  measured_lines.assign(1, MeasuredTextLine());
+  glyphs.clear();
+
+  bool has_prev_not_whitespace = false;
+  constexpr size_t kNoWhitespace = (size_t)-1;
+  size_t line_prev_whitespace_index = kNoWhitespace;
+  for (const auto& style_run : paragraph.style_runs) {
+    Font* font = fonts.at(style_run.style.font).get();
+    const char* text = style_run.text.data();
+    size_t text_length = style_run.text.size();
+    while (text_length) {
+      auto utf_result = ParseUtf8Sequence<false>(text, text_length);
+      text += utf_result.parsed_sequence_length;
+      text_length -= utf_result.parsed_sequence_length;
+
+      glyphs.push_back(MeasuredGlyph());
+      MeasuredGlyph& measured_glyph = glyphs.back();
+      measured_glyph.glyph = font->GetGlyph(utf_result.code_position.value());
+      measured_glyph.color = style_run.style.color;
+      measured_glyph.from_font = font;
+      MeasuredTextLine& measured_line = measured_lines.back();
+      placeGlyph(measured_line, measured_glyph);
+
+      if (paragraph.paragraph_parameters.wrapping != Wrapping::kWordWrap) {
+        continue;
+      }
+      if (IsWhitespace(measured_glyph.glyph.code_position)) {
+        if (has_prev_not_whitespace) {
+          has_prev_not_whitespace = false;
+          line_prev_whitespace_index = glyphs.size() - 1;
+        }
+        continue;
+      }
+      has_prev_not_whitespace = true;
+      if (measured_line.line_width <= container_width ||
+          line_prev_whitespace_index == kNoWhitespace) {
+        continue;
+      }
+
+      measured_line.line_width =
+          glyphs[line_prev_whitespace_index].line_width_before_this_glyph;
+      measured_line.num_glyphs =
+          line_prev_whitespace_index - measured_line.first_glyph;
+      size_t not_whitespace_index = line_prev_whitespace_index;
+      while (IsWhitespace(glyphs[not_whitespace_index].glyph.code_position)) {
+        ++not_whitespace_index;
+      }
+      glyphs.erase(glyphs.begin() + line_prev_whitespace_index,
+                   glyphs.begin() + not_whitespace_index);
+
+      measured_lines.push_back(MeasuredTextLine());
+      MeasuredTextLine& next_measured_line = measured_lines.back();
+      next_measured_line.first_glyph = line_prev_whitespace_index;
+      for (size_t i = line_prev_whitespace_index; i < glyphs.size(); ++i) {
+        placeGlyph(next_measured_line, glyphs[i]);
+      }
+
+      has_prev_not_whitespace = false;
+      line_prev_whitespace_index = kNoWhitespace;
+    }
+  }
+}
+
+// Paragraphs of words of different lengths, with runs of whitespaces and
+// changes of font.
+std::string MakeRandomText(std::mt19937& generator) {
+  static const char* kWords[] = {
+      "a", "bb", "ccc", "dddddd", "eeeeeeeeeeeeeeeeeeee",
+      "\xD0\x96\xD0\xB8\xD0\xB2"};
   std::string result;
-  result.reserve(glyphs.size());
+  size_t num_paragraphs = 1 + generator() % 3;
+  for (size_t p = 0; p < num_paragraphs; ++p) {
+    if (p) {
+      result += "\n";
+    }
+    size_t num_words = generator() % 30;
+    for (size_t w = 0; w < num_words; ++w) {
+      if (generator() % 7 == 0) {
+        result += generator() % 2 ? "<style font=\"wide\">"
+                                  : "<style font=\"narrow\">";
+      }
+      result.append(generator() % 4, ' ');
+      result += kWords[generator() % std::size(kWords)];
+    }
+    result.append(generator() % 3, ' ');
+  }
+  return result;
+}
 
-  for (const auto* glyph : glyphs) {
-    result.push_back(static_cast<char>(glyph->glyph.code_position));
+std::string ToStringWhenAscii(const MeasuredText& measured_text,
+                              const MeasuredTextLine& measured_line,
+                              Font* font) {
+  std::string result;
+
+  for (const auto& font_range : measured_text.GetFontRanges(measured_line)) {
+    if (font_range.font != font) {
+      continue;
+    }
+    for (size_t i = 0; i < font_range.count; ++i) {
+      uint32_t glyph_index = measured_text.font_glyphs[font_range.first + i];
+      result.push_back(static_cast<char>(
+          measured_text.glyphs[glyph_index].glyph.code_position));
+    }
   }
 
   return result;
@@ -70,15 +233,13 @@ TEST(MeasuredText, NoWrappingProducesSingleLine) {
   ASSERT_TRUE(result.has_value());
 
   EXPECT_THAT(result->measured_lines,
-              ElementsAreArray({Field(&MeasuredTextLine::glyphs, SizeIs(44))}));
-
-  const auto& mono_24_glyphs =
-      result->measured_lines.front().font_to_glyph[mono_24.get()];
-  ASSERT_EQ(ToStringWhenAscii(mono_24_glyphs), "One two three four five ");
+              ElementsAreArray({Field(&MeasuredTextLine::num_glyphs, 44)}));
 
-  const auto& mono_32_glyphs =
-      result->measured_lines.front().font_to_glyph[mono_32.get()];
-  ASSERT_EQ(ToStringWhenAscii(mono_32_glyphs), "six seven eight nine");
+  const auto& measured_line = result->measured_lines.front();
+  ASSERT_EQ(ToStringWhenAscii(*result, measured_line, mono_24.get()),
+            "One two three four five ");
+  ASSERT_EQ(ToStringWhenAscii(*result, measured_line, mono_32.get()),
+            "six seven eight nine");
 }
 
 TEST(MeasuredText, SingleParagraphManyLines) {
@@ -100,10 +261,253 @@ TEST(MeasuredText, SingleParagraphManyLines) {
   ASSERT_TRUE(result.has_value());
   EXPECT_THAT(result->measured_lines,
               ElementsAreArray({
-                  Field(&MeasuredTextLine::glyphs, SizeIs(7)),
-                  Field(&MeasuredTextLine::glyphs, SizeIs(10)),
-                  Field(&MeasuredTextLine::glyphs, SizeIs(8)),
-                  Field(&MeasuredTextLine::glyphs, SizeIs(5)),
-                  Field(&MeasuredTextLine::glyphs, SizeIs(10)),
+                  Field(&MeasuredTextLine::num_glyphs, 7),
+                  Field(&MeasuredTextLine::num_glyphs, 10),
+                  Field(&MeasuredTextLine::num_glyphs, 8),
+                  Field(&MeasuredTextLine::num_glyphs, 5),
+                  Field(&MeasuredTextLine::num_glyphs, 10),
               }));
 }
+
+TEST(MeasuredText, WrappingDropsWhitespacesAtBreak) {
+  auto formatted_text = FormatText(
+      "One     two three averyveryverylongword end",
+      Style("mono_24", 0xFFFF0000),
+      ParagraphParameters(HorizontalAlignment::kLeft, Wrapping::kWordWrap), {});
+
+  std::shared_ptr<Font> mono_24 = std::make_shared<MonoFont>(
+      /*new_line_height*/ 46, /*new_base*/ 40, /*width*/ 24);
+  MeasuredText result;
+  ASSERT_TRUE(MeasureText(/*container_width*/ 240, formatted_text.value(),
+                          {{"mono_24", mono_24}}, result));
+
+  // Words longer than the container stay on their own line.
+  ASSERT_EQ(result.measured_lines.size(), 4);
+  EXPECT_EQ(ToStringWhenAscii(result, result.measured_lines[0], mono_24.get()),
+            "One");
+  EXPECT_EQ(ToStringWhenAscii(result, result.measured_lines[1], mono_24.get()),
+            "two three");
+  EXPECT_EQ(ToStringWhenAscii(result, result.measured_lines[2], mono_24.get()),
+            "averyveryverylongword");
+  EXPECT_EQ(ToStringWhenAscii(result, result.measured_lines[3], mono_24.get()),
+            "end");
+  EXPECT_EQ(result.measured_lines[0].line_width, 3 * 24);
+  EXPECT_EQ(result.measured_lines[2].line_width, 21 * 24);
+  EXPECT_EQ(result.glyphs.size(), 36);
+}
+
+TEST(MeasuredText, CountsLinesOfParagraphs) {
+  auto formatted_text = FormatText(
+      "One two three four five six seven eight nine\nTen\n\nEleven",
+      Style("mono_24", 0xFFFF0000),
+      ParagraphParameters(HorizontalAlignment::kLeft, Wrapping::kWordWrap), {});
+
+  std::shared_ptr<Font> mono_24 = std::make_shared<MonoFont>(
+      /*new_line_height*/ 46, /*new_base*/ 40, /*width*/ 24);
+  std::map<std::string, std::shared_ptr<Font>> fonts{{"mono_24", mono_24}};
+  auto result = MeasureText(/*container_width*/ 240, formatted_text.value(),
+                            /*variables*/ {}, fonts);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_THAT(result->paragraph_num_lines, ElementsAre(5, 1, 1, 1));
+
+  // Paragraph measured alone gets the same lines.
+  MeasuredText paragraph;
+  ASSERT_TRUE(MeasureParagraph(/*container_width*/ 240,
+                               formatted_text->paragraphs[0],
+                               /*paragraph_index*/ 0, fonts, paragraph));
+  ASSERT_EQ(paragraph.measured_lines.size(), 5);
+  for (size_t i = 0; i < paragraph.measured_lines.size(); ++i) {
+    EXPECT_EQ(paragraph.measured_lines[i].num_glyphs,
+              result->measured_lines[i].num_glyphs);
+    EXPECT_EQ(paragraph.measured_lines[i].line_width,
+              result->measured_lines[i].line_width);
+  }
+}
+
+TEST(MeasuredText, ReplacesParagraph) {
+  std::shared_ptr<Font> mono_24 = std::make_shared<MonoFont>(
+      /*new_line_height*/ 46, /*new_base*/ 40, /*width*/ 24);
+  std::map<std::string, std::shared_ptr<Font>> fonts{{"mono_24", mono_24}};
+  auto format = [](const std::string& first_paragraph) {
+    return FormatText(first_paragraph + "\nTen eleven twelve\nThirteen",
+                      Style("mono_24", 0xFFFF0000),
+                      ParagraphParameters(HorizontalAlignment::kLeft,
+                                          Wrapping::kWordWrap),
+                      {});
+  };
+  auto long_text = format("One two three four five six seven eight nine");
+  auto short_text = format("One");
+
+  MeasuredText result;
+  ASSERT_TRUE(MeasureText(/*container_width*/ 240, long_text.value(), fonts,
+                          result));
+
+  // Lines and glyphs after the paragraph move back.
+  MeasuredText paragraph;
+  ASSERT_TRUE(MeasureParagraph(/*container_width*/ 240,
+                               short_text->paragraphs[0],
+                               /*paragraph_index*/ 0, fonts, paragraph));
+  ReplaceMeasuredParagraph(result, /*paragraph_index*/ 0, paragraph);
+
+  MeasuredText expected;
+  ASSERT_TRUE(MeasureText(/*container_width*/ 240, short_text.value(), fonts,
+                          expected));
+  EXPECT_THAT(result.paragraph_num_lines, ElementsAre(1, 2, 1));
+  ASSERT_EQ(result.measured_lines.size(), expected.measured_lines.size());
+  for (size_t i = 0; i < expected.measured_lines.size(); ++i) {
+    const auto& measured_line = result.measured_lines[i];
+    const auto& expected_line = expected.measured_lines[i];
+    EXPECT_EQ(measured_line.first_glyph, expected_line.first_glyph);
+    EXPECT_EQ(measured_line.num_glyphs, expected_line.num_glyphs);
+    EXPECT_EQ(ToStringWhenAscii(result, measured_line, mono_24.get()),
+              ToStringWhenAscii(expected, expected_line, mono_24.get()));
+  }
+}
+
+TEST(MeasuredText, MeasuringAgainKeepsStorage) {
+  auto formatted_text = FormatText(
+      "One two three four five six seven eight nine\nTen",
+      Style("mono_24", 0xFFFF0000),
+      ParagraphParameters(HorizontalAlignment::kLeft, Wrapping::kWordWrap), {});
+
+  std::shared_ptr<Font> mono_24 = std::make_shared<MonoFont>(
+      /*new_line_height*/ 46, /*new_base*/ 40, /*width*/ 24);
+  std::map<std::string, std::shared_ptr<Font>> fonts{{"mono_24", mono_24}};
+
+  MeasuredText result;
+  ASSERT_TRUE(MeasureText(/*container_width*/ 240, formatted_text.value(),
+                          fonts, result));
+  const MeasuredGlyph* glyphs = result.glyphs.data();
+  const MeasuredTextLine* measured_lines = result.measured_lines.data();
+
+  ASSERT_TRUE(MeasureText(/*container_width*/ 240, formatted_text.value(),
+                          fonts, result));
+  EXPECT_EQ(result.glyphs.data(), glyphs);
+  EXPECT_EQ(result.measured_lines.data(), measured_lines);
+  EXPECT_THAT(result.paragraph_num_lines, ElementsAre(5, 1));
+}
+
+TEST(MeasuredText, AsciiTableGivesSameGlyphs) {
+  auto formatted_text = FormatText(
+      "One \xD0\x94\xD0\xB2\xD0\xB0 three four \xD0\xBF\xD1\x8F\xD1\x82"
+      "\xD1\x8C",
+      Style("mono_24", 0xFFFF0000),
+      ParagraphParameters(HorizontalAlignment::kLeft, Wrapping::kWordWrap), {});
+
+  std::shared_ptr<Font> mono_24 = std::make_shared<MonoFont>(
+      /*new_line_height*/ 46, /*new_base*/ 40, /*width*/ 24);
+  std::shared_ptr<Font> table_24 = std::make_shared<AsciiTableFont>(
+      /*new_line_height*/ 46, /*new_base*/ 40, /*width*/ 24);
+
+  MeasuredText expected;
+  ASSERT_TRUE(MeasureText(/*container_width*/ 240, formatted_text.value(),
+                          {{"mono_24", mono_24}}, expected));
+  MeasuredText result;
+  ASSERT_TRUE(MeasureText(/*container_width*/ 240, formatted_text.value(),
+                          {{"mono_24", table_24}}, result));
+
+  EXPECT_EQ(result.measured_lines.size(), 3);
+  ASSERT_EQ(result.measured_lines.size(), expected.measured_lines.size());
+  ASSERT_EQ(result.glyphs.size(), expected.glyphs.size());
+  for (size_t i = 0; i < expected.glyphs.size(); ++i) {
+    const auto& glyph = result.glyphs[i];
+    const auto& expected_glyph = expected.glyphs[i];
+    EXPECT_EQ(glyph.glyph.code_position, expected_glyph.glyph.code_position);
+    EXPECT_EQ(glyph.x, expected_glyph.x);
+    EXPECT_EQ(glyph.y, expected_glyph.y);
+    EXPECT_EQ(glyph.from_font, table_24.get());
+  }
+}
+
+TEST(MeasuredText, BreaksLinesAsPlacingGlyphsOneByOne) {
+  std::shared_ptr<Font> narrow = std::make_shared<VaryingFont>(
+      /*line_height*/ 20, /*base*/ 16, /*width*/ 10, /*x_offset*/ 1);
+  std::shared_ptr<Font> wide = std::make_shared<VaryingFont>(
+      /*line_height*/ 30, /*base*/ 24, /*width*/ 14, /*x_offset*/ -2);
+  std::map<std::string, std::shared_ptr<Font>> fonts{{"narrow", narrow},
+                                                     {"wide", wide}};
+
+  std::mt19937 generator(5);
+  for (int iteration = 0; iteration < 2000; ++iteration) {
+    std::string text = MakeRandomText(generator);
+    auto formatted_text = FormatText(
+        text, Style("narrow", 0xFF00FF00),
+        ParagraphParameters(generator() % 2 ? HorizontalAlignment::kCenter
+                                            : HorizontalAlignment::kLeft,
+                            generator() % 5 ? Wrapping::kWordWrap
+                                            : Wrapping::kClip),
+        {});
+    ASSERT_TRUE(formatted_text.has_value()) << text;
+    int container_width = (int)(generator() % 400);
+    SCOPED_TRACE(testing::Message() << "text: '" << text
+                                    << "', container_width: "
+                                    << container_width);
+
+    for (size_t p = 0; p < formatted_text->paragraphs.size(); ++p) {
+      const Paragraph& paragraph = formatted_text->paragraphs[p];
+      MeasuredText result;
+      ASSERT_TRUE(
+          MeasureParagraph(container_width, paragraph, p, fonts, result));
+      std::vector<MeasuredTextLine> expected_lines;
+      std::vector<MeasuredGlyph> expected_glyphs;
+      ReferenceBreakLines(container_width, paragraph, fonts, expected_lines,
+                          expected_glyphs);
+
+      ASSERT_EQ(result.measured_lines.size(), expected_lines.size());
+      ASSERT_EQ(result.glyphs.size(), expected_glyphs.size());
+      for (size_t l = 0; l < expected_lines.size(); ++l) {
+        const MeasuredTextLine& line = result.measured_lines[l];
+        const MeasuredTextLine& expected_line = expected_lines[l];
+        ASSERT_EQ(line.first_glyph, expected_line.first_glyph) << l;
+        ASSERT_EQ(line.num_glyphs, expected_line.num_glyphs) << l;
+        ASSERT_EQ(line.line_width, expected_line.line_width) << l;
+
+        // Fonts of the line in the order they appear, each with its glyphs.
+        std::vector<std::pair<Font*, std::vector<uint32_t>>> expected_ranges;
+        for (size_t i = expected_line.first_glyph;
+             i < expected_line.first_glyph + expected_line.num_glyphs; ++i) {
+          const MeasuredGlyph& glyph = result.glyphs[i];
+          const MeasuredGlyph& expected_glyph = expected_glyphs[i];
+          ASSERT_EQ(glyph.glyph.code_position,
+                    expected_glyph.glyph.code_position)
+              << i;
+          ASSERT_EQ(glyph.from_font, expected_glyph.from_font) << i;
+          ASSERT_EQ(glyph.color, expected_glyph.color) << i;
+          ASSERT_EQ(glyph.line_x_advance_before_this_glyph,
+                    expected_glyph.line_x_advance_before_this_glyph)
+              << i;
+          ASSERT_EQ(glyph.line_width_before_this_glyph,
+                    expected_glyph.line_width_before_this_glyph)
+              << i;
+          ASSERT_EQ(glyph.x, expected_glyph.line_x_advance_before_this_glyph +
+                                 expected_glyph.glyph.x_offset)
+              << i;
+
+          auto range_it = std::find_if(
+              expected_ranges.begin(), expected_ranges.end(),
+              [&](const auto& range) {
+                return range.first == expected_glyph.from_font;
+              });
+          if (range_it == expected_ranges.end()) {
+            expected_ranges.emplace_back(expected_glyph.from_font,
+                                         std::vector<uint32_t>());
+            range_it = expected_ranges.end() - 1;
+          }
+          range_it->second.push_back((uint32_t)i);
+        }
+
+        auto font_ranges = result.GetFontRanges(line);
+        ASSERT_EQ(font_ranges.size(), expected_ranges.size()) << l;
+        for (size_t r = 0; r < expected_ranges.size(); ++r) {
+          ASSERT_EQ(font_ranges[r].font, expected_ranges[r].first);
+          ASSERT_THAT(std::vector<uint32_t>(
+                          result.font_glyphs.begin() + font_ranges[r].first,
+                          result.font_glyphs.begin() + font_ranges[r].first +
+                              font_ranges[r].count),
+                      ElementsAreArray(expected_ranges[r].second));
+        }
+      }
+    }
+  }
+}
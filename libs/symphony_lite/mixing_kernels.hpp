@@ -0,0 +1,894 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#define SYMPHONY_AUDIO_MIXING_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define SYMPHONY_AUDIO_MIXING_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define SYMPHONY_AUDIO_MIXING_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Symphony {
+namespace Audio {
+#pragma pack(push, 1)
+struct StereoBlock16 {
+  int16_t left;
+  int16_t right;
+};
+
+struct StereoBlock32 {
+  int32_t left;
+  int32_t right;
+};
+#pragma pack(pop)
+
+inline constexpr int32_t kSampleMax16 = 32767;
+inline constexpr int32_t kSampleMin16 = -32768;
+
+// Gain is fixed point with 7 fractional bits: 128 is 1.0, should fit into
+// int16.
+int32_t ApplyGain(int32_t sample, int32_t gain) { return (sample * gain) >> 7; }
+
+// Left and right gains which change linearly over a buffer, so that changes of
+// volume and pan don't step from one buffer to the next. Gain of block i is
+// (start + step * i) >> kGainRampFractionBits: the extra fractional bits let
+// slow ramps move every block. Gains should be in [0, kMaxRampGain].
+struct StereoGainRamp {
+  int32_t left_start;
+  int32_t left_step;
+  int32_t right_start;
+  int32_t right_step;
+};
+
+inline constexpr int kGainRampFractionBits = 16;
+inline constexpr int32_t kMaxRampGain = 32767;
+
+// Ramp which starts at the from gains and comes to the to gains after
+// num_blocks blocks.
+StereoGainRamp GetStereoGainRamp(int32_t left_from, int32_t right_from,
+                                 int32_t left_to, int32_t right_to,
+                                 size_t num_blocks);
+// The same ramp, starting num_blocks later.
+StereoGainRamp AdvanceStereoGainRamp(const StereoGainRamp& ramp,
+                                     size_t num_blocks);
+
+// Mixing kernels are selected at compile time: AVX2 or SSE2 on x86, NEON on
+// ARM. PSP and Emscripten builds use the scalar kernels. Vectorized kernels
+// produce exactly the same output as the scalar ones, the tail of a buffer
+// that doesn't fill a whole register is processed by the scalar kernels.
+const char* GetMixingKernelsName();
+
+void AccumulateStereoSamples(StereoBlock32* accumulate_buffer,
+                             const StereoBlock16* stream, size_t num_blocks);
+void AccumulateStereoSamplesWithGain(StereoBlock32* accumulate_buffer,
+                                     int32_t gain, const StereoBlock16* stream,
+                                     size_t num_blocks);
+void AccumulateMonoSamples(StereoBlock32* accumulate_buffer,
+                           const int16_t* stream, size_t num_blocks);
+void AccumulateMonoSamplesWithGain(StereoBlock32* accumulate_buffer,
+                                   int32_t gain, const int16_t* stream,
+                                   size_t num_blocks);
+// Gains follow the ramp, both channels of mono samples are taken from the same
+// sample: panning costs no extra pass over the samples.
+void AccumulateStereoSamplesWithRamp(StereoBlock32* accumulate_buffer,
+                                     const StereoGainRamp& ramp,
+                                     const StereoBlock16* stream,
+                                     size_t num_blocks);
+void AccumulateMonoSamplesWithRamp(StereoBlock32* accumulate_buffer,
+                                   const StereoGainRamp& ramp,
+                                   const int16_t* stream, size_t num_blocks);
+// Adds already mixed samples, e.g. of a bus, products with gain should fit
+// into int32.
+void AccumulateMixedSamples(StereoBlock32* accumulate_buffer,
+                            const StereoBlock32* mixed, size_t num_blocks);
+void AccumulateMixedSamplesWithGain(StereoBlock32* accumulate_buffer,
+                                    int32_t gain, const StereoBlock32* mixed,
+                                    size_t num_blocks);
+void AccumulateMixedSamplesWithRamp(StereoBlock32* accumulate_buffer,
+                                    const StereoGainRamp& ramp,
+                                    const StereoBlock32* mixed,
+                                    size_t num_blocks);
+// Saturates mixed samples to 16 bits. Returns number of clipped samples.
+size_t PackStereoSamples(StereoBlock16* output, const StereoBlock32* mixed,
+                         size_t num_blocks);
+
+// Reference kernels.
+void AccumulateStereoSamplesScalar(StereoBlock32* accumulate_buffer,
+                                   const StereoBlock16* stream,
+                                   size_t num_blocks);
+void AccumulateStereoSamplesWithGainScalar(StereoBlock32* accumulate_buffer,
+                                           int32_t gain,
+                                           const StereoBlock16* stream,
+                                           size_t num_blocks);
+void AccumulateMonoSamplesScalar(StereoBlock32* accumulate_buffer,
+                                 const int16_t* stream, size_t num_blocks);
+void AccumulateMonoSamplesWithGainScalar(StereoBlock32* accumulate_buffer,
+                                         int32_t gain, const int16_t* stream,
+                                         size_t num_blocks);
+void AccumulateStereoSamplesWithRampScalar(StereoBlock32* accumulate_buffer,
+                                           const StereoGainRamp& ramp,
+                                           const StereoBlock16* stream,
+                                           size_t num_blocks);
+void AccumulateMonoSamplesWithRampScalar(StereoBlock32* accumulate_buffer,
+                                         const StereoGainRamp& ramp,
+                                         const int16_t* stream,
+                                         size_t num_blocks);
+void AccumulateMixedSamplesScalar(StereoBlock32* accumulate_buffer,
+                                  const StereoBlock32* mixed,
+                                  size_t num_blocks);
+void AccumulateMixedSamplesWithGainScalar(StereoBlock32* accumulate_buffer,
+                                          int32_t gain,
+                                          const StereoBlock32* mixed,
+                                          size_t num_blocks);
+void AccumulateMixedSamplesWithRampScalar(StereoBlock32* accumulate_buffer,
+                                          const StereoGainRamp& ramp,
+                                          const StereoBlock32* mixed,
+                                          size_t num_blocks);
+size_t PackStereoSamplesScalar(StereoBlock16* output,
+                               const StereoBlock32* mixed, size_t num_blocks);
+
+const char* GetMixingKernelsName() {
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  return "avx2";
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  return "sse2";
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+void AccumulateStereoSamples(StereoBlock32* accumulate_buffer,
+                             const StereoBlock16* stream, size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m256i samples = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*)(stream + i)));
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(accumulate,
+                        _mm256_add_epi32(_mm256_loadu_si256(accumulate),
+                                         samples));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(stream + i));
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(accumulate,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate), lo));
+    _mm_storeu_si128(accumulate + 1,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 1), hi));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  for (; i + 4 <= num_blocks; i += 4) {
+    int16x8_t samples = vld1q_s16((const int16_t*)(stream + i));
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate, vaddq_s32(vld1q_s32(accumulate),
+                                    vmovl_s16(vget_low_s16(samples))));
+    vst1q_s32(accumulate + 4, vaddq_s32(vld1q_s32(accumulate + 4),
+                                        vmovl_s16(vget_high_s16(samples))));
+  }
+#endif
+  AccumulateStereoSamplesScalar(accumulate_buffer + i, stream + i,
+                                num_blocks - i);
+}
+
+void AccumulateStereoSamplesWithGain(StereoBlock32* accumulate_buffer,
+                                     int32_t gain, const StereoBlock16* stream,
+                                     size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  __m256i gain_32 = _mm256_set1_epi32(gain);
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m256i samples = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*)(stream + i)));
+    samples = _mm256_srai_epi32(_mm256_mullo_epi32(samples, gain_32), 7);
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(accumulate,
+                        _mm256_add_epi32(_mm256_loadu_si256(accumulate),
+                                         samples));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  __m128i gain_16 = _mm_set1_epi16((int16_t)gain);
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(stream + i));
+    // Full 32-bit products from low and high halves:
+    __m128i product_lo = _mm_mullo_epi16(samples, gain_16);
+    __m128i product_hi = _mm_mulhi_epi16(samples, gain_16);
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(product_lo, product_hi), 7);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(product_lo, product_hi), 7);
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(accumulate,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate), lo));
+    _mm_storeu_si128(accumulate + 1,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 1), hi));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  for (; i + 4 <= num_blocks; i += 4) {
+    int16x8_t samples = vld1q_s16((const int16_t*)(stream + i));
+    int32x4_t lo =
+        vshrq_n_s32(vmull_n_s16(vget_low_s16(samples), (int16_t)gain), 7);
+    int32x4_t hi =
+        vshrq_n_s32(vmull_n_s16(vget_high_s16(samples), (int16_t)gain), 7);
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate, vaddq_s32(vld1q_s32(accumulate), lo));
+    vst1q_s32(accumulate + 4, vaddq_s32(vld1q_s32(accumulate + 4), hi));
+  }
+#endif
+  AccumulateStereoSamplesWithGainScalar(accumulate_buffer + i, gain, stream + i,
+                                        num_blocks - i);
+}
+
+void AccumulateMonoSamples(StereoBlock32* accumulate_buffer,
+                           const int16_t* stream, size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  const __m256i first_half = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+  const __m256i second_half = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+  for (; i + 8 <= num_blocks; i += 8) {
+    __m256i samples = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*)(stream + i)));
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(
+        accumulate,
+        _mm256_add_epi32(_mm256_loadu_si256(accumulate),
+                         _mm256_permutevar8x32_epi32(samples, first_half)));
+    _mm256_storeu_si256(
+        accumulate + 1,
+        _mm256_add_epi32(_mm256_loadu_si256(accumulate + 1),
+                         _mm256_permutevar8x32_epi32(samples, second_half)));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  for (; i + 8 <= num_blocks; i += 8) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(stream + i));
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(accumulate, _mm_add_epi32(_mm_loadu_si128(accumulate),
+                                               _mm_unpacklo_epi32(lo, lo)));
+    _mm_storeu_si128(accumulate + 1,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 1),
+                                   _mm_unpackhi_epi32(lo, lo)));
+    _mm_storeu_si128(accumulate + 2,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 2),
+                                   _mm_unpacklo_epi32(hi, hi)));
+    _mm_storeu_si128(accumulate + 3,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 3),
+                                   _mm_unpackhi_epi32(hi, hi)));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  for (; i + 4 <= num_blocks; i += 4) {
+    int32x4_t samples = vmovl_s16(vld1_s16(stream + i));
+    int32x4x2_t duplicated = vzipq_s32(samples, samples);
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate,
+              vaddq_s32(vld1q_s32(accumulate), duplicated.val[0]));
+    vst1q_s32(accumulate + 4,
+              vaddq_s32(vld1q_s32(accumulate + 4), duplicated.val[1]));
+  }
+#endif
+  AccumulateMonoSamplesScalar(accumulate_buffer + i, stream + i,
+                              num_blocks - i);
+}
+
+void AccumulateMonoSamplesWithGain(StereoBlock32* accumulate_buffer,
+                                   int32_t gain, const int16_t* stream,
+                                   size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  const __m256i first_half = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+  const __m256i second_half = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+  __m256i gain_32 = _mm256_set1_epi32(gain);
+  for (; i + 8 <= num_blocks; i += 8) {
+    __m256i samples = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*)(stream + i)));
+    samples = _mm256_srai_epi32(_mm256_mullo_epi32(samples, gain_32), 7);
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(
+        accumulate,
+        _mm256_add_epi32(_mm256_loadu_si256(accumulate),
+                         _mm256_permutevar8x32_epi32(samples, first_half)));
+    _mm256_storeu_si256(
+        accumulate + 1,
+        _mm256_add_epi32(_mm256_loadu_si256(accumulate + 1),
+                         _mm256_permutevar8x32_epi32(samples, second_half)));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  __m128i gain_16 = _mm_set1_epi16((int16_t)gain);
+  for (; i + 8 <= num_blocks; i += 8) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(stream + i));
+    __m128i product_lo = _mm_mullo_epi16(samples, gain_16);
+    __m128i product_hi = _mm_mulhi_epi16(samples, gain_16);
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(product_lo, product_hi), 7);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(product_lo, product_hi), 7);
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(accumulate, _mm_add_epi32(_mm_loadu_si128(accumulate),
+                                               _mm_unpacklo_epi32(lo, lo)));
+    _mm_storeu_si128(accumulate + 1,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 1),
+                                   _mm_unpackhi_epi32(lo, lo)));
+    _mm_storeu_si128(accumulate + 2,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 2),
+                                   _mm_unpacklo_epi32(hi, hi)));
+    _mm_storeu_si128(accumulate + 3,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 3),
+                                   _mm_unpackhi_epi32(hi, hi)));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  for (; i + 4 <= num_blocks; i += 4) {
+    int32x4_t samples =
+        vshrq_n_s32(vmull_n_s16(vld1_s16(stream + i), (int16_t)gain), 7);
+    int32x4x2_t duplicated = vzipq_s32(samples, samples);
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate,
+              vaddq_s32(vld1q_s32(accumulate), duplicated.val[0]));
+    vst1q_s32(accumulate + 4,
+              vaddq_s32(vld1q_s32(accumulate + 4), duplicated.val[1]));
+  }
+#endif
+  AccumulateMonoSamplesWithGainScalar(accumulate_buffer + i, gain, stream + i,
+                                      num_blocks - i);
+}
+
+StereoGainRamp GetStereoGainRamp(int32_t left_from, int32_t right_from,
+                                 int32_t left_to, int32_t right_to,
+                                 size_t num_blocks) {
+  const int32_t one = 1 << kGainRampFractionBits;
+  int32_t num_steps = num_blocks ? (int32_t)num_blocks : 1;
+  return StereoGainRamp{
+      .left_start = left_from * one,
+      .left_step = (left_to - left_from) * one / num_steps,
+      .right_start = right_from * one,
+      .right_step = (right_to - right_from) * one / num_steps};
+}
+
+StereoGainRamp AdvanceStereoGainRamp(const StereoGainRamp& ramp,
+                                     size_t num_blocks) {
+  return StereoGainRamp{
+      .left_start = ramp.left_start + ramp.left_step * (int32_t)num_blocks,
+      .left_step = ramp.left_step,
+      .right_start = ramp.right_start + ramp.right_step * (int32_t)num_blocks,
+      .right_step = ramp.right_step};
+}
+
+// Vectorized ramps keep gains of several blocks in a register and add steps
+// of the whole register every iteration, additions are exact, so gains are
+// the same as the scalar start + step * i.
+void AccumulateStereoSamplesWithRamp(StereoBlock32* accumulate_buffer,
+                                     const StereoGainRamp& ramp,
+                                     const StereoBlock16* stream,
+                                     size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  __m256i steps = _mm256_setr_epi32(ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step);
+  __m256i gains = _mm256_add_epi32(
+      _mm256_setr_epi32(ramp.left_start, ramp.right_start, ramp.left_start,
+                        ramp.right_start, ramp.left_start, ramp.right_start,
+                        ramp.left_start, ramp.right_start),
+      _mm256_mullo_epi32(steps, _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3)));
+  __m256i gains_step = _mm256_slli_epi32(steps, 2);
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m256i samples = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*)(stream + i)));
+    samples = _mm256_srai_epi32(
+        _mm256_mullo_epi32(samples,
+                           _mm256_srai_epi32(gains, kGainRampFractionBits)),
+        7);
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(accumulate,
+                        _mm256_add_epi32(_mm256_loadu_si256(accumulate),
+                                         samples));
+    gains = _mm256_add_epi32(gains, gains_step);
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  __m128i steps = _mm_setr_epi32(ramp.left_step, ramp.right_step,
+                                 ramp.left_step, ramp.right_step);
+  // Gains of blocks i, i + 1 and of blocks i + 2, i + 3:
+  __m128i gains_lo = _mm_add_epi32(
+      _mm_setr_epi32(ramp.left_start, ramp.right_start, ramp.left_start,
+                     ramp.right_start),
+      _mm_unpackhi_epi64(_mm_setzero_si128(), steps));
+  __m128i gains_hi = _mm_add_epi32(gains_lo, _mm_slli_epi32(steps, 1));
+  __m128i gains_step = _mm_slli_epi32(steps, 2);
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(stream + i));
+    __m128i gain_16 =
+        _mm_packs_epi32(_mm_srai_epi32(gains_lo, kGainRampFractionBits),
+                        _mm_srai_epi32(gains_hi, kGainRampFractionBits));
+    __m128i product_lo = _mm_mullo_epi16(samples, gain_16);
+    __m128i product_hi = _mm_mulhi_epi16(samples, gain_16);
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(product_lo, product_hi), 7);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(product_lo, product_hi), 7);
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(accumulate,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate), lo));
+    _mm_storeu_si128(accumulate + 1,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 1), hi));
+    gains_lo = _mm_add_epi32(gains_lo, gains_step);
+    gains_hi = _mm_add_epi32(gains_hi, gains_step);
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  const int32_t step_lanes[4] = {ramp.left_step, ramp.right_step,
+                                 ramp.left_step, ramp.right_step};
+  const int32_t start_lanes[4] = {ramp.left_start, ramp.right_start,
+                                  ramp.left_start, ramp.right_start};
+  const int32_t block_lanes[4] = {0, 0, 1, 1};
+  int32x4_t steps = vld1q_s32(step_lanes);
+  int32x4_t gains_lo =
+      vmlaq_s32(vld1q_s32(start_lanes), steps, vld1q_s32(block_lanes));
+  int32x4_t gains_hi = vaddq_s32(gains_lo, vshlq_n_s32(steps, 1));
+  int32x4_t gains_step = vshlq_n_s32(steps, 2);
+  for (; i + 4 <= num_blocks; i += 4) {
+    int16x8_t samples = vld1q_s16((const int16_t*)(stream + i));
+    int32x4_t lo = vshrq_n_s32(
+        vmulq_s32(vmovl_s16(vget_low_s16(samples)),
+                  vshrq_n_s32(gains_lo, kGainRampFractionBits)),
+        7);
+    int32x4_t hi = vshrq_n_s32(
+        vmulq_s32(vmovl_s16(vget_high_s16(samples)),
+                  vshrq_n_s32(gains_hi, kGainRampFractionBits)),
+        7);
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate, vaddq_s32(vld1q_s32(accumulate), lo));
+    vst1q_s32(accumulate + 4, vaddq_s32(vld1q_s32(accumulate + 4), hi));
+    gains_lo = vaddq_s32(gains_lo, gains_step);
+    gains_hi = vaddq_s32(gains_hi, gains_step);
+  }
+#endif
+  AccumulateStereoSamplesWithRampScalar(accumulate_buffer + i,
+                                        AdvanceStereoGainRamp(ramp, i),
+                                        stream + i, num_blocks - i);
+}
+
+void AccumulateMonoSamplesWithRamp(StereoBlock32* accumulate_buffer,
+                                   const StereoGainRamp& ramp,
+                                   const int16_t* stream, size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  const __m256i first_half = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+  const __m256i second_half = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+  __m256i steps = _mm256_setr_epi32(ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step);
+  // Gains of blocks i..i + 3 and of blocks i + 4..i + 7:
+  __m256i gains_lo = _mm256_add_epi32(
+      _mm256_setr_epi32(ramp.left_start, ramp.right_start, ramp.left_start,
+                        ramp.right_start, ramp.left_start, ramp.right_start,
+                        ramp.left_start, ramp.right_start),
+      _mm256_mullo_epi32(steps, first_half));
+  __m256i gains_hi = _mm256_add_epi32(gains_lo, _mm256_slli_epi32(steps, 2));
+  __m256i gains_step = _mm256_slli_epi32(steps, 3);
+  for (; i + 8 <= num_blocks; i += 8) {
+    __m256i samples = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*)(stream + i)));
+    __m256i lo = _mm256_srai_epi32(
+        _mm256_mullo_epi32(_mm256_permutevar8x32_epi32(samples, first_half),
+                           _mm256_srai_epi32(gains_lo, kGainRampFractionBits)),
+        7);
+    __m256i hi = _mm256_srai_epi32(
+        _mm256_mullo_epi32(_mm256_permutevar8x32_epi32(samples, second_half),
+                           _mm256_srai_epi32(gains_hi, kGainRampFractionBits)),
+        7);
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(
+        accumulate, _mm256_add_epi32(_mm256_loadu_si256(accumulate), lo));
+    _mm256_storeu_si256(accumulate + 1,
+                        _mm256_add_epi32(_mm256_loadu_si256(accumulate + 1),
+                                         hi));
+    gains_lo = _mm256_add_epi32(gains_lo, gains_step);
+    gains_hi = _mm256_add_epi32(gains_hi, gains_step);
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  __m128i steps = _mm_setr_epi32(ramp.left_step, ramp.right_step,
+                                 ramp.left_step, ramp.right_step);
+  __m128i gains_lo = _mm_add_epi32(
+      _mm_setr_epi32(ramp.left_start, ramp.right_start, ramp.left_start,
+                     ramp.right_start),
+      _mm_unpackhi_epi64(_mm_setzero_si128(), steps));
+  __m128i gains_hi = _mm_add_epi32(gains_lo, _mm_slli_epi32(steps, 1));
+  __m128i gains_step = _mm_slli_epi32(steps, 2);
+  for (; i + 4 <= num_blocks; i += 4) {
+    // Both channels of 4 blocks:
+    __m128i samples = _mm_loadl_epi64((const __m128i*)(stream + i));
+    samples = _mm_unpacklo_epi16(samples, samples);
+    __m128i gain_16 =
+        _mm_packs_epi32(_mm_srai_epi32(gains_lo, kGainRampFractionBits),
+                        _mm_srai_epi32(gains_hi, kGainRampFractionBits));
+    __m128i product_lo = _mm_mullo_epi16(samples, gain_16);
+    __m128i product_hi = _mm_mulhi_epi16(samples, gain_16);
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(product_lo, product_hi), 7);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(product_lo, product_hi), 7);
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(accumulate,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate), lo));
+    _mm_storeu_si128(accumulate + 1,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate + 1), hi));
+    gains_lo = _mm_add_epi32(gains_lo, gains_step);
+    gains_hi = _mm_add_epi32(gains_hi, gains_step);
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  const int32_t step_lanes[4] = {ramp.left_step, ramp.right_step,
+                                 ramp.left_step, ramp.right_step};
+  const int32_t start_lanes[4] = {ramp.left_start, ramp.right_start,
+                                  ramp.left_start, ramp.right_start};
+  const int32_t block_lanes[4] = {0, 0, 1, 1};
+  int32x4_t steps = vld1q_s32(step_lanes);
+  int32x4_t gains_lo =
+      vmlaq_s32(vld1q_s32(start_lanes), steps, vld1q_s32(block_lanes));
+  int32x4_t gains_hi = vaddq_s32(gains_lo, vshlq_n_s32(steps, 1));
+  int32x4_t gains_step = vshlq_n_s32(steps, 2);
+  for (; i + 4 <= num_blocks; i += 4) {
+    int16x4_t samples = vld1_s16(stream + i);
+    int16x4x2_t duplicated = vzip_s16(samples, samples);
+    int32x4_t lo = vshrq_n_s32(
+        vmulq_s32(vmovl_s16(duplicated.val[0]),
+                  vshrq_n_s32(gains_lo, kGainRampFractionBits)),
+        7);
+    int32x4_t hi = vshrq_n_s32(
+        vmulq_s32(vmovl_s16(duplicated.val[1]),
+                  vshrq_n_s32(gains_hi, kGainRampFractionBits)),
+        7);
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate, vaddq_s32(vld1q_s32(accumulate), lo));
+    vst1q_s32(accumulate + 4, vaddq_s32(vld1q_s32(accumulate + 4), hi));
+    gains_lo = vaddq_s32(gains_lo, gains_step);
+    gains_hi = vaddq_s32(gains_hi, gains_step);
+  }
+#endif
+  AccumulateMonoSamplesWithRampScalar(accumulate_buffer + i,
+                                      AdvanceStereoGainRamp(ramp, i),
+                                      stream + i, num_blocks - i);
+}
+
+void AccumulateMixedSamples(StereoBlock32* accumulate_buffer,
+                            const StereoBlock32* mixed, size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(
+        accumulate,
+        _mm256_add_epi32(_mm256_loadu_si256(accumulate),
+                         _mm256_loadu_si256((const __m256i*)(mixed + i))));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  for (; i + 2 <= num_blocks; i += 2) {
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(
+        accumulate,
+        _mm_add_epi32(_mm_loadu_si128(accumulate),
+                      _mm_loadu_si128((const __m128i*)(mixed + i))));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  for (; i + 2 <= num_blocks; i += 2) {
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate, vaddq_s32(vld1q_s32(accumulate),
+                                    vld1q_s32((const int32_t*)(mixed + i))));
+  }
+#endif
+  AccumulateMixedSamplesScalar(accumulate_buffer + i, mixed + i,
+                               num_blocks - i);
+}
+
+void AccumulateMixedSamplesWithGain(StereoBlock32* accumulate_buffer,
+                                    int32_t gain, const StereoBlock32* mixed,
+                                    size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  __m256i gain_32 = _mm256_set1_epi32(gain);
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m256i samples = _mm256_loadu_si256((const __m256i*)(mixed + i));
+    samples = _mm256_srai_epi32(_mm256_mullo_epi32(samples, gain_32), 7);
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(accumulate,
+                        _mm256_add_epi32(_mm256_loadu_si256(accumulate),
+                                         samples));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  // No 32-bit multiply in SSE2: low halves of 64-bit products of even and odd
+  // lanes are the same as signed 32-bit products.
+  __m128i gain_32 = _mm_set1_epi32(gain);
+  for (; i + 2 <= num_blocks; i += 2) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(mixed + i));
+    __m128i even = _mm_mul_epu32(samples, gain_32);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(samples, 4), gain_32);
+    __m128i products =
+        _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                           _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(accumulate,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate),
+                                   _mm_srai_epi32(products, 7)));
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  for (; i + 2 <= num_blocks; i += 2) {
+    int32x4_t samples = vshrq_n_s32(
+        vmulq_n_s32(vld1q_s32((const int32_t*)(mixed + i)), gain), 7);
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate, vaddq_s32(vld1q_s32(accumulate), samples));
+  }
+#endif
+  AccumulateMixedSamplesWithGainScalar(accumulate_buffer + i, gain, mixed + i,
+                                       num_blocks - i);
+}
+
+void AccumulateMixedSamplesWithRamp(StereoBlock32* accumulate_buffer,
+                                    const StereoGainRamp& ramp,
+                                    const StereoBlock32* mixed,
+                                    size_t num_blocks) {
+  size_t i = 0;
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  __m256i steps = _mm256_setr_epi32(ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step,
+                                    ramp.left_step, ramp.right_step);
+  __m256i gains = _mm256_add_epi32(
+      _mm256_setr_epi32(ramp.left_start, ramp.right_start, ramp.left_start,
+                        ramp.right_start, ramp.left_start, ramp.right_start,
+                        ramp.left_start, ramp.right_start),
+      _mm256_mullo_epi32(steps, _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3)));
+  __m256i gains_step = _mm256_slli_epi32(steps, 2);
+  for (; i + 4 <= num_blocks; i += 4) {
+    __m256i samples = _mm256_loadu_si256((const __m256i*)(mixed + i));
+    samples = _mm256_srai_epi32(
+        _mm256_mullo_epi32(samples,
+                           _mm256_srai_epi32(gains, kGainRampFractionBits)),
+        7);
+    __m256i* accumulate = (__m256i*)(accumulate_buffer + i);
+    _mm256_storeu_si256(accumulate,
+                        _mm256_add_epi32(_mm256_loadu_si256(accumulate),
+                                         samples));
+    gains = _mm256_add_epi32(gains, gains_step);
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  // Gains of blocks i, i + 1, multiplied as in
+  // AccumulateMixedSamplesWithGain().
+  __m128i steps = _mm_setr_epi32(ramp.left_step, ramp.right_step,
+                                 ramp.left_step, ramp.right_step);
+  __m128i gains = _mm_add_epi32(
+      _mm_setr_epi32(ramp.left_start, ramp.right_start, ramp.left_start,
+                     ramp.right_start),
+      _mm_unpackhi_epi64(_mm_setzero_si128(), steps));
+  __m128i gains_step = _mm_slli_epi32(steps, 1);
+  for (; i + 2 <= num_blocks; i += 2) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(mixed + i));
+    __m128i gain_32 = _mm_srai_epi32(gains, kGainRampFractionBits);
+    __m128i even = _mm_mul_epu32(samples, gain_32);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(samples, 4),
+                                _mm_srli_si128(gain_32, 4));
+    __m128i products =
+        _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                           _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    __m128i* accumulate = (__m128i*)(accumulate_buffer + i);
+    _mm_storeu_si128(accumulate,
+                     _mm_add_epi32(_mm_loadu_si128(accumulate),
+                                   _mm_srai_epi32(products, 7)));
+    gains = _mm_add_epi32(gains, gains_step);
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  const int32_t step_lanes[4] = {ramp.left_step, ramp.right_step,
+                                 ramp.left_step, ramp.right_step};
+  const int32_t start_lanes[4] = {ramp.left_start, ramp.right_start,
+                                  ramp.left_start, ramp.right_start};
+  const int32_t block_lanes[4] = {0, 0, 1, 1};
+  int32x4_t steps = vld1q_s32(step_lanes);
+  int32x4_t gains =
+      vmlaq_s32(vld1q_s32(start_lanes), steps, vld1q_s32(block_lanes));
+  int32x4_t gains_step = vshlq_n_s32(steps, 1);
+  for (; i + 2 <= num_blocks; i += 2) {
+    int32x4_t samples = vshrq_n_s32(
+        vmulq_s32(vld1q_s32((const int32_t*)(mixed + i)),
+                  vshrq_n_s32(gains, kGainRampFractionBits)),
+        7);
+    int32_t* accumulate = (int32_t*)(accumulate_buffer + i);
+    vst1q_s32(accumulate, vaddq_s32(vld1q_s32(accumulate), samples));
+    gains = vaddq_s32(gains, gains_step);
+  }
+#endif
+  AccumulateMixedSamplesWithRampScalar(accumulate_buffer + i,
+                                       AdvanceStereoGainRamp(ramp, i),
+                                       mixed + i, num_blocks - i);
+}
+
+size_t PackStereoSamples(StereoBlock16* output, const StereoBlock32* mixed,
+                         size_t num_blocks) {
+  size_t i = 0;
+  size_t num_clipped = 0;
+  // Clipped samples are counted per lane: comparison gives -1 for a clipped
+  // sample, which is subtracted from the counters.
+#if defined(SYMPHONY_AUDIO_MIXING_AVX2)
+  const __m256i max = _mm256_set1_epi32(kSampleMax16);
+  const __m256i min = _mm256_set1_epi32(kSampleMin16);
+  __m256i clipped = _mm256_setzero_si256();
+  for (; i + 8 <= num_blocks; i += 8) {
+    const __m256i* source = (const __m256i*)(mixed + i);
+    __m256i lo = _mm256_loadu_si256(source);
+    __m256i hi = _mm256_loadu_si256(source + 1);
+    // Packing works within 128-bit lanes, restores order of 64-bit parts:
+    __m256i packed =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+    _mm256_storeu_si256((__m256i*)(output + i), packed);
+
+    clipped = _mm256_sub_epi32(clipped, _mm256_cmpgt_epi32(lo, max));
+    clipped = _mm256_sub_epi32(clipped, _mm256_cmpgt_epi32(min, lo));
+    clipped = _mm256_sub_epi32(clipped, _mm256_cmpgt_epi32(hi, max));
+    clipped = _mm256_sub_epi32(clipped, _mm256_cmpgt_epi32(min, hi));
+  }
+  int32_t lanes[8];
+  _mm256_storeu_si256((__m256i*)lanes, clipped);
+  for (int32_t lane : lanes) {
+    num_clipped += lane;
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_SSE2)
+  const __m128i max = _mm_set1_epi32(kSampleMax16);
+  const __m128i min = _mm_set1_epi32(kSampleMin16);
+  __m128i clipped = _mm_setzero_si128();
+  for (; i + 4 <= num_blocks; i += 4) {
+    const __m128i* source = (const __m128i*)(mixed + i);
+    __m128i lo = _mm_loadu_si128(source);
+    __m128i hi = _mm_loadu_si128(source + 1);
+    _mm_storeu_si128((__m128i*)(output + i), _mm_packs_epi32(lo, hi));
+
+    clipped = _mm_sub_epi32(clipped, _mm_cmpgt_epi32(lo, max));
+    clipped = _mm_sub_epi32(clipped, _mm_cmplt_epi32(lo, min));
+    clipped = _mm_sub_epi32(clipped, _mm_cmpgt_epi32(hi, max));
+    clipped = _mm_sub_epi32(clipped, _mm_cmplt_epi32(hi, min));
+  }
+  int32_t lanes[4];
+  _mm_storeu_si128((__m128i*)lanes, clipped);
+  for (int32_t lane : lanes) {
+    num_clipped += lane;
+  }
+#elif defined(SYMPHONY_AUDIO_MIXING_NEON)
+  const int32x4_t max = vdupq_n_s32(kSampleMax16);
+  const int32x4_t min = vdupq_n_s32(kSampleMin16);
+  int32x4_t clipped = vdupq_n_s32(0);
+  for (; i + 4 <= num_blocks; i += 4) {
+    const int32_t* source = (const int32_t*)(mixed + i);
+    int32x4_t lo = vld1q_s32(source);
+    int32x4_t hi = vld1q_s32(source + 4);
+    vst1q_s16((int16_t*)(output + i),
+              vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+
+    clipped = vsubq_s32(clipped, vreinterpretq_s32_u32(vcgtq_s32(lo, max)));
+    clipped = vsubq_s32(clipped, vreinterpretq_s32_u32(vcltq_s32(lo, min)));
+    clipped = vsubq_s32(clipped, vreinterpretq_s32_u32(vcgtq_s32(hi, max)));
+    clipped = vsubq_s32(clipped, vreinterpretq_s32_u32(vcltq_s32(hi, min)));
+  }
+  int32_t lanes[4];
+  vst1q_s32(lanes, clipped);
+  for (int32_t lane : lanes) {
+    num_clipped += lane;
+  }
+#endif
+  return num_clipped +
+         PackStereoSamplesScalar(output + i, mixed + i, num_blocks - i);
+}
+
+void AccumulateStereoSamplesScalar(StereoBlock32* accumulate_buffer,
+                                   const StereoBlock16* stream,
+                                   size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    accumulate_buffer[i].left += stream[i].left;
+    accumulate_buffer[i].right += stream[i].right;
+  }
+}
+
+void AccumulateStereoSamplesWithGainScalar(StereoBlock32* accumulate_buffer,
+                                           int32_t gain,
+                                           const StereoBlock16* stream,
+                                           size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    accumulate_buffer[i].left += ApplyGain(stream[i].left, gain);
+    accumulate_buffer[i].right += ApplyGain(stream[i].right, gain);
+  }
+}
+
+void AccumulateMonoSamplesScalar(StereoBlock32* accumulate_buffer,
+                                 const int16_t* stream, size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    accumulate_buffer[i].left += stream[i];
+    accumulate_buffer[i].right += stream[i];
+  }
+}
+
+void AccumulateMonoSamplesWithGainScalar(StereoBlock32* accumulate_buffer,
+                                         int32_t gain, const int16_t* stream,
+                                         size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    accumulate_buffer[i].left += ApplyGain(stream[i], gain);
+    accumulate_buffer[i].right += ApplyGain(stream[i], gain);
+  }
+}
+
+void AccumulateStereoSamplesWithRampScalar(StereoBlock32* accumulate_buffer,
+                                           const StereoGainRamp& ramp,
+                                           const StereoBlock16* stream,
+                                           size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    int32_t left_gain = (ramp.left_start + ramp.left_step * (int32_t)i) >>
+                        kGainRampFractionBits;
+    int32_t right_gain = (ramp.right_start + ramp.right_step * (int32_t)i) >>
+                         kGainRampFractionBits;
+    accumulate_buffer[i].left += ApplyGain(stream[i].left, left_gain);
+    accumulate_buffer[i].right += ApplyGain(stream[i].right, right_gain);
+  }
+}
+
+void AccumulateMonoSamplesWithRampScalar(StereoBlock32* accumulate_buffer,
+                                         const StereoGainRamp& ramp,
+                                         const int16_t* stream,
+                                         size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    int32_t left_gain = (ramp.left_start + ramp.left_step * (int32_t)i) >>
+                        kGainRampFractionBits;
+    int32_t right_gain = (ramp.right_start + ramp.right_step * (int32_t)i) >>
+                         kGainRampFractionBits;
+    accumulate_buffer[i].left += ApplyGain(stream[i], left_gain);
+    accumulate_buffer[i].right += ApplyGain(stream[i], right_gain);
+  }
+}
+
+void AccumulateMixedSamplesScalar(StereoBlock32* accumulate_buffer,
+                                  const StereoBlock32* mixed,
+                                  size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    accumulate_buffer[i].left += mixed[i].left;
+    accumulate_buffer[i].right += mixed[i].right;
+  }
+}
+
+void AccumulateMixedSamplesWithGainScalar(StereoBlock32* accumulate_buffer,
+                                          int32_t gain,
+                                          const StereoBlock32* mixed,
+                                          size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    accumulate_buffer[i].left += ApplyGain(mixed[i].left, gain);
+    accumulate_buffer[i].right += ApplyGain(mixed[i].right, gain);
+  }
+}
+
+void AccumulateMixedSamplesWithRampScalar(StereoBlock32* accumulate_buffer,
+                                          const StereoGainRamp& ramp,
+                                          const StereoBlock32* mixed,
+                                          size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    int32_t left_gain = (ramp.left_start + ramp.left_step * (int32_t)i) >>
+                        kGainRampFractionBits;
+    int32_t right_gain = (ramp.right_start + ramp.right_step * (int32_t)i) >>
+                         kGainRampFractionBits;
+    accumulate_buffer[i].left += ApplyGain(mixed[i].left, left_gain);
+    accumulate_buffer[i].right += ApplyGain(mixed[i].right, right_gain);
+  }
+}
+
+size_t PackStereoSamplesScalar(StereoBlock16* output,
+                               const StereoBlock32* mixed, size_t num_blocks) {
+  size_t num_clipped = 0;
+  for (size_t i = 0; i < num_blocks; ++i) {
+    output[i].left =
+        (int16_t)std::clamp(mixed[i].left, kSampleMin16, kSampleMax16);
+    output[i].right =
+        (int16_t)std::clamp(mixed[i].right, kSampleMin16, kSampleMax16);
+    num_clipped += (output[i].left != mixed[i].left) +
+                   (output[i].right != mixed[i].right);
+  }
+  return num_clipped;
+}
+}  // namespace Audio
+}  // namespace Symphony
@@ -0,0 +1,252 @@
+#include "mixing_kernels.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "mixing_test_utils.hpp"
+
+using namespace Symphony::Audio;
+
+namespace {
+static constexpr size_t kMaxNumBlocks = 67;
+static constexpr int32_t kGains[] = {0, 1, 17, 64, 100, 127, 128, 255};
+
+std::vector<int16_t> MakeSamples(size_t num_samples, uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> distribution(kSampleMin16, kSampleMax16);
+  std::vector<int16_t> result(num_samples);
+  for (auto& sample : result) {
+    sample = (int16_t)distribution(generator);
+  }
+  // Extremes:
+  result[0] = kSampleMin16;
+  result[1] = kSampleMax16;
+  return result;
+}
+
+void ExpectSame(const std::vector<StereoBlock32>& expected,
+                const std::vector<StereoBlock32>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i].left, actual[i].left) << "block " << i;
+    ASSERT_EQ(expected[i].right, actual[i].right) << "block " << i;
+  }
+}
+}  // namespace
+
+TEST(MixingKernels, AccumulateStereoMatchesScalar) {
+  for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+    auto samples = MakeSamples(kMaxNumBlocks * 2, num_blocks);
+    auto stream = (const StereoBlock16*)samples.data();
+    auto expected = MakeMixed(num_blocks, 100000, 1);
+    auto actual = expected;
+
+    AccumulateStereoSamplesScalar(expected.data(), stream, num_blocks);
+    AccumulateStereoSamples(actual.data(), stream, num_blocks);
+    ExpectSame(expected, actual);
+  }
+}
+
+TEST(MixingKernels, AccumulateStereoWithGainMatchesScalar) {
+  for (int32_t gain : kGains) {
+    for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+      auto samples = MakeSamples(kMaxNumBlocks * 2, num_blocks);
+      auto stream = (const StereoBlock16*)samples.data();
+      auto expected = MakeMixed(num_blocks, 100000, 2);
+      auto actual = expected;
+
+      AccumulateStereoSamplesWithGainScalar(expected.data(), gain, stream,
+                                            num_blocks);
+      AccumulateStereoSamplesWithGain(actual.data(), gain, stream, num_blocks);
+      ExpectSame(expected, actual);
+    }
+  }
+}
+
+TEST(MixingKernels, AccumulateMonoMatchesScalar) {
+  for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+    auto samples = MakeSamples(kMaxNumBlocks, num_blocks);
+    auto expected = MakeMixed(num_blocks, 100000, 3);
+    auto actual = expected;
+
+    AccumulateMonoSamplesScalar(expected.data(), samples.data(), num_blocks);
+    AccumulateMonoSamples(actual.data(), samples.data(), num_blocks);
+    ExpectSame(expected, actual);
+  }
+}
+
+TEST(MixingKernels, AccumulateMonoWithGainMatchesScalar) {
+  for (int32_t gain : kGains) {
+    for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+      auto samples = MakeSamples(kMaxNumBlocks, num_blocks);
+      auto expected = MakeMixed(num_blocks, 100000, 4);
+      auto actual = expected;
+
+      AccumulateMonoSamplesWithGainScalar(expected.data(), gain,
+                                          samples.data(), num_blocks);
+      AccumulateMonoSamplesWithGain(actual.data(), gain, samples.data(),
+                                    num_blocks);
+      ExpectSame(expected, actual);
+    }
+  }
+}
+
+TEST(MixingKernels, AccumulateStereoWithRampMatchesScalar) {
+  for (int32_t from : kGains) {
+    for (int32_t to : kGains) {
+      for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+        auto samples = MakeSamples(kMaxNumBlocks * 2, num_blocks);
+        auto stream = (const StereoBlock16*)samples.data();
+        auto expected = MakeMixed(num_blocks, 100000, 5);
+        auto actual = expected;
+        StereoGainRamp ramp = GetStereoGainRamp(from, to, to, from, num_blocks);
+
+        AccumulateStereoSamplesWithRampScalar(expected.data(), ramp, stream,
+                                              num_blocks);
+        AccumulateStereoSamplesWithRamp(actual.data(), ramp, stream,
+                                        num_blocks);
+        ExpectSame(expected, actual);
+      }
+    }
+  }
+}
+
+TEST(MixingKernels, AccumulateMonoWithRampMatchesScalar) {
+  for (int32_t from : kGains) {
+    for (int32_t to : kGains) {
+      for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+        auto samples = MakeSamples(kMaxNumBlocks, num_blocks);
+        auto expected = MakeMixed(num_blocks, 100000, 6);
+        auto actual = expected;
+        StereoGainRamp ramp = GetStereoGainRamp(from, to, to, from, num_blocks);
+
+        AccumulateMonoSamplesWithRampScalar(expected.data(), ramp,
+                                            samples.data(), num_blocks);
+        AccumulateMonoSamplesWithRamp(actual.data(), ramp, samples.data(),
+                                      num_blocks);
+        ExpectSame(expected, actual);
+      }
+    }
+  }
+}
+
+TEST(MixingKernels, RampWithoutStepsMatchesGain) {
+  for (int32_t gain : kGains) {
+    auto samples = MakeSamples(kMaxNumBlocks, gain);
+    auto expected = MakeMixed(kMaxNumBlocks, 100000, 7);
+    auto actual = expected;
+    StereoGainRamp ramp =
+        GetStereoGainRamp(gain, gain, gain, gain, kMaxNumBlocks);
+
+    AccumulateMonoSamplesWithGain(expected.data(), gain, samples.data(),
+                                  kMaxNumBlocks);
+    AccumulateMonoSamplesWithRamp(actual.data(), ramp, samples.data(),
+                                  kMaxNumBlocks);
+    ExpectSame(expected, actual);
+  }
+}
+
+TEST(MixingKernels, RampMovesFromGainToGain) {
+  const size_t kNumBlocks = 1024;
+  std::vector<int16_t> samples(kNumBlocks, 1024);
+  std::vector<StereoBlock32> mixed(kNumBlocks);
+  // Hard left to hard right:
+  StereoGainRamp ramp = GetStereoGainRamp(128, 0, 0, 128, kNumBlocks);
+
+  AccumulateMonoSamplesWithRamp(mixed.data(), ramp, samples.data(),
+                                kNumBlocks);
+
+  EXPECT_EQ(mixed[0].left, 1024);
+  EXPECT_EQ(mixed[0].right, 0);
+  EXPECT_EQ(mixed[kNumBlocks / 2].left, 512);
+  EXPECT_EQ(mixed[kNumBlocks / 2].right, 512);
+  // Changes by at most one step of the 7-bit gain per block:
+  for (size_t i = 1; i < kNumBlocks; ++i) {
+    EXPECT_LE(mixed[i - 1].left - mixed[i].left, 8) << "block " << i;
+    EXPECT_LE(mixed[i].right - mixed[i - 1].right, 8) << "block " << i;
+  }
+  StereoGainRamp end = AdvanceStereoGainRamp(ramp, kNumBlocks);
+  EXPECT_EQ(end.left_start >> kGainRampFractionBits, 0);
+  EXPECT_EQ(end.right_start >> kGainRampFractionBits, 128);
+}
+
+TEST(MixingKernels, AccumulateMixedMatchesScalar) {
+  for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+    auto mixed = MakeMixed(num_blocks, 1000000, num_blocks);
+    auto expected = MakeMixed(num_blocks, 100000, 5);
+    auto actual = expected;
+
+    AccumulateMixedSamplesScalar(expected.data(), mixed.data(), num_blocks);
+    AccumulateMixedSamples(actual.data(), mixed.data(), num_blocks);
+    ExpectSame(expected, actual);
+  }
+}
+
+TEST(MixingKernels, AccumulateMixedWithGainMatchesScalar) {
+  for (int32_t gain : kGains) {
+    for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+      auto mixed = MakeMixed(num_blocks, 1000000, num_blocks);
+      auto expected = MakeMixed(num_blocks, 100000, 6);
+      auto actual = expected;
+
+      AccumulateMixedSamplesWithGainScalar(expected.data(), gain, mixed.data(),
+                                           num_blocks);
+      AccumulateMixedSamplesWithGain(actual.data(), gain, mixed.data(),
+                                     num_blocks);
+      ExpectSame(expected, actual);
+    }
+  }
+}
+
+TEST(MixingKernels, AccumulateMixedWithRampMatchesScalar) {
+  for (int32_t from : kGains) {
+    for (int32_t to : kGains) {
+      for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+        auto mixed = MakeMixed(num_blocks, 1000000, num_blocks);
+        auto expected = MakeMixed(num_blocks, 100000, 8);
+        auto actual = expected;
+        StereoGainRamp ramp = GetStereoGainRamp(from, to, to, from, num_blocks);
+
+        AccumulateMixedSamplesWithRampScalar(expected.data(), ramp,
+                                             mixed.data(), num_blocks);
+        AccumulateMixedSamplesWithRamp(actual.data(), ramp, mixed.data(),
+                                       num_blocks);
+        ExpectSame(expected, actual);
+      }
+    }
+  }
+}
+
+TEST(MixingKernels, PackMatchesScalar) {
+  for (size_t num_blocks = 0; num_blocks <= kMaxNumBlocks; ++num_blocks) {
+    auto mixed = MakeMixed(num_blocks, 200000, num_blocks);
+    std::vector<StereoBlock16> expected(num_blocks);
+    std::vector<StereoBlock16> actual(num_blocks);
+
+    ASSERT_EQ(
+        PackStereoSamplesScalar(expected.data(), mixed.data(), num_blocks),
+        PackStereoSamples(actual.data(), mixed.data(), num_blocks));
+    for (size_t i = 0; i < num_blocks; ++i) {
+      ASSERT_EQ(expected[i].left, actual[i].left) << "block " << i;
+      ASSERT_EQ(expected[i].right, actual[i].right) << "block " << i;
+    }
+  }
+}
+
+TEST(MixingKernels, PackSaturates) {
+  std::vector<StereoBlock32> mixed = {
+      {40000, -40000}, {32767, -32768}, {32768, -32769}, {0, 1}};
+  std::vector<StereoBlock16> output(mixed.size());
+
+  ASSERT_EQ(PackStereoSamples(output.data(), mixed.data(), mixed.size()), 4);
+  ASSERT_EQ(output[0].left, 32767);
+  ASSERT_EQ(output[0].right, -32768);
+  ASSERT_EQ(output[1].left, 32767);
+  ASSERT_EQ(output[1].right, -32768);
+  ASSERT_EQ(output[2].left, 32767);
+  ASSERT_EQ(output[2].right, -32768);
+  ASSERT_EQ(output[3].left, 0);
+  ASSERT_EQ(output[3].right, 1);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <random>
+#include <vector>
+
+#include "mixing_kernels.hpp"
+
+namespace Symphony {
+namespace Audio {
+// Already mixed samples in [-range, range], the same for the same seed.
+std::vector<StereoBlock32> MakeMixed(size_t num_blocks, int32_t range,
+                                     uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int32_t> distribution(-range, range);
+  std::vector<StereoBlock32> result(num_blocks);
+  for (auto& block : result) {
+    block.left = distribution(generator);
+    block.right = distribution(generator);
+  }
+  return result;
+}
+}  // namespace Audio
+}  // namespace Symphony
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace Symphony {
+namespace Audio {
+// Polyphase windowed sinc resampler, for converting wave files to the sample
+// rate of the device once, when they are loaded.
+//
+// Ratio of rates is reduced to L/M: output block n lies at input position
+// n * M / L, its fraction is one of L phases, and every phase has its own
+// precomputed filter. When the rate goes down, the cutoff goes down with it,
+// so that frequencies above the new Nyquist frequency are filtered out
+// instead of being aliased. Samples before and after the input are silence.
+
+// Returns: number of blocks which num_blocks blocks take at out_rate.
+size_t GetResampledNumBlocks(size_t num_blocks, size_t in_rate,
+                             size_t out_rate);
+
+// Blocks are interleaved int16_t samples of num_channels channels.
+// blocks_out should hold GetResampledNumBlocks() blocks.
+void ResampleBlocks(const int16_t* blocks, size_t num_blocks,
+                    size_t num_channels, size_t in_rate, size_t out_rate,
+                    int16_t* blocks_out);
+
+namespace {
+const double kResamplerPi = 3.14159265358979323846;
+// Zero crossings of the sinc on each side of the filter center.
+const size_t kResamplerZeroCrossings = 16;
+// Fraction of the lower Nyquist frequency which passes, the rest of the band
+// is left for the filter to roll off.
+const double kResamplerPassband = 0.95;
+// Rates with more phases, e.g. 44100 to 44101, round positions to the
+// nearest of kResamplerMaxPhases phases.
+const size_t kResamplerMaxPhases = 1024;
+
+double GetBlackmanWindow(double x) {
+  // x is in [-1, 1].
+  return 0.42 + 0.5 * std::cos(kResamplerPi * x) +
+         0.08 * std::cos(2.0 * kResamplerPi * x);
+}
+}  // namespace
+
+size_t GetResampledNumBlocks(size_t num_blocks, size_t in_rate,
+                             size_t out_rate) {
+  return (size_t)(((uint64_t)num_blocks * out_rate + in_rate - 1) / in_rate);
+}
+
+void ResampleBlocks(const int16_t* blocks, size_t num_blocks,
+                    size_t num_channels, size_t in_rate, size_t out_rate,
+                    int16_t* blocks_out) {
+  size_t rates_gcd = std::gcd(in_rate, out_rate);
+  uint64_t num_rate_phases = out_rate / rates_gcd;
+  uint64_t step = in_rate / rates_gcd;
+  size_t num_phases =
+      (size_t)std::min(num_rate_phases, (uint64_t)kResamplerMaxPhases);
+
+  // In input samples, relative to its Nyquist frequency.
+  double cutoff = kResamplerPassband *
+                  std::min(1.0, (double)out_rate / (double)in_rate);
+  size_t half_num_taps =
+      (size_t)std::ceil((double)kResamplerZeroCrossings / cutoff);
+  size_t num_taps = half_num_taps * 2;
+
+  // Tap k of phase p is applied to input block i - half_num_taps + 1 + k,
+  // where i + p / num_phases is the position of the output block.
+  std::vector<float> filters(num_phases * num_taps);
+  for (size_t phase = 0; phase < num_phases; ++phase) {
+    double fraction = (double)phase / (double)num_phases;
+    float* filter = &filters[phase * num_taps];
+    double sum = 0.0;
+    for (size_t k = 0; k < num_taps; ++k) {
+      double x = (double)k - (double)half_num_taps + 1.0 - fraction;
+      double angle = kResamplerPi * cutoff * x;
+      double sinc = x == 0.0 ? 1.0 : std::sin(angle) / angle;
+      double tap = sinc * GetBlackmanWindow(x / (double)half_num_taps);
+      filter[k] = (float)tap;
+      sum += tap;
+    }
+    // Constant signal keeps its level whatever the phase is.
+    for (size_t k = 0; k < num_taps; ++k) {
+      filter[k] = (float)(filter[k] / sum);
+    }
+  }
+
+  size_t num_blocks_out = GetResampledNumBlocks(num_blocks, in_rate, out_rate);
+  for (size_t n = 0; n < num_blocks_out; ++n) {
+    uint64_t position = (uint64_t)n * step;
+    int64_t first_block = (int64_t)(position / num_rate_phases);
+    size_t phase = (size_t)(((position % num_rate_phases) * num_phases +
+                             num_rate_phases / 2) /
+                            num_rate_phases);
+    if (phase == num_phases) {
+      phase = 0;
+      ++first_block;
+    }
+    first_block -= (int64_t)half_num_taps - 1;
+
+    size_t first_tap = first_block < 0 ? (size_t)-first_block : 0;
+    size_t end_tap = (size_t)std::clamp(
+        (int64_t)num_blocks - first_block, (int64_t)0, (int64_t)num_taps);
+    const float* filter = &filters[phase * num_taps];
+
+    for (size_t c = 0; c < num_channels; ++c) {
+      float sample = 0.0f;
+      for (size_t k = first_tap; k < end_tap; ++k) {
+        size_t block = (size_t)(first_block + (int64_t)k);
+        sample += filter[k] * (float)blocks[block * num_channels + c];
+      }
+      blocks_out[n * num_channels + c] =
+          (int16_t)std::clamp(std::lround(sample), -32768l, 32767l);
+    }
+  }
+}
+
+}  // namespace Audio
+}  // namespace Symphony
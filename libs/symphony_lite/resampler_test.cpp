@@ -0,0 +1,72 @@
+#include "resampler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace Symphony::Audio;
+
+namespace {
+std::vector<int16_t> MakeSine(size_t num_blocks, size_t num_channels,
+                              double frequency, size_t sample_rate) {
+  std::vector<int16_t> samples(num_blocks * num_channels);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    for (size_t c = 0; c < num_channels; ++c) {
+      double phase = 2.0 * 3.14159265358979323846 * frequency *
+                     (double)(c + 1) * (double)i / (double)sample_rate;
+      samples[i * num_channels + c] = (int16_t)(10000.0 * std::sin(phase));
+    }
+  }
+  return samples;
+}
+
+std::vector<int16_t> Resample(const std::vector<int16_t>& samples,
+                              size_t num_channels, size_t in_rate,
+                              size_t out_rate) {
+  size_t num_blocks = samples.size() / num_channels;
+  std::vector<int16_t> result(
+      GetResampledNumBlocks(num_blocks, in_rate, out_rate) * num_channels);
+  ResampleBlocks(samples.data(), num_blocks, num_channels, in_rate, out_rate,
+                 result.data());
+  return result;
+}
+}  // namespace
+
+TEST(Resampler, ComputesNumBlocks) {
+  ASSERT_EQ(GetResampledNumBlocks(44100, 44100, 22050), 22050);
+  ASSERT_EQ(GetResampledNumBlocks(3, 44100, 22050), 2);
+  ASSERT_EQ(GetResampledNumBlocks(11025, 11025, 22050), 22050);
+  ASSERT_EQ(GetResampledNumBlocks(48000, 48000, 22050), 22050);
+}
+
+TEST(Resampler, KeepsSineAcrossRates) {
+  // Pairs of rates with one phase, a few phases and many phases.
+  const size_t kRates[][2] = {
+      {44100, 22050}, {11025, 22050}, {48000, 22050}, {22050, 22051}};
+  for (const auto& rates : kRates) {
+    size_t in_rate = rates[0];
+    size_t out_rate = rates[1];
+    std::vector<int16_t> samples = MakeSine(in_rate / 10, 2, 440.0, in_rate);
+    std::vector<int16_t> expected =
+        MakeSine(GetResampledNumBlocks(in_rate / 10, in_rate, out_rate), 2,
+                 440.0, out_rate);
+    std::vector<int16_t> resampled = Resample(samples, 2, in_rate, out_rate);
+    ASSERT_EQ(resampled.size(), expected.size());
+
+    // Edges fade in and out, input is silent outside of it.
+    for (size_t i = 200; i < resampled.size() - 200; ++i) {
+      ASSERT_NEAR(resampled[i], expected[i], 40)
+          << in_rate << " to " << out_rate << ", sample " << i;
+    }
+  }
+}
+
+TEST(Resampler, FiltersFrequenciesAboveNewNyquist) {
+  // 15 kHz can't be represented at 22050 Hz, it would alias to 7050 Hz.
+  std::vector<int16_t> samples = MakeSine(4410, 1, 15000.0, 44100);
+  std::vector<int16_t> resampled = Resample(samples, 1, 44100, 22050);
+  for (size_t i = 200; i < resampled.size() - 200; ++i) {
+    ASSERT_LT(std::abs(resampled[i]), 50) << i;
+  }
+}
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "audio.hpp"
+#include "log.hpp"
+#include "wave_loader.hpp"
+
+namespace Symphony {
+namespace Audio {
+// Variations of one sound, e.g. several body falls. Any of them can be played
+// when the sound is needed.
+struct SoundGroupConfig {
+  std::string name;
+  std::vector<std::string> file_paths;
+  WaveFile::Mode mode{WaveFile::kModeLoadInMemory};
+  // Limits of the whole group, all variations count as one sound.
+  std::optional<SoundLimits> limits;
+};
+
+// Groups which are loaded and released together, e.g. sounds of one screen.
+struct SoundBankConfig {
+  std::string name;
+  std::vector<SoundGroupConfig> groups;
+};
+
+inline constexpr size_t kNoSoundGroup = (size_t)-1;
+
+// Banks are loaded on demand and stay loaded while they are acquired. Banks
+// which are released stay loaded too, until samples of all loaded banks don't
+// fit into the memory budget: then the least recently used of them are
+// unloaded. Going back to a screen doesn't load its sounds again, unless they
+// were pushed out by sounds of other screens.
+//
+// Unloading a bank doesn't stop its sounds: voices keep their wave files
+// alive until they finish.
+//
+// Should be used from the game thread.
+class SoundBanks {
+ public:
+  SoundBanks() = default;
+
+  // sample_rate: files are converted to it when loaded, see LoadWave().
+  // memory_budget_bytes: banks in use are never unloaded, even when they
+  // don't fit.
+  void Init(const std::vector<SoundBankConfig>& banks, size_t sample_rate,
+            size_t memory_budget_bytes);
+
+  // Loads the bank if it isn't loaded. Every Acquire() should be paired with
+  // Release().
+  void Acquire(const std::string& bank_name);
+  void Release(const std::string& bank_name);
+
+  bool IsLoaded(const std::string& bank_name) const;
+  // Samples held by all loaded banks, see WaveFile::GetSizeInMemory().
+  size_t GetMemoryUsed() const { return memory_used_; }
+
+  // Returns kNoSoundGroup when no bank has the group.
+  size_t FindGroup(const std::string& group_name) const;
+  size_t GetNumVariations(size_t group) const;
+  // Returns nullptr while the bank of the group isn't loaded.
+  std::shared_ptr<WaveFile> GetWaveFile(size_t group, size_t variation) const;
+  // Variations of the group as one sound, which picks one of them when
+  // triggered. Returns nullptr while the bank of the group isn't loaded or
+  // when the group has no limits.
+  LimitedSound* GetLimitedSound(size_t group);
+
+ private:
+  struct Group {
+    SoundGroupConfig config;
+    // Empty while the bank isn't loaded.
+    std::vector<std::shared_ptr<WaveFile>> wave_files;
+    std::optional<LimitedSound> limited_sound;
+  };
+
+  struct Bank {
+    std::string name;
+    std::vector<size_t> groups;
+    bool is_loaded{false};
+    int num_users{0};
+    // Value of use_counter_ when the bank was acquired or released last time.
+    uint64_t last_use{0};
+    size_t memory_size{0};
+  };
+
+  Bank* findBank(const std::string& bank_name);
+  const Bank* findBank(const std::string& bank_name) const;
+  void loadBank(Bank& bank);
+  void unloadBank(Bank& bank);
+  void evictUnused();
+
+  size_t sample_rate_{0};
+  size_t memory_budget_bytes_{0};
+  size_t memory_used_{0};
+  uint64_t use_counter_{0};
+  std::vector<Bank> banks_;
+  std::vector<Group> groups_;
+};
+
+void SoundBanks::Init(const std::vector<SoundBankConfig>& banks,
+                      size_t sample_rate, size_t memory_budget_bytes) {
+  sample_rate_ = sample_rate;
+  memory_budget_bytes_ = memory_budget_bytes;
+  memory_used_ = 0;
+  use_counter_ = 0;
+  banks_.clear();
+  groups_.clear();
+
+  for (const auto& bank_config : banks) {
+    Bank bank;
+    bank.name = bank_config.name;
+    for (const auto& group_config : bank_config.groups) {
+      if (FindGroup(group_config.name) != kNoSoundGroup) {
+        LOGE("[Symphony::Audio::SoundBanks] Group '{}' is in two banks",
+             group_config.name);
+        continue;
+      }
+      bank.groups.push_back(groups_.size());
+      groups_.push_back(Group{.config = group_config,
+                              .wave_files = {},
+                              .limited_sound = std::nullopt});
+    }
+    banks_.push_back(std::move(bank));
+  }
+}
+
+void SoundBanks::Acquire(const std::string& bank_name) {
+  Bank* bank = findBank(bank_name);
+  if (!bank) {
+    LOGE("[Symphony::Audio::SoundBanks] No bank '{}'", bank_name);
+    return;
+  }
+
+  ++bank->num_users;
+  bank->last_use = ++use_counter_;
+  if (!bank->is_loaded) {
+    loadBank(*bank);
+    evictUnused();
+  }
+}
+
+void SoundBanks::Release(const std::string& bank_name) {
+  Bank* bank = findBank(bank_name);
+  if (!bank || bank->num_users <= 0) {
+    LOGE("[Symphony::Audio::SoundBanks] Bank '{}' isn't acquired", bank_name);
+    return;
+  }
+
+  --bank->num_users;
+  bank->last_use = ++use_counter_;
+  evictUnused();
+}
+
+bool SoundBanks::IsLoaded(const std::string& bank_name) const {
+  const Bank* bank = findBank(bank_name);
+  return bank && bank->is_loaded;
+}
+
+size_t SoundBanks::FindGroup(const std::string& group_name) const {
+  for (size_t i = 0; i < groups_.size(); ++i) {
+    if (groups_[i].config.name == group_name) {
+      return i;
+    }
+  }
+  return kNoSoundGroup;
+}
+
+size_t SoundBanks::GetNumVariations(size_t group) const {
+  if (group >= groups_.size()) {
+    return 0;
+  }
+  return groups_[group].config.file_paths.size();
+}
+
+std::shared_ptr<WaveFile> SoundBanks::GetWaveFile(size_t group,
+                                                  size_t variation) const {
+  if (group >= groups_.size() ||
+      variation >= groups_[group].wave_files.size()) {
+    return nullptr;
+  }
+  return groups_[group].wave_files[variation];
+}
+
+LimitedSound* SoundBanks::GetLimitedSound(size_t group) {
+  if (group >= groups_.size() || !groups_[group].limited_sound.has_value()) {
+    return nullptr;
+  }
+  return &groups_[group].limited_sound.value();
+}
+
+SoundBanks::Bank* SoundBanks::findBank(const std::string& bank_name) {
+  for (auto& bank : banks_) {
+    if (bank.name == bank_name) {
+      return &bank;
+    }
+  }
+  return nullptr;
+}
+
+const SoundBanks::Bank* SoundBanks::findBank(
+    const std::string& bank_name) const {
+  for (const auto& bank : banks_) {
+    if (bank.name == bank_name) {
+      return &bank;
+    }
+  }
+  return nullptr;
+}
+
+void SoundBanks::loadBank(Bank& bank) {
+  bank.memory_size = 0;
+  for (size_t group_index : bank.groups) {
+    Group& group = groups_[group_index];
+    for (const auto& file_path : group.config.file_paths) {
+      std::shared_ptr<WaveFile> wave_file =
+          LoadWave(file_path, group.config.mode, sample_rate_);
+      if (!wave_file) {
+        LOGE("[Symphony::Audio::SoundBanks] Can't load '{}' of group '{}'",
+             file_path, group.config.name);
+      } else {
+        bank.memory_size += wave_file->GetSizeInMemory();
+      }
+      group.wave_files.push_back(std::move(wave_file));
+    }
+    if (group.config.limits.has_value()) {
+      group.limited_sound.emplace(group.wave_files,
+                                  group.config.limits.value());
+    }
+  }
+
+  bank.is_loaded = true;
+  memory_used_ += bank.memory_size;
+  LOGD("[Symphony::Audio::SoundBanks] Loaded bank '{}', {} bytes", bank.name,
+       bank.memory_size);
+}
+
+void SoundBanks::unloadBank(Bank& bank) {
+  for (size_t group_index : bank.groups) {
+    groups_[group_index].wave_files.clear();
+    groups_[group_index].limited_sound.reset();
+  }
+
+  bank.is_loaded = false;
+  memory_used_ -= bank.memory_size;
+  LOGD("[Symphony::Audio::SoundBanks] Unloaded bank '{}', {} bytes",
+       bank.name, bank.memory_size);
+  bank.memory_size = 0;
+}
+
+void SoundBanks::evictUnused() {
+  while (memory_used_ > memory_budget_bytes_) {
+    Bank* least_recently_used = nullptr;
+    for (auto& bank : banks_) {
+      if (bank.is_loaded && bank.num_users == 0 &&
+          (!least_recently_used ||
+           bank.last_use < least_recently_used->last_use)) {
+        least_recently_used = &bank;
+      }
+    }
+    if (!least_recently_used) {
+      // Everything left is in use.
+      return;
+    }
+    unloadBank(*least_recently_used);
+  }
+}
+
+}  // namespace Audio
+}  // namespace Symphony
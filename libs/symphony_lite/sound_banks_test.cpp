@@ -0,0 +1,117 @@
+#include "sound_banks.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "wave_test_utils.hpp"
+
+using namespace Symphony::Audio;
+
+namespace {
+// Mono 16-bit wave file, 2 bytes per block in memory.
+std::string WriteMonoWave(const std::string& name, size_t num_blocks) {
+  return WriteTestWave(name, std::vector<int16_t>(num_blocks, 1000), 1, 22050);
+}
+
+std::vector<SoundBankConfig> MakeTestBanks() {
+  return {
+      SoundBankConfig{
+          .name = "menu",
+          .groups = {SoundGroupConfig{
+              .name = "click",
+              .file_paths = {WriteMonoWave("sound_banks_click.wav", 1000)},
+              .mode = WaveFile::kModeLoadInMemory,
+              .limits = std::nullopt}}},
+      SoundBankConfig{
+          .name = "level",
+          .groups = {SoundGroupConfig{
+              .name = "panic",
+              .file_paths = {WriteMonoWave("sound_banks_panic_1.wav", 1000),
+                             WriteMonoWave("sound_banks_panic_2.wav", 500)},
+              .mode = WaveFile::kModeLoadInMemory,
+              .limits = SoundLimits{.max_instances = 2,
+                                    .min_retrigger_interval_sec = 0.0f,
+                                    .steal_oldest = true}}}},
+      SoundBankConfig{
+          .name = "market",
+          .groups = {SoundGroupConfig{
+              .name = "ka_ching",
+              .file_paths = {WriteMonoWave("sound_banks_ka_ching.wav", 2000)},
+              .mode = WaveFile::kModeLoadInMemory,
+              .limits = std::nullopt}}},
+  };
+}
+}  // namespace
+
+TEST(SoundBanks, LoadsBanksOnlyWhenAcquired) {
+  SoundBanks banks;
+  banks.Init(MakeTestBanks(), 22050, 1000000);
+
+  size_t click = banks.FindGroup("click");
+  size_t panic = banks.FindGroup("panic");
+  ASSERT_NE(click, kNoSoundGroup);
+  ASSERT_NE(panic, kNoSoundGroup);
+  ASSERT_EQ(banks.FindGroup("unknown"), kNoSoundGroup);
+  ASSERT_EQ(banks.GetNumVariations(panic), 2);
+
+  ASSERT_FALSE(banks.IsLoaded("menu"));
+  ASSERT_EQ(banks.GetWaveFile(click, 0), nullptr);
+  ASSERT_EQ(banks.GetMemoryUsed(), 0);
+
+  banks.Acquire("menu");
+  ASSERT_TRUE(banks.IsLoaded("menu"));
+  ASSERT_FALSE(banks.IsLoaded("level"));
+  ASSERT_NE(banks.GetWaveFile(click, 0), nullptr);
+  ASSERT_EQ(banks.GetLimitedSound(click), nullptr);
+  ASSERT_EQ(banks.GetMemoryUsed(), 2000);
+
+  banks.Acquire("level");
+  ASSERT_EQ(banks.GetWaveFile(panic, 1)->GetNumBlocks(), 500);
+  // Variations of the group are one sound with the limits of the group.
+  LimitedSound* panic_sound = banks.GetLimitedSound(panic);
+  ASSERT_NE(panic_sound, nullptr);
+  ASSERT_EQ(panic_sound->GetWaveFiles().size(), 2);
+  ASSERT_EQ(panic_sound->GetLimits().max_instances, 2);
+  ASSERT_EQ(banks.GetMemoryUsed(), 5000);
+}
+
+TEST(SoundBanks, UnloadsLeastRecentlyUsedOverBudget) {
+  SoundBanks banks;
+  // Fits menu and level, or menu and market.
+  banks.Init(MakeTestBanks(), 22050, 6000);
+
+  banks.Acquire("menu");
+  banks.Acquire("level");
+  banks.Release("level");
+  // Released banks stay loaded while they fit.
+  ASSERT_TRUE(banks.IsLoaded("level"));
+
+  banks.Release("menu");
+  banks.Acquire("market");
+  // Level was used before menu.
+  ASSERT_FALSE(banks.IsLoaded("level"));
+  ASSERT_TRUE(banks.IsLoaded("menu"));
+  ASSERT_TRUE(banks.IsLoaded("market"));
+  ASSERT_EQ(banks.GetWaveFile(banks.FindGroup("panic"), 0), nullptr);
+  ASSERT_EQ(banks.GetMemoryUsed(), 6000);
+}
+
+TEST(SoundBanks, KeepsBanksInUseOverBudget) {
+  SoundBanks banks;
+  banks.Init(MakeTestBanks(), 22050, 1000);
+
+  banks.Acquire("menu");
+  banks.Acquire("level");
+  ASSERT_TRUE(banks.IsLoaded("menu"));
+  ASSERT_TRUE(banks.IsLoaded("level"));
+
+  // Wave files in use outlive their bank.
+  std::shared_ptr<WaveFile> click =
+      banks.GetWaveFile(banks.FindGroup("click"), 0);
+  banks.Release("menu");
+  ASSERT_FALSE(banks.IsLoaded("menu"));
+  ASSERT_EQ(click->GetNumBlocks(), 1000);
+  ASSERT_EQ(banks.GetMemoryUsed(), 3000);
+}
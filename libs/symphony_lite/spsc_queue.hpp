@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace Symphony {
+namespace Audio {
+// Single-producer/single-consumer ring of fixed capacity.
+//
+// Push() may only be called from one thread and Pop() from one (other) thread.
+// Both sides only load and store the indices, there is no read-modify-write,
+// so the queue stays lock-free on targets without atomic RMW instructions
+// (PSP's Allegrex has no LL/SC).
+template <typename T, size_t kCapacity>
+class SpscQueue {
+  static_assert(kCapacity >= 2 && (kCapacity & (kCapacity - 1)) == 0,
+                "SpscQueue capacity should be a power of two");
+
+ public:
+  SpscQueue() = default;
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  static constexpr size_t GetCapacity() { return kCapacity; }
+
+  // Producer side. Returns false when the queue is full.
+  bool Push(const T& value) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    if (tail - head == kCapacity) {
+      return false;
+    }
+
+    items_[tail & kMask] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false when the queue is empty.
+  bool Pop(T& value_out) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (head == tail) {
+      return false;
+    }
+
+    value_out = items_[head & kMask];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when called concurrently with Push() or Pop().
+  size_t GetSize() const {
+    uint32_t head = head_.load(std::memory_order_acquire);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    return tail - head;
+  }
+
+  bool IsEmpty() const { return GetSize() == 0; }
+
+ private:
+  static constexpr uint32_t kMask = (uint32_t)kCapacity - 1;
+
+  T items_[kCapacity];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+};
+}  // namespace Audio
+}  // namespace Symphony
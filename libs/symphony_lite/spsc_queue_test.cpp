@@ -0,0 +1,83 @@
+#include "spsc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace Symphony::Audio;
+
+TEST(SpscQueue, IsEmptyWhenCreated) {
+  SpscQueue<int, 4> queue;
+  int value = 0;
+  ASSERT_TRUE(queue.IsEmpty());
+  ASSERT_EQ(queue.GetSize(), 0);
+  ASSERT_FALSE(queue.Pop(value));
+}
+
+TEST(SpscQueue, PopsInPushOrder) {
+  SpscQueue<int, 4> queue;
+  ASSERT_TRUE(queue.Push(1));
+  ASSERT_TRUE(queue.Push(2));
+  ASSERT_TRUE(queue.Push(3));
+  ASSERT_EQ(queue.GetSize(), 3);
+
+  int value = 0;
+  ASSERT_TRUE(queue.Pop(value));
+  ASSERT_EQ(value, 1);
+  ASSERT_TRUE(queue.Pop(value));
+  ASSERT_EQ(value, 2);
+  ASSERT_TRUE(queue.Pop(value));
+  ASSERT_EQ(value, 3);
+  ASSERT_FALSE(queue.Pop(value));
+}
+
+TEST(SpscQueue, RejectsPushWhenFull) {
+  SpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.Push(i));
+  }
+  ASSERT_FALSE(queue.Push(4));
+
+  int value = 0;
+  ASSERT_TRUE(queue.Pop(value));
+  ASSERT_EQ(value, 0);
+  ASSERT_TRUE(queue.Push(4));
+}
+
+TEST(SpscQueue, WrapsAround) {
+  SpscQueue<int, 4> queue;
+  int value = 0;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.Push(i));
+    ASSERT_TRUE(queue.Pop(value));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_TRUE(queue.IsEmpty());
+}
+
+TEST(SpscQueue, PassesItemsBetweenThreads) {
+  static constexpr int kNumItems = 100000;
+  SpscQueue<int, 64> queue;
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kNumItems; ++i) {
+      while (!queue.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  while (expected < kNumItems) {
+    int value = 0;
+    if (queue.Pop(value)) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  producer.join();
+  ASSERT_TRUE(queue.IsEmpty());
+}
@@ -2,11 +2,19 @@
 
 #include <SDL3/SDL.h>
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "formatted_text.hpp"
 #include "log.hpp"
+#include "lru_cache.hpp"
 #include "measured_text.hpp"
 
 namespace Symphony {
@@ -14,6 +22,56 @@ namespace Text {
 
 class TextRenderer {
  public:
+  struct RenderBuffers {
+    std::vector<float> original_ys;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+  };
+
+  struct Line {
+    int line_width{0};
+    int min_y{0};
+    int max_y{0};
+    int align_offset{0};
+    Wrapping wrapping{Wrapping::kClip};
+    std::unordered_map<Font*, RenderBuffers> font_to_buffers;
+  };
+
+  // What ReFormat produces, renderers share it through a LayoutCache.
+  struct Layout {
+    FormattedText formatted_text;
+    MeasuredText measured_text;
+    std::vector<Line> lines;
+    int content_height{0};
+    // Vertices of lines are built with this scroll.
+    int scroll_y{0};
+  };
+
+  // Everything a layout depends on. Fonts are kept alive by the key, so their
+  // pointers in the layout stay valid. Texts are compared by value, so
+  // renderers which load the same file share layouts. Their hashes are
+  // compared first, different texts rarely get further.
+  struct LayoutKey {
+    std::shared_ptr<const std::string> text;
+    size_t text_hash{0};
+    std::map<std::string, std::string> variables;
+    std::string default_font;
+    int x{0};
+    int y{0};
+    int width{0};
+    std::map<std::string, std::shared_ptr<Font>> fonts;
+
+    bool operator==(const LayoutKey& other) const {
+      return text_hash == other.text_hash &&
+             (text == other.text || *text == *other.text) &&
+             variables == other.variables &&
+             default_font == other.default_font && x == other.x &&
+             y == other.y && width == other.width && fonts == other.fonts;
+    }
+  };
+
+  using LayoutCache = LruCache<LayoutKey, std::shared_ptr<const Layout>>;
+
   TextRenderer() = default;
 
   explicit TextRenderer(std::shared_ptr<SDL_Renderer> sdl_renderer)
@@ -39,6 +97,19 @@ class TextRenderer {
 
   bool LoadFromFile(const std::string& file_path);
 
+  // Renderers with the same cache skip formatting and measuring when a text
+  // is shown again with the same values, fonts, position and width. The key
+  // is made on every ReFormat, so the cache suits texts which change rarely,
+  // such as texts of screens.
+  void SetLayoutCache(std::shared_ptr<LayoutCache> layout_cache) {
+    layout_cache_ = layout_cache;
+  }
+
+  // The text is parsed once and kept with slots for its variables. When only
+  // values of variables change, the values are replaced in place, and only
+  // paragraphs which have them are measured again and get new vertices.
+  // Lines below them get new vertices too, when line heights change. Does
+  // nothing when values are the same as the last time.
   void ReFormat(const std::map<std::string, std::string>& variables,
                 const std::string& default_font,
                 const std::map<std::string, std::shared_ptr<Font>>& fonts);
@@ -48,21 +119,6 @@ class TextRenderer {
   void Render(int scroll_y);
 
  private:
-  struct RenderBuffers {
-    std::vector<float> original_ys;
-    std::vector<SDL_Vertex> vertices;
-    std::vector<int> indices;
-  };
-
-  struct Line {
-    int line_width{0};
-    int min_y{0};
-    int max_y{0};
-    int align_offset{0};
-    Wrapping wrapping{Wrapping::kClip};
-    std::unordered_map<Font*, RenderBuffers> font_to_buffers;
-  };
-
   static SDL_FColor SdlColorFromUInt32(uint32_t color) {
     SDL_FColor sdl_color;
     sdl_color.a = (float)((color >> 24) & 0xFF) / 255.0f;
@@ -72,14 +128,50 @@ class TextRenderer {
     return sdl_color;
   }
 
+  // Formats and measures the text, or only its changed values, and builds
+  // vertices of lines.
+  void layOut(const std::map<std::string, std::string>& variables,
+              const std::string& default_font,
+              const std::map<std::string, std::shared_ptr<Font>>& fonts);
+  void applyLayout(const Layout& layout, const std::string& default_font);
+
+  // Returns false when the text should be formatted from scratch: it isn't
+  // formatted yet, fonts, position or sizes have changed, or a value is
+  // missing.
+  bool updateVariables(
+      const std::map<std::string, std::string>& variables,
+      const std::string& default_font,
+      const std::map<std::string, std::shared_ptr<Font>>& fonts);
+  // Builds vertices of lines from first_line_index to the end, lines above
+  // are kept.
+  void buildLines(size_t first_line_index);
+  // line_y: top of the line relative to the top of the text.
+  void buildLine(const MeasuredTextLine& measured_line, int line_y,
+                 Line& line);
+
   void updateVisibility(int scroll_y);
   void updateVisibleLinesPositions(int scroll_y);
 
   std::shared_ptr<SDL_Renderer> sdl_renderer_;
-  std::string raw_text_;
+  // Shared with the keys of layouts in the cache.
+  std::shared_ptr<const std::string> raw_text_{
+      std::make_shared<const std::string>()};
+  size_t raw_text_hash_{0};
+  std::shared_ptr<LayoutCache> layout_cache_;
+  // Layout from the cache which lines are copied from or into.
+  std::shared_ptr<const Layout> layout_;
   std::optional<FormattedText> formatted_text_;
   std::optional<MeasuredText> measured_text_;
   std::vector<Line> lines_;
+  // Default font, position and width the text was formatted with.
+  std::string formatted_default_font_;
+  int formatted_x_{0};
+  int formatted_y_{0};
+  int formatted_width_{0};
+  // Paragraphs which values have changed, in order.
+  std::vector<size_t> changed_paragraphs_;
+  // Changed paragraph is measured here first, keeps its capacity.
+  MeasuredText measured_paragraph_;
   int x_{0};
   int y_{0};
   int width_{0};
@@ -91,6 +183,8 @@ class TextRenderer {
   const bool draw_debug_{false};
 };
 
+using TextLayoutCache = TextRenderer::LayoutCache;
+
 bool TextRenderer::LoadFromFile(const std::string& file_path) {
   std::ifstream file;
 
@@ -104,10 +198,17 @@ bool TextRenderer::LoadFromFile(const std::string& file_path) {
   file.seekg(0, std::ios::end);
   size_t file_size = file.tellg();
 
-  raw_text_.resize(file_size);
+  std::string raw_text(file_size, '\0');
 
   file.seekg(0, std::ios::beg);
-  file.read(&raw_text_[0], file_size);
+  file.read(&raw_text[0], file_size);
+
+  raw_text_hash_ = std::hash<std::string>()(raw_text);
+  raw_text_ = std::make_shared<const std::string>(std::move(raw_text));
+
+  formatted_text_ = std::nullopt;
+  measured_text_ = std::nullopt;
+  layout_ = nullptr;
 
   return true;
 }
@@ -116,125 +217,216 @@ void TextRenderer::ReFormat(
     const std::map<std::string, std::string>& variables,
     const std::string& default_font,
     const std::map<std::string, std::shared_ptr<Font>>& fonts) {
+  if (!layout_cache_) {
+    layOut(variables, default_font, fonts);
+    return;
+  }
+
+  LayoutKey layout_key{.text = raw_text_,
+                       .text_hash = raw_text_hash_,
+                       .variables = variables,
+                       .default_font = default_font,
+                       .x = x_,
+                       .y = y_,
+                       .width = width_,
+                       .fonts = fonts};
+  if (const auto* layout = layout_cache_->Find(layout_key)) {
+    if (*layout != layout_) {
+      applyLayout(**layout, default_font);
+      layout_ = *layout;
+    }
+    return;
+  }
+
+  layOut(variables, default_font, fonts);
+  if (!formatted_text_.has_value()) {
+    layout_ = nullptr;
+    return;
+  }
+
+  layout_ = std::make_shared<const Layout>(
+      Layout{.formatted_text = formatted_text_.value(),
+             .measured_text = measured_text_.value(),
+             .lines = lines_,
+             .content_height = content_height_,
+             .scroll_y = prev_scroll_y_});
+  layout_cache_->Insert(std::move(layout_key), layout_);
+}
+
+void TextRenderer::layOut(
+    const std::map<std::string, std::string>& variables,
+    const std::string& default_font,
+    const std::map<std::string, std::shared_ptr<Font>>& fonts) {
+  if (updateVariables(variables, default_font, fonts)) {
+    return;
+  }
+
   Style default_style(default_font, /*color*/ 0xFFFFFFFF);
   ParagraphParameters default_paragraph_parameters(HorizontalAlignment::kLeft,
                                                    Wrapping::kClip);
-  formatted_text_ = FormatText(raw_text_, default_style,
+  formatted_text_ = FormatText(*raw_text_, default_style,
                                default_paragraph_parameters, variables);
   if (!formatted_text_.has_value()) {
     return;
   }
 
-  measured_text_ =
-      MeasureText(width_, formatted_text_.value(), variables, fonts);
+  // Measured text keeps its capacity from the last time.
   if (!measured_text_.has_value()) {
+    measured_text_.emplace();
+  }
+  if (!MeasureText(width_, formatted_text_.value(), fonts,
+                   measured_text_.value())) {
     formatted_text_ = std::nullopt;
+    measured_text_ = std::nullopt;
 
     return;
   }
 
+  formatted_default_font_ = default_font;
+  formatted_x_ = x_;
+  formatted_y_ = y_;
+  formatted_width_ = width_;
+
+  buildLines(0);
+}
+
+void TextRenderer::applyLayout(const Layout& layout,
+                               const std::string& default_font) {
+  formatted_text_ = layout.formatted_text;
+  measured_text_ = layout.measured_text;
+  lines_ = layout.lines;
+  content_height_ = layout.content_height;
+  // Render() moves vertices to its scroll.
+  prev_scroll_y_ = layout.scroll_y;
+
+  formatted_default_font_ = default_font;
+  formatted_x_ = x_;
+  formatted_y_ = y_;
+  formatted_width_ = width_;
+}
+
+bool TextRenderer::updateVariables(
+    const std::map<std::string, std::string>& variables,
+    const std::string& default_font,
+    const std::map<std::string, std::shared_ptr<Font>>& fonts) {
+  if (!formatted_text_.has_value() || !measured_text_.has_value()) {
+    return false;
+  }
+
+  if (default_font != formatted_default_font_ || x_ != formatted_x_ ||
+      y_ != formatted_y_ || width_ != formatted_width_ ||
+      fonts != measured_text_->fonts) {
+    return false;
+  }
+
+  FormattedText& formatted_text = formatted_text_.value();
+  std::vector<VariableSlot>& slots = formatted_text.variable_slots;
+
+  // Nothing is changed until all values are checked.
+  changed_paragraphs_.clear();
+  for (const auto& slot : slots) {
+    auto variable_it = variables.find(slot.variable_name);
+    if (variable_it == variables.end()) {
+      return false;
+    }
+
+    const std::string& text = formatted_text.paragraphs[slot.paragraph_index]
+                                  .style_runs[slot.style_run_index]
+                                  .text;
+    if (text.compare(slot.offset, slot.length, variable_it->second) != 0 &&
+        (changed_paragraphs_.empty() ||
+         changed_paragraphs_.back() != slot.paragraph_index)) {
+      changed_paragraphs_.push_back(slot.paragraph_index);
+    }
+  }
+
+  if (changed_paragraphs_.empty()) {
+    return true;
+  }
+
+  for (size_t i = 0; i < slots.size(); ++i) {
+    VariableSlot& slot = slots[i];
+    const std::string& value = variables.find(slot.variable_name)->second;
+    std::string& text = formatted_text.paragraphs[slot.paragraph_index]
+                            .style_runs[slot.style_run_index]
+                            .text;
+    if (text.compare(slot.offset, slot.length, value) == 0) {
+      continue;
+    }
+
+    text.replace(slot.offset, slot.length, value);
+    // Values after this one in the same style run move.
+    for (size_t j = i + 1; j < slots.size() &&
+                           slots[j].paragraph_index == slot.paragraph_index &&
+                           slots[j].style_run_index == slot.style_run_index;
+         ++j) {
+      slots[j].offset = slots[j].offset + value.size() - slot.length;
+    }
+    slot.length = value.size();
+  }
+
   MeasuredText& measured_text = measured_text_.value();
 
-  lines_.resize(measured_text.measured_lines.size());
+  // Lines from this one down move, when heights of lines change.
+  size_t first_moved_line_index = lines_.size();
+  // First line of the paragraph.
+  size_t line_index = 0;
+  size_t paragraph_index = 0;
+  for (size_t changed_paragraph_index : changed_paragraphs_) {
+    for (; paragraph_index < changed_paragraph_index; ++paragraph_index) {
+      line_index += measured_text.paragraph_num_lines[paragraph_index];
+    }
 
-  int line_y = 0;
-  float line_y_f = 0;
-  for (auto measured_lines_it = measured_text.measured_lines.begin();
-       auto& line : lines_) {
-    const MeasuredTextLine& measured_line = *measured_lines_it;
-    line.line_width = measured_line.line_width;
-    line.align_offset = measured_line.align_offset;
-    line.wrapping = measured_line.wrapping;
+    measured_paragraph_.Clear();
+    if (!MeasureParagraph(width_, formatted_text.paragraphs[paragraph_index],
+                          paragraph_index, fonts, measured_paragraph_)) {
+      formatted_text_ = std::nullopt;
+      measured_text_ = std::nullopt;
 
-    float align_offset = static_cast<float>(measured_line.align_offset);
+      return true;
+    }
 
-    for (const auto& [font, glyph_ptrs] : measured_line.font_to_glyph) {
-      auto p =
-          line.font_to_buffers.insert(std::make_pair(font, RenderBuffers()));
-      auto& render_buffers = p.first->second;
+    const auto& new_lines = measured_paragraph_.measured_lines;
+    size_t num_old_lines = measured_text.paragraph_num_lines[paragraph_index];
+    size_t num_new_lines = new_lines.size();
+    bool keeps_heights = num_new_lines == num_old_lines;
+    for (size_t i = 0; keeps_heights && i < num_new_lines; ++i) {
+      keeps_heights = new_lines[i].line_height ==
+                      measured_text.measured_lines[line_index + i].line_height;
+    }
 
-      SDL_Texture* sdl_texture = (SDL_Texture*)font->GetTexture();
-      if (!sdl_texture) {
-        continue;
-      }
+    ReplaceMeasuredParagraph(measured_text, paragraph_index,
+                             measured_paragraph_);
 
-      int texture_width = sdl_texture->w;
-      int texture_height = sdl_texture->h;
-      float texture_width_scale = 1.0f / (float)texture_width;
-      float texture_height_scale = 1.0f / (float)texture_height;
-
-      (void)texture_width_scale;
-      (void)texture_height_scale;
-
-      render_buffers.original_ys.resize(glyph_ptrs.size());
-      render_buffers.vertices.resize(glyph_ptrs.size() * 4);
-      render_buffers.indices.resize(glyph_ptrs.size() * 6);
-      for (size_t num_glyphs_processed = 0; auto glyph_ptr : glyph_ptrs) {
-        const auto& measured_glyph = *glyph_ptr;
-        const auto& glyph = measured_glyph.glyph;
-
-        SDL_FColor sdl_color = SdlColorFromUInt32(measured_glyph.color);
-
-        float glyph_x = x_ + align_offset + (float)measured_glyph.x;
-        float glyph_y = y_ + line_y_f + (float)measured_glyph.y;
-        render_buffers.original_ys[num_glyphs_processed] = glyph_y;
-
-        SDL_Vertex* vertex =
-            &render_buffers.vertices[num_glyphs_processed * 4 + 0];
-        vertex->position.x = glyph_x;
-        vertex->position.y = glyph_y;
-        vertex->color = sdl_color;
-        vertex->tex_coord.x = (float)glyph.texture_x * texture_width_scale;
-        vertex->tex_coord.y = (float)glyph.texture_y * texture_height_scale;
-
-        vertex = &render_buffers.vertices[num_glyphs_processed * 4 + 1];
-        vertex->position.x = glyph_x;
-        vertex->position.y = glyph_y + (float)glyph.texture_height;
-        vertex->color = sdl_color;
-        vertex->tex_coord.x = (float)glyph.texture_x * texture_width_scale;
-        vertex->tex_coord.y = (float)(glyph.texture_y + glyph.texture_height) *
-                              texture_height_scale;
-
-        vertex = &render_buffers.vertices[num_glyphs_processed * 4 + 2];
-        vertex->position.x = glyph_x + (float)glyph.texture_width;
-        vertex->position.y = glyph_y + (float)glyph.texture_height;
-        vertex->color = sdl_color;
-        vertex->tex_coord.x = (float)(glyph.texture_x + glyph.texture_width) *
-                              texture_width_scale;
-        vertex->tex_coord.y = (float)(glyph.texture_y + glyph.texture_height) *
-                              texture_height_scale;
-
-        vertex = &render_buffers.vertices[num_glyphs_processed * 4 + 3];
-        vertex->position.x = glyph_x + (float)glyph.texture_width;
-        vertex->position.y = glyph_y;
-        vertex->color = sdl_color;
-        vertex->tex_coord.x = (float)(glyph.texture_x + glyph.texture_width) *
-                              texture_width_scale;
-        vertex->tex_coord.y = (float)(glyph.texture_y) * texture_height_scale;
-
-        render_buffers.indices[num_glyphs_processed * 6 + 0] =
-            num_glyphs_processed * 4 + 0;
-        render_buffers.indices[num_glyphs_processed * 6 + 1] =
-            num_glyphs_processed * 4 + 2;
-        render_buffers.indices[num_glyphs_processed * 6 + 2] =
-            num_glyphs_processed * 4 + 1;
-        render_buffers.indices[num_glyphs_processed * 6 + 3] =
-            num_glyphs_processed * 4 + 0;
-        render_buffers.indices[num_glyphs_processed * 6 + 4] =
-            num_glyphs_processed * 4 + 3;
-        render_buffers.indices[num_glyphs_processed * 6 + 5] =
-            num_glyphs_processed * 4 + 2;
-
-        ++num_glyphs_processed;
+    if (!keeps_heights) {
+      first_moved_line_index = std::min(first_moved_line_index, line_index);
+    } else if (line_index < first_moved_line_index) {
+      for (size_t i = line_index; i < line_index + num_new_lines; ++i) {
+        buildLine(measured_text.measured_lines[i], lines_[i].min_y - y_,
+                  lines_[i]);
       }
     }
+  }
 
-    line.min_y = y_ + line_y;
-    line.max_y = y_ + line_y + measured_line.line_height;
-    line_y += measured_line.line_height;
-    line_y_f += (float)measured_line.line_height;
+  if (first_moved_line_index < lines_.size()) {
+    buildLines(first_moved_line_index);
+  }
 
-    ++measured_lines_it;
+  return true;
+}
+
+void TextRenderer::buildLines(size_t first_line_index) {
+  MeasuredText& measured_text = measured_text_.value();
+
+  lines_.resize(measured_text.measured_lines.size());
+
+  int line_y = first_line_index ? lines_[first_line_index - 1].max_y - y_ : 0;
+  for (size_t line_index = first_line_index; line_index < lines_.size();
+       ++line_index) {
+    const MeasuredTextLine& measured_line =
+        measured_text.measured_lines[line_index];
+    buildLine(measured_line, line_y, lines_[line_index]);
+    line_y += measured_line.line_height;
   }
 
   content_height_ = 0;
@@ -243,6 +435,112 @@ void TextRenderer::ReFormat(
   }
 }
 
+void TextRenderer::buildLine(const MeasuredTextLine& measured_line,
+                             int line_y, Line& line) {
+  line.line_width = measured_line.line_width;
+  line.align_offset = measured_line.align_offset;
+  line.wrapping = measured_line.wrapping;
+
+  // Buffers of fonts which are no longer in the line stay empty.
+  for (auto& [font, render_buffers] : line.font_to_buffers) {
+    render_buffers.original_ys.clear();
+    render_buffers.vertices.clear();
+    render_buffers.indices.clear();
+  }
+
+  float align_offset = static_cast<float>(measured_line.align_offset);
+  float line_y_f = static_cast<float>(line_y);
+  // Vertices are kept scrolled, see updateVisibleLinesPositions().
+  float scroll_y = static_cast<float>(prev_scroll_y_);
+
+  const MeasuredText& measured_text = measured_text_.value();
+  for (const auto& font_range : measured_text.GetFontRanges(measured_line)) {
+    Font* font = font_range.font;
+    auto p =
+        line.font_to_buffers.insert(std::make_pair(font, RenderBuffers()));
+    auto& render_buffers = p.first->second;
+
+    SDL_Texture* sdl_texture = (SDL_Texture*)font->GetTexture();
+    if (!sdl_texture) {
+      continue;
+    }
+
+    int texture_width = sdl_texture->w;
+    int texture_height = sdl_texture->h;
+    float texture_width_scale = 1.0f / (float)texture_width;
+    float texture_height_scale = 1.0f / (float)texture_height;
+
+    render_buffers.original_ys.resize(font_range.count);
+    render_buffers.vertices.resize(font_range.count * 4);
+    render_buffers.indices.resize(font_range.count * 6);
+    size_t num_glyphs_processed = 0;
+    while (num_glyphs_processed < font_range.count) {
+      uint32_t glyph_index =
+          measured_text.font_glyphs[font_range.first + num_glyphs_processed];
+      const auto& measured_glyph = measured_text.glyphs[glyph_index];
+      const auto& glyph = measured_glyph.glyph;
+
+      SDL_FColor sdl_color = SdlColorFromUInt32(measured_glyph.color);
+
+      float glyph_x = x_ + align_offset + (float)measured_glyph.x;
+      float glyph_y = y_ + line_y_f + (float)measured_glyph.y;
+      render_buffers.original_ys[num_glyphs_processed] = glyph_y;
+      glyph_y += scroll_y;
+
+      SDL_Vertex* vertex =
+          &render_buffers.vertices[num_glyphs_processed * 4 + 0];
+      vertex->position.x = glyph_x;
+      vertex->position.y = glyph_y;
+      vertex->color = sdl_color;
+      vertex->tex_coord.x = (float)glyph.texture_x * texture_width_scale;
+      vertex->tex_coord.y = (float)glyph.texture_y * texture_height_scale;
+
+      vertex = &render_buffers.vertices[num_glyphs_processed * 4 + 1];
+      vertex->position.x = glyph_x;
+      vertex->position.y = glyph_y + (float)glyph.texture_height;
+      vertex->color = sdl_color;
+      vertex->tex_coord.x = (float)glyph.texture_x * texture_width_scale;
+      vertex->tex_coord.y = (float)(glyph.texture_y + glyph.texture_height) *
+                            texture_height_scale;
+
+      vertex = &render_buffers.vertices[num_glyphs_processed * 4 + 2];
+      vertex->position.x = glyph_x + (float)glyph.texture_width;
+      vertex->position.y = glyph_y + (float)glyph.texture_height;
+      vertex->color = sdl_color;
+      vertex->tex_coord.x = (float)(glyph.texture_x + glyph.texture_width) *
+                            texture_width_scale;
+      vertex->tex_coord.y = (float)(glyph.texture_y + glyph.texture_height) *
+                            texture_height_scale;
+
+      vertex = &render_buffers.vertices[num_glyphs_processed * 4 + 3];
+      vertex->position.x = glyph_x + (float)glyph.texture_width;
+      vertex->position.y = glyph_y;
+      vertex->color = sdl_color;
+      vertex->tex_coord.x = (float)(glyph.texture_x + glyph.texture_width) *
+                            texture_width_scale;
+      vertex->tex_coord.y = (float)(glyph.texture_y) * texture_height_scale;
+
+      render_buffers.indices[num_glyphs_processed * 6 + 0] =
+          num_glyphs_processed * 4 + 0;
+      render_buffers.indices[num_glyphs_processed * 6 + 1] =
+          num_glyphs_processed * 4 + 2;
+      render_buffers.indices[num_glyphs_processed * 6 + 2] =
+          num_glyphs_processed * 4 + 1;
+      render_buffers.indices[num_glyphs_processed * 6 + 3] =
+          num_glyphs_processed * 4 + 0;
+      render_buffers.indices[num_glyphs_processed * 6 + 4] =
+          num_glyphs_processed * 4 + 3;
+      render_buffers.indices[num_glyphs_processed * 6 + 5] =
+          num_glyphs_processed * 4 + 2;
+
+      ++num_glyphs_processed;
+    }
+  }
+
+  line.min_y = y_ + line_y;
+  line.max_y = y_ + line_y + measured_line.line_height;
+}
+
 void TextRenderer::Render(int scroll_y) {
   if (!formatted_text_.has_value()) {
     return;
@@ -302,6 +600,10 @@ void TextRenderer::Render(int scroll_y) {
     }
 
     for (auto& [font, buffers] : line.font_to_buffers) {
+      if (buffers.vertices.empty()) {
+        continue;
+      }
+
       SDL_Texture* sdl_texture = (SDL_Texture*)font->GetTexture();
       SDL_SetTextureBlendMode(sdl_texture, SDL_BLENDMODE_BLEND);
 
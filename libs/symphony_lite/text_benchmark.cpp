@@ -0,0 +1,142 @@
+// Measures word wrapped story text and reports how long it takes per glyph.
+//
+// Usage: text_benchmark [num_kilobytes] [num_measures]
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "measured_text.hpp"
+
+using namespace Symphony::Text;
+
+namespace {
+inline constexpr size_t kDefaultNumKilobytes = 60;
+inline constexpr size_t kDefaultNumMeasures = 32;
+inline constexpr int kContainerWidth = 480;
+
+// Glyphs of different widths, as in a proportional font.
+class BenchmarkFont : public Font {
+ public:
+  FontMeasurements GetFontMeasurements() const override {
+    FontMeasurements result;
+    result.line_height = 24;
+    result.base = 20;
+    return result;
+  }
+
+  Glyph GetGlyph(uint32_t code_position) const override {
+    int width = 6 + (int)(code_position % 7);
+
+    Glyph result;
+    result.texture_x = 0;
+    result.texture_y = 0;
+    result.texture_width = width;
+    result.texture_height = 24;
+    result.x_offset = 1;
+    result.y_offset = 0;
+    result.x_advance = width + 1;
+    result.code_position = code_position;
+    return result;
+  }
+
+  void* GetTexture() override { return nullptr; }
+};
+
+// Same glyphs, with ASCII ones in a table as BmFont has them.
+class AsciiTableBenchmarkFont : public BenchmarkFont {
+ public:
+  AsciiTableBenchmarkFont() {
+    for (uint32_t code_position = 0; code_position < 128; ++code_position) {
+      ascii_glyphs_[code_position] = GetGlyph(code_position);
+    }
+  }
+
+  const Glyph* GetAsciiGlyphs() const override { return ascii_glyphs_; }
+
+ private:
+  Glyph ascii_glyphs_[128];
+};
+
+// Measures the text num_measures times and returns the total time.
+bool Measure(const FormattedText& formatted_text, std::shared_ptr<Font> font,
+             size_t num_measures, MeasuredText& measured_text,
+             double& num_ns) {
+  std::map<std::string, std::shared_ptr<Font>> fonts{{"story", font}};
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_measures; ++i) {
+    if (!MeasureText(kContainerWidth, formatted_text, fonts, measured_text)) {
+      return false;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  num_ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+                                                                        start)
+               .count();
+  return true;
+}
+
+// Paragraphs of story text, the last one is long and has long words.
+std::string MakeStory(size_t num_kilobytes) {
+  static const char* const kSentences[] = {
+      "The ship came down over the city at night. ",
+      "Nobody in the market looked up, they were busy counting their coins. ",
+      "Interplanetary-trade-commission-approved cargo was loaded. ",
+      "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, "
+      "\xd0\xb7\xd0\xb5\xd0\xbc\xd0\xbb\xd1\x8f\xd0\xbd\xd0\xb5! ",
+  };
+
+  std::string result;
+  size_t num_bytes = num_kilobytes * 1024;
+  for (size_t i = 0; result.size() < num_bytes; ++i) {
+    result += kSentences[i % std::size(kSentences)];
+    if (i % 16 == 15 && result.size() < num_bytes / 2) {
+      result += "\n";
+    }
+  }
+  return result;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t num_kilobytes =
+      argc > 1 ? (size_t)atoi(argv[1]) : kDefaultNumKilobytes;
+  size_t num_measures = argc > 2 ? (size_t)atoi(argv[2]) : kDefaultNumMeasures;
+
+  auto formatted_text = FormatText(
+      MakeStory(num_kilobytes), Style("story", 0xFFFFFFFF),
+      ParagraphParameters(HorizontalAlignment::kLeft, Wrapping::kWordWrap), {});
+  if (!formatted_text.has_value()) {
+    std::cout << "Can't format the story" << std::endl;
+    return 1;
+  }
+
+  MeasuredText measured_text;
+  double font_ns = 0.0;
+  double table_ns = 0.0;
+  if (!Measure(formatted_text.value(), std::make_shared<BenchmarkFont>(),
+               num_measures, measured_text, font_ns) ||
+      !Measure(formatted_text.value(),
+               std::make_shared<AsciiTableBenchmarkFont>(), num_measures,
+               measured_text, table_ns)) {
+    std::cout << "Can't measure the story" << std::endl;
+    return 1;
+  }
+
+  size_t num_glyphs = measured_text.glyphs.size();
+  std::cout << "Measured " << num_kilobytes << " KB in "
+            << measured_text.paragraph_num_lines.size() << " paragraphs, "
+            << measured_text.measured_lines.size() << " lines, " << num_glyphs
+            << " glyphs" << std::endl;
+  std::cout << "ms per measure: " << font_ns / (double)num_measures / 1e6
+            << ", ns per glyph: "
+            << font_ns / (double)(num_measures * num_glyphs)
+            << ", with ASCII table: "
+            << table_ns / (double)(num_measures * num_glyphs) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,26 @@
+#include "text.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+using namespace Symphony::Text;
+
+TEST(TextLayoutCache, ComparesTextsByValue) {
+  TextRenderer::LayoutKey key;
+  key.text = std::make_shared<const std::string>("Credits: {credits}");
+  key.text_hash = 1;
+  key.variables = {{"credits", "10"}};
+  key.default_font = "main";
+  TextRenderer::LayoutKey same_text = key;
+  same_text.text = std::make_shared<const std::string>("Credits: {credits}");
+  // Same hash as if the texts collided.
+  TextRenderer::LayoutKey colliding_text = key;
+  colliding_text.text = std::make_shared<const std::string>("Price: {credits}");
+
+  TextLayoutCache cache(/*max_num_items*/ 4);
+  cache.Insert(key, nullptr);
+  EXPECT_NE(cache.Find(same_text), nullptr);
+  EXPECT_EQ(cache.Find(colliding_text), nullptr);
+}
@@ -1,11 +1,28 @@
 #pragma once
 
+#if !defined(__PSP__) && !defined(__EMSCRIPTEN__) && \
+    (defined(__unix__) || defined(__APPLE__))
+#define SYMPHONY_AUDIO_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "adpcm.hpp"
+#include "resampler.hpp"
+
 namespace Symphony {
 namespace {
 struct FourCC {
@@ -26,6 +43,18 @@ size_t GetValue32(const uint8_t bytes[]) {
   return (s0 << 0) + (s1 << 8) + (s2 << 16) + (s3 << 24);
 }
 
+void SetValue16(uint8_t bytes[], size_t value) {
+  bytes[0] = (uint8_t)(value & 0xFF);
+  bytes[1] = (uint8_t)((value >> 8) & 0xFF);
+}
+
+void SetValue32(uint8_t bytes[], size_t value) {
+  bytes[0] = (uint8_t)(value & 0xFF);
+  bytes[1] = (uint8_t)((value >> 8) & 0xFF);
+  bytes[2] = (uint8_t)((value >> 16) & 0xFF);
+  bytes[3] = (uint8_t)((value >> 24) & 0xFF);
+}
+
 struct RiffChunkHeader {
   FourCC four_cc;
   uint8_t chunk_size[4];
@@ -52,8 +81,18 @@ struct RiffChunkHeader {
 namespace Audio {
 enum WaveFormatCategory {
   kWaveFormatPcm = 1,
+  kWaveFormatMsAdpcm = 2,
+  kWaveFormatImaAdpcm = 0x11,
 };
 
+// Block of 1017 samples takes 512 bytes for mono, 1024 bytes for stereo.
+inline constexpr size_t kImaAdpcmDefaultSamplesPerBlock = 1017;
+
+// Compressed files loaded to memory which are at most this long are decoded
+// once by WaveFile::Load(). Decoded, they take no more than the ring which
+// every play of them would need otherwise, see WavePrefetcher.
+inline constexpr size_t kMaxDecodedAdpcmBlocks = 16384;
+
 struct WaveFormatCommonFields {
   uint8_t format_category[2];
   uint8_t channels[2];
@@ -83,12 +122,26 @@ class WaveFile {
   enum Mode {
     kModeStreamingFromFile = 1,
     kModeLoadInMemory = 2,
+    // Wave data is used straight from the mapped file, pages are loaded by
+    // OS on demand. Falls back to kModeStreamingFromFile on platforms without
+    // mmap.
+    kModeMemoryMapped = 3,
   };
 
   WaveFile() = default;
   WaveFile(std::string& file_path, Mode mode) { Load(file_path, mode); }
 
-  bool Load(const std::string& file_path, Mode mode);
+  WaveFile(const WaveFile&) = delete;
+  WaveFile& operator=(const WaveFile&) = delete;
+
+  ~WaveFile();
+
+  // sample_rate: when not 0 and the file has another rate, samples are
+  // converted to sample_rate and kept in memory as 16-bit PCM, whatever the
+  // mode is. Mixer plays samples at the rate of the device, so it never has to
+  // resample. Short compressed files are kept as 16-bit PCM too, when loaded
+  // to memory, see kMaxDecodedAdpcmBlocks.
+  bool Load(const std::string& file_path, Mode mode, size_t sample_rate = 0);
 
   const std::string& GetFilePath() const { return file_path_; }
 
@@ -97,9 +150,11 @@ class WaveFile {
   }
   const WaveFormatPCMFields& GetFormatPCMFields() const { return format_pcm_; }
 
-  size_t GetNumBlocks() const { return wave_data_size_ / GetBlockSize(); }
+  // Block is a 16-bit sample for each channel, after decoding if wave data is
+  // compressed.
+  size_t GetNumBlocks() const { return num_blocks_; }
 
-  size_t GetBlockSize() const { return format_common_.GetBlockAlign(); }
+  size_t GetBlockSize() const { return GetNumChannels() * sizeof(int16_t); }
 
   size_t GetNumChannels() const { return format_common_.GetNumChannels(); }
 
@@ -109,26 +164,74 @@ class WaveFile {
     return (float)GetNumBlocks() / (float)format_common_.GetSampleRate();
   }
 
+  bool IsCompressed() const {
+    return format_common_.GetFormatCategory() != kWaveFormatPcm;
+  }
+  // Samples can be used straight with GetBufferWhenInMemory(). Compressed wave
+  // data is never in memory in this sense, it should be read with
+  // ReadBlocks(), unless Load() has decoded it.
   bool IsInMemory() const;
+  bool IsMemoryMapped() const { return mapping_ != nullptr; }
+  bool IsStreamingFromFile() const { return data_in_memory_ == nullptr; }
+  // Bytes of wave data loaded to memory. Mapped files and streams don't hold
+  // any: OS pages mapped files in and out.
+  size_t GetSizeInMemory() const { return wave_data_.size(); }
+  // Converted from another sample rate by Load().
+  bool IsResampled() const { return is_resampled_; }
   void ReadBlocks(size_t first_block, size_t num_blocks, int16_t* blocks_out);
+  // Same, but reads with the given file, when streaming from file. Allows
+  // reading from several threads, each with its own file.
+  bool ReadBlocks(std::ifstream& file, size_t first_block, size_t num_blocks,
+                  int16_t* blocks_out) const;
   const int16_t* GetBufferWhenInMemory(size_t first_block) const;
 
  private:
   void convertToFloat(const std::vector<char>& samples_in,
                       float* samples_out) const;
 
+  bool readFormatExtension(const std::vector<uint8_t>& extension);
+  bool readAdpcmBlocks(std::ifstream& file, size_t first_block,
+                       size_t num_blocks, int16_t* blocks_out) const;
+  bool mapFile();
+  void unmapFile();
+  bool resample(size_t sample_rate);
+  bool decode();
+  // Replaces wave data with 16-bit PCM blocks.
+  void setPcmInMemory(std::vector<uint8_t> blocks, size_t num_blocks,
+                      size_t sample_rate);
+
   std::string file_path_;
   std::ifstream file_;
   WaveFormatCommonFields format_common_;
   WaveFormatPCMFields format_pcm_;
   size_t wave_data_offset_{0};
   size_t wave_data_size_{0};
-  std::vector<int16_t> wave_data_;
+  size_t num_blocks_{0};
+  size_t adpcm_samples_per_block_{0};
+  std::vector<int16_t> ms_adpcm_coefficients_;
+  std::vector<uint8_t> wave_data_;
+  void* mapping_{nullptr};
+  size_t mapping_size_{0};
+  // Points either to wave_data_ or to the mapping.
+  const uint8_t* data_in_memory_{nullptr};
+  bool is_resampled_{false};
 };
 
-bool WaveFile::Load(const std::string& file_path, WaveFile::Mode mode) {
+WaveFile::~WaveFile() { unmapFile(); }
+
+bool WaveFile::Load(const std::string& file_path, WaveFile::Mode mode,
+                    size_t sample_rate) {
   file_path_ = file_path;
 
+  unmapFile();
+  wave_data_.clear();
+  data_in_memory_ = nullptr;
+  is_resampled_ = false;
+  num_blocks_ = 0;
+  adpcm_samples_per_block_ = 0;
+  ms_adpcm_coefficients_.clear();
+  size_t num_samples_in_fact = 0;
+
   std::ifstream file;
 
   file.open(file_path, std::ios::binary);
@@ -184,7 +287,10 @@ bool WaveFile::Load(const std::string& file_path, WaveFile::Mode mode) {
       file.read((char*)&format_common_, sizeof(WaveFormatCommonFields));
       fmt_bytes_read += sizeof(WaveFormatCommonFields);
 
-      if (format_common_.GetFormatCategory() != kWaveFormatPcm) {
+      size_t format_category = format_common_.GetFormatCategory();
+      if (format_category != kWaveFormatPcm &&
+          format_category != kWaveFormatImaAdpcm &&
+          format_category != kWaveFormatMsAdpcm) {
         std::cerr << "[Symphony::Audio::WaveFile] Format is not supported, "
                      "file_path: "
                   << file_path << std::endl;
@@ -194,17 +300,28 @@ bool WaveFile::Load(const std::string& file_path, WaveFile::Mode mode) {
       file.read((char*)&format_pcm_, sizeof(WaveFormatPCMFields));
       fmt_bytes_read += sizeof(WaveFormatPCMFields);
 
+      std::vector<uint8_t> extension;
       if (fmt_bytes_read < chunk.GetSize()) {
-        file.seekg(chunk.GetSize() - fmt_bytes_read, std::ios::cur);
+        extension.resize(chunk.GetSize() - fmt_bytes_read);
+        file.read((char*)extension.data(), extension.size());
       }
 
-      if (format_pcm_.GetBitsPerSample() != 16) {
+      if (format_category == kWaveFormatPcm &&
+          format_pcm_.GetBitsPerSample() != 16) {
         std::cerr << "[Symphony::Audio::WaveFile] Only 16 bits per "
                      "sample formats are supported, file_path: "
                   << file_path << std::endl;
         return false;
       }
 
+      if (format_category != kWaveFormatPcm &&
+          !readFormatExtension(extension)) {
+        std::cerr << "[Symphony::Audio::WaveFile] Only 4 bits per sample "
+                     "mono or stereo ADPCM is supported, file_path: "
+                  << file_path << std::endl;
+        return false;
+      }
+
       format_read = true;
     } else if (chunk.TestChunk("data")) {
       if (!format_read) {
@@ -220,6 +337,11 @@ bool WaveFile::Load(const std::string& file_path, WaveFile::Mode mode) {
       file.seekg(chunk.GetSize(), std::ios::cur);
 
       wave_data_read = true;
+    } else if (chunk.TestChunk("fact") && chunk.GetSize() >= 4) {
+      uint8_t num_samples[4];
+      file.read((char*)num_samples, 4);
+      num_samples_in_fact = GetValue32(num_samples);
+      file.seekg(chunk.GetSize() - 4, std::ios::cur);
     } else {
       file.seekg(chunk.GetSize(), std::ios::cur);
     }
@@ -241,44 +363,450 @@ bool WaveFile::Load(const std::string& file_path, WaveFile::Mode mode) {
     return false;
   }
 
+  if (!IsCompressed()) {
+    num_blocks_ = wave_data_size_ / format_common_.GetBlockAlign();
+  } else {
+    size_t adpcm_block_size = format_common_.GetBlockAlign();
+    num_blocks_ =
+        wave_data_size_ / adpcm_block_size * adpcm_samples_per_block_;
+    size_t last_block_size = wave_data_size_ % adpcm_block_size;
+    if (last_block_size) {
+      num_blocks_ += format_common_.GetFormatCategory() == kWaveFormatImaAdpcm
+                         ? GetImaAdpcmSamplesPerBlock(last_block_size,
+                                                      GetNumChannels())
+                         : GetMsAdpcmSamplesPerBlock(last_block_size,
+                                                     GetNumChannels());
+    }
+    // Last block is padded, fact chunk tells how many samples are there.
+    if (num_samples_in_fact && num_samples_in_fact < num_blocks_) {
+      num_blocks_ = num_samples_in_fact;
+    }
+  }
+
   if (mode == kModeLoadInMemory) {
-    wave_data_.resize(GetNumBlocks() * GetNumChannels());
+    wave_data_.resize(wave_data_size_);
 
     file.seekg(wave_data_offset_, std::ios::beg);
-    file.read((char*)&wave_data_[0], wave_data_size_);
+    file.read((char*)wave_data_.data(), wave_data_size_);
+    data_in_memory_ = wave_data_.data();
+  } else if (mode == kModeMemoryMapped && mapFile()) {
+    // Done.
   } else {
     file_ = std::move(file);
   }
 
+  if (sample_rate && sample_rate != GetSampleRate()) {
+    return resample(sample_rate);
+  }
+
+  if (mode == kModeLoadInMemory && IsCompressed() &&
+      num_blocks_ <= kMaxDecodedAdpcmBlocks) {
+    return decode();
+  }
+
   return true;
 }
 
-bool WaveFile::IsInMemory() const { return !wave_data_.empty(); }
+bool WaveFile::IsInMemory() const {
+  return data_in_memory_ != nullptr && !IsCompressed();
+}
 
 void WaveFile::ReadBlocks(size_t first_block, size_t num_blocks,
                           int16_t* blocks_out) {
+  ReadBlocks(file_, first_block, num_blocks, blocks_out);
+}
+
+bool WaveFile::ReadBlocks(std::ifstream& file, size_t first_block,
+                          size_t num_blocks, int16_t* blocks_out) const {
+  if (IsCompressed()) {
+    return readAdpcmBlocks(file, first_block, num_blocks, blocks_out);
+  }
+
   size_t block_size = GetBlockSize();
-  if (!wave_data_.empty()) {
-    memcpy(blocks_out, &wave_data_[first_block * GetNumChannels()],
+  if (IsInMemory()) {
+    memcpy(blocks_out, GetBufferWhenInMemory(first_block),
            num_blocks * block_size);
-  } else {
-    file_.seekg(wave_data_offset_ + first_block * block_size, std::ios::beg);
-    file_.read((char*)blocks_out, num_blocks * block_size);
+    return true;
   }
+
+  file.seekg(wave_data_offset_ + first_block * block_size, std::ios::beg);
+  file.read((char*)blocks_out, num_blocks * block_size);
+  return file.good();
 }
 
 const int16_t* WaveFile::GetBufferWhenInMemory(size_t first_block) const {
-  return &wave_data_[first_block * GetNumChannels()];
+  return (const int16_t*)data_in_memory_ + first_block * GetNumChannels();
+}
+
+bool WaveFile::readFormatExtension(const std::vector<uint8_t>& extension) {
+  size_t num_channels = GetNumChannels();
+  size_t adpcm_block_size = format_common_.GetBlockAlign();
+  if (format_pcm_.GetBitsPerSample() != 4 || num_channels < 1 ||
+      num_channels > 2 || !adpcm_block_size) {
+    return false;
+  }
+
+  // Extension: size of extension, samples per block, then MS ADPCM
+  // coefficients.
+  size_t samples_per_block = extension.size() >= 4
+                                 ? GetValue16(&extension[2])
+                                 : 0;
+
+  if (format_common_.GetFormatCategory() == kWaveFormatImaAdpcm) {
+    size_t max_samples_per_block =
+        GetImaAdpcmSamplesPerBlock(adpcm_block_size, num_channels);
+    adpcm_samples_per_block_ =
+        samples_per_block ? std::min(samples_per_block, max_samples_per_block)
+                          : max_samples_per_block;
+  } else {
+    size_t max_samples_per_block =
+        GetMsAdpcmSamplesPerBlock(adpcm_block_size, num_channels);
+    adpcm_samples_per_block_ =
+        samples_per_block ? std::min(samples_per_block, max_samples_per_block)
+                          : max_samples_per_block;
+
+    size_t num_coefficients =
+        extension.size() >= 6 ? GetValue16(&extension[4]) : 0;
+    if (num_coefficients && extension.size() >= 6 + num_coefficients * 4) {
+      for (size_t i = 0; i < num_coefficients * 2; ++i) {
+        ms_adpcm_coefficients_.push_back(
+            (int16_t)GetValue16(&extension[6 + i * 2]));
+      }
+    } else {
+      ms_adpcm_coefficients_ = GetMsAdpcmStandardCoefficients();
+    }
+  }
+
+  return adpcm_samples_per_block_ > 0;
+}
+
+bool WaveFile::readAdpcmBlocks(std::ifstream& file, size_t first_block,
+                               size_t num_blocks,
+                               int16_t* blocks_out) const {
+  size_t num_channels = GetNumChannels();
+  size_t adpcm_block_size = format_common_.GetBlockAlign();
+  std::vector<uint8_t> adpcm_block;
+  std::vector<int16_t> decoded(adpcm_samples_per_block_ * num_channels);
+
+  while (num_blocks) {
+    // Decodes whole ADPCM blocks, takes needed part of each.
+    size_t adpcm_block_index = first_block / adpcm_samples_per_block_;
+    size_t first_sample = first_block % adpcm_samples_per_block_;
+    size_t adpcm_block_offset = adpcm_block_index * adpcm_block_size;
+    if (adpcm_block_offset >= wave_data_size_) {
+      return false;
+    }
+    size_t cur_adpcm_block_size =
+        std::min(adpcm_block_size, wave_data_size_ - adpcm_block_offset);
+
+    const uint8_t* adpcm_block_data = nullptr;
+    if (data_in_memory_) {
+      adpcm_block_data = data_in_memory_ + adpcm_block_offset;
+    } else {
+      adpcm_block.resize(cur_adpcm_block_size);
+      file.seekg(wave_data_offset_ + adpcm_block_offset, std::ios::beg);
+      file.read((char*)adpcm_block.data(), cur_adpcm_block_size);
+      if (!file.good()) {
+        return false;
+      }
+      adpcm_block_data = adpcm_block.data();
+    }
+
+    size_t num_samples_decoded = 0;
+    if (format_common_.GetFormatCategory() == kWaveFormatImaAdpcm) {
+      num_samples_decoded = DecodeImaAdpcmBlock(
+          adpcm_block_data, cur_adpcm_block_size, num_channels,
+          adpcm_samples_per_block_, decoded.data());
+    } else {
+      num_samples_decoded = DecodeMsAdpcmBlock(
+          adpcm_block_data, cur_adpcm_block_size, num_channels,
+          adpcm_samples_per_block_, ms_adpcm_coefficients_, decoded.data());
+    }
+    if (num_samples_decoded <= first_sample) {
+      return false;
+    }
+
+    size_t num_samples_to_copy =
+        std::min(num_blocks, num_samples_decoded - first_sample);
+    memcpy(blocks_out, &decoded[first_sample * num_channels],
+           num_samples_to_copy * num_channels * sizeof(int16_t));
+
+    blocks_out += num_samples_to_copy * num_channels;
+    first_block += num_samples_to_copy;
+    num_blocks -= num_samples_to_copy;
+  }
+
+  return true;
+}
+
+bool WaveFile::mapFile() {
+#if defined(SYMPHONY_AUDIO_HAS_MMAP)
+  // Samples are read as int16_t straight from the mapping.
+  if (!IsCompressed() && wave_data_offset_ % alignof(int16_t) != 0) {
+    return false;
+  }
+
+  int fd = open(file_path_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      (size_t)file_stat.st_size < wave_data_offset_ + wave_data_size_) {
+    close(fd);
+    return false;
+  }
+
+  void* mapping =
+      mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // Mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    std::cerr << "[Symphony::Audio::WaveFile] Can't map file, falling back "
+                 "to streaming, file_path: "
+              << file_path_ << std::endl;
+    return false;
+  }
+
+  // Played from the beginning, asks OS to start reading ahead.
+  madvise(mapping, (size_t)file_stat.st_size, MADV_WILLNEED);
+
+  mapping_ = mapping;
+  mapping_size_ = (size_t)file_stat.st_size;
+  data_in_memory_ = (const uint8_t*)mapping_ + wave_data_offset_;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void WaveFile::unmapFile() {
+#if defined(SYMPHONY_AUDIO_HAS_MMAP)
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+  }
+#endif
+  if (mapping_) {
+    data_in_memory_ = nullptr;
+  }
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+}
+
+bool WaveFile::resample(size_t sample_rate) {
+  if (!GetSampleRate()) {
+    std::cerr << "[Symphony::Audio::WaveFile] Can't resample file without "
+                 "sample rate, file_path: "
+              << file_path_ << std::endl;
+    return false;
+  }
+
+  size_t num_channels = GetNumChannels();
+  std::vector<int16_t> blocks(num_blocks_ * num_channels);
+  if (!ReadBlocks(file_, 0, num_blocks_, blocks.data())) {
+    std::cerr << "[Symphony::Audio::WaveFile] Can't read file to resample, "
+                 "file_path: "
+              << file_path_ << std::endl;
+    return false;
+  }
+
+  size_t num_resampled_blocks =
+      GetResampledNumBlocks(num_blocks_, GetSampleRate(), sample_rate);
+  std::vector<uint8_t> resampled(num_resampled_blocks * num_channels *
+                                 sizeof(int16_t));
+  ResampleBlocks(blocks.data(), num_blocks_, num_channels, GetSampleRate(),
+                 sample_rate, (int16_t*)resampled.data());
+
+  setPcmInMemory(std::move(resampled), num_resampled_blocks, sample_rate);
+  is_resampled_ = true;
+  return true;
+}
+
+bool WaveFile::decode() {
+  std::vector<uint8_t> decoded(num_blocks_ * GetBlockSize());
+  if (!ReadBlocks(file_, 0, num_blocks_, (int16_t*)decoded.data())) {
+    std::cerr << "[Symphony::Audio::WaveFile] Can't decode file, file_path: "
+              << file_path_ << std::endl;
+    return false;
+  }
+
+  setPcmInMemory(std::move(decoded), num_blocks_, GetSampleRate());
+  return true;
+}
+
+void WaveFile::setPcmInMemory(std::vector<uint8_t> blocks, size_t num_blocks,
+                              size_t sample_rate) {
+  unmapFile();
+  file_.close();
+  wave_data_ = std::move(blocks);
+  data_in_memory_ = wave_data_.data();
+  wave_data_offset_ = 0;
+  wave_data_size_ = wave_data_.size();
+  num_blocks_ = num_blocks;
+  adpcm_samples_per_block_ = 0;
+  ms_adpcm_coefficients_.clear();
+
+  size_t block_align = GetNumChannels() * sizeof(int16_t);
+  SetValue16(format_common_.format_category, kWaveFormatPcm);
+  SetValue32(format_common_.sample_rate, sample_rate);
+  SetValue32(format_common_.byte_rate, sample_rate * block_align);
+  SetValue16(format_common_.block_align, block_align);
+  SetValue16(format_pcm_.bits_per_sample, 16);
+}
+
+namespace {
+// Resampled files by path and sample rate. Entries don't keep files alive:
+// a file is converted again when it is loaded after all its users are gone.
+struct ResampledWaveCache {
+  std::mutex mutex;
+  std::map<std::pair<std::string, size_t>, std::weak_ptr<WaveFile>>
+      wave_files;
+};
+
+ResampledWaveCache& GetResampledWaveCache() {
+  static ResampledWaveCache cache;
+  return cache;
 }
+}  // namespace
 
+// sample_rate: see WaveFile::Load(). Files which are resampled are converted
+// once: loading the same file at the same rate again returns the same
+// WaveFile while it is in use.
 std::shared_ptr<WaveFile> LoadWave(const std::string& file_path,
-                                   WaveFile::Mode mode) {
+                                   WaveFile::Mode mode,
+                                   size_t sample_rate = 0) {
+  ResampledWaveCache& cache = GetResampledWaveCache();
+  std::pair<std::string, size_t> key(file_path, sample_rate);
+  if (sample_rate) {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.wave_files.find(key);
+    if (it != cache.wave_files.end()) {
+      if (std::shared_ptr<WaveFile> result = it->second.lock()) {
+        return result;
+      }
+    }
+  }
+
   std::shared_ptr<WaveFile> result(new WaveFile());
-  if (!result->Load(file_path, mode)) {
+  if (!result->Load(file_path, mode, sample_rate)) {
     result.reset();
+    return result;
+  }
+
+  if (result->IsResampled()) {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    std::erase_if(cache.wave_files,
+                  [](const auto& entry) { return entry.second.expired(); });
+    cache.wave_files[key] = result;
   }
   return result;
 }
 
+namespace {
+void PutValue16(std::vector<uint8_t>& bytes, size_t value) {
+  bytes.push_back((uint8_t)(value & 0xFF));
+  bytes.push_back((uint8_t)((value >> 8) & 0xFF));
+}
+
+void PutValue32(std::vector<uint8_t>& bytes, size_t value) {
+  PutValue16(bytes, value & 0xFFFF);
+  PutValue16(bytes, (value >> 16) & 0xFFFF);
+}
+
+void PutFourCC(std::vector<uint8_t>& bytes, const char* code) {
+  bytes.insert(bytes.end(), code, code + 4);
+}
+}  // namespace
+
+// Writes interleaved 16-bit samples as kWaveFormatPcm or kWaveFormatImaAdpcm
+// wave file.
+bool SaveWave(const std::string& file_path, WaveFormatCategory format,
+              size_t num_channels, size_t sample_rate, const int16_t* blocks,
+              size_t num_blocks) {
+  std::vector<uint8_t> wave_data;
+  std::vector<uint8_t> format_chunk;
+  size_t block_align = num_channels * sizeof(int16_t);
+
+  if (format == kWaveFormatPcm) {
+    wave_data.resize(num_blocks * block_align);
+    memcpy(wave_data.data(), blocks, wave_data.size());
+
+    PutValue16(format_chunk, kWaveFormatPcm);
+    PutValue16(format_chunk, num_channels);
+    PutValue32(format_chunk, sample_rate);
+    PutValue32(format_chunk, sample_rate * block_align);
+    PutValue16(format_chunk, block_align);
+    PutValue16(format_chunk, 16);
+  } else if (format == kWaveFormatImaAdpcm && num_channels >= 1 &&
+             num_channels <= 2) {
+    size_t samples_per_block = kImaAdpcmDefaultSamplesPerBlock;
+    block_align = GetImaAdpcmBlockSize(samples_per_block, num_channels);
+
+    size_t num_adpcm_blocks =
+        (num_blocks + samples_per_block - 1) / samples_per_block;
+    wave_data.resize(num_adpcm_blocks * block_align);
+
+    int step_indices[2] = {0, 0};
+    for (size_t i = 0; i < num_adpcm_blocks; ++i) {
+      size_t first_block = i * samples_per_block;
+      EncodeImaAdpcmBlock(
+          blocks + first_block * num_channels,
+          std::min(samples_per_block, num_blocks - first_block), num_channels,
+          samples_per_block, step_indices, &wave_data[i * block_align]);
+    }
+
+    PutValue16(format_chunk, kWaveFormatImaAdpcm);
+    PutValue16(format_chunk, num_channels);
+    PutValue32(format_chunk, sample_rate);
+    PutValue32(format_chunk, sample_rate * block_align / samples_per_block);
+    PutValue16(format_chunk, block_align);
+    PutValue16(format_chunk, 4);
+    PutValue16(format_chunk, 2);
+    PutValue16(format_chunk, samples_per_block);
+  } else {
+    std::cerr << "[Symphony::Audio::WaveFile] Can't save in this format, "
+                 "file_path: "
+              << file_path << std::endl;
+    return false;
+  }
+
+  std::vector<uint8_t> bytes;
+  PutFourCC(bytes, "RIFF");
+  PutValue32(bytes, 0);
+  PutFourCC(bytes, "WAVE");
+
+  PutFourCC(bytes, "fmt ");
+  PutValue32(bytes, format_chunk.size());
+  bytes.insert(bytes.end(), format_chunk.begin(), format_chunk.end());
+
+  if (format != kWaveFormatPcm) {
+    PutFourCC(bytes, "fact");
+    PutValue32(bytes, 4);
+    PutValue32(bytes, num_blocks);
+  }
+
+  PutFourCC(bytes, "data");
+  PutValue32(bytes, wave_data.size());
+  bytes.insert(bytes.end(), wave_data.begin(), wave_data.end());
+
+  size_t riff_size = bytes.size() - sizeof(RiffChunkHeader);
+  bytes[4] = (uint8_t)(riff_size & 0xFF);
+  bytes[5] = (uint8_t)((riff_size >> 8) & 0xFF);
+  bytes[6] = (uint8_t)((riff_size >> 16) & 0xFF);
+  bytes[7] = (uint8_t)((riff_size >> 24) & 0xFF);
+
+  std::ofstream file(file_path, std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "[Symphony::Audio::WaveFile] Can't open file for writing, "
+                 "file_path: "
+              << file_path << std::endl;
+    return false;
+  }
+
+  file.write((const char*)bytes.data(), bytes.size());
+  return file.good();
+}
+
 }  // namespace Audio
 }  // namespace Symphony
@@ -0,0 +1,198 @@
+#include "wave_loader.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "wave_test_utils.hpp"
+
+using namespace Symphony::Audio;
+
+namespace {
+// Stereo 16-bit wave file with samples 0, -1, 2, -3, ...
+std::string WriteAlternatingWave(size_t num_blocks) {
+  std::vector<int16_t> samples(num_blocks * 2);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = (int16_t)(i % 2 ? -(int)i : (int)i);
+  }
+  return WriteTestWave("wave_loader_test.wav", samples, 2, 22050);
+}
+
+std::vector<int16_t> MakeSine(size_t num_blocks, size_t num_channels) {
+  std::vector<int16_t> samples(num_blocks * num_channels);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    for (size_t c = 0; c < num_channels; ++c) {
+      samples[i * num_channels + c] =
+          (int16_t)(10000.0 * std::sin((double)i * 0.05 * (double)(c + 1)));
+    }
+  }
+  return samples;
+}
+}  // namespace
+
+TEST(WaveLoader, LoadsInMemory) {
+  auto wave_file =
+      LoadWave(WriteAlternatingWave(100), WaveFile::kModeLoadInMemory);
+  ASSERT_TRUE(wave_file);
+  ASSERT_TRUE(wave_file->IsInMemory());
+  ASSERT_FALSE(wave_file->IsMemoryMapped());
+  ASSERT_EQ(wave_file->GetNumBlocks(), 100);
+  ASSERT_EQ(wave_file->GetNumChannels(), 2);
+
+  const int16_t* samples = wave_file->GetBufferWhenInMemory(10);
+  ASSERT_EQ(samples[0], 20);
+  ASSERT_EQ(samples[1], -21);
+}
+
+TEST(WaveLoader, MemoryMappedMatchesLoadedInMemory) {
+  std::string file_path = WriteAlternatingWave(100);
+  auto in_memory = LoadWave(file_path, WaveFile::kModeLoadInMemory);
+  auto memory_mapped = LoadWave(file_path, WaveFile::kModeMemoryMapped);
+  ASSERT_TRUE(in_memory);
+  ASSERT_TRUE(memory_mapped);
+  ASSERT_EQ(memory_mapped->GetNumBlocks(), in_memory->GetNumBlocks());
+
+  if (!memory_mapped->IsMemoryMapped()) {
+    // Fell back to streaming from file.
+    ASSERT_FALSE(memory_mapped->IsInMemory());
+    return;
+  }
+
+  ASSERT_TRUE(memory_mapped->IsInMemory());
+  for (size_t i = 0; i < in_memory->GetNumBlocks() * 2; ++i) {
+    ASSERT_EQ(memory_mapped->GetBufferWhenInMemory(0)[i],
+              in_memory->GetBufferWhenInMemory(0)[i]);
+  }
+
+  std::vector<int16_t> blocks(10 * 2);
+  memory_mapped->ReadBlocks(90, 10, blocks.data());
+  ASSERT_EQ(blocks[0], 180);
+  ASSERT_EQ(blocks[19], -199);
+}
+
+TEST(WaveLoader, StreamsFromFile) {
+  auto wave_file =
+      LoadWave(WriteAlternatingWave(100), WaveFile::kModeStreamingFromFile);
+  ASSERT_TRUE(wave_file);
+  ASSERT_FALSE(wave_file->IsInMemory());
+
+  std::vector<int16_t> blocks(2 * 2);
+  wave_file->ReadBlocks(50, 2, blocks.data());
+  ASSERT_EQ(blocks[0], 100);
+  ASSERT_EQ(blocks[3], -103);
+}
+
+TEST(WaveLoader, ReadsImaAdpcmWithRandomAccess) {
+  // Long enough to stay compressed in memory.
+  static constexpr size_t kNumBlocks = kMaxDecodedAdpcmBlocks + 3000;
+  auto samples = MakeSine(kNumBlocks, 2);
+  std::string file_path = ::testing::TempDir() + "wave_loader_adpcm_test.wav";
+  ASSERT_TRUE(SaveWave(file_path, kWaveFormatImaAdpcm, 2, 22050,
+                       samples.data(), kNumBlocks));
+
+  auto in_memory = LoadWave(file_path, WaveFile::kModeLoadInMemory);
+  auto streaming = LoadWave(file_path, WaveFile::kModeStreamingFromFile);
+  ASSERT_TRUE(in_memory);
+  ASSERT_TRUE(streaming);
+  ASSERT_TRUE(in_memory->IsCompressed());
+  ASSERT_FALSE(in_memory->IsInMemory());
+  ASSERT_FALSE(in_memory->IsStreamingFromFile());
+  ASSERT_TRUE(streaming->IsStreamingFromFile());
+  ASSERT_EQ(in_memory->GetNumBlocks(), kNumBlocks);
+  ASSERT_EQ(in_memory->GetBlockSize(), 4);
+
+  std::vector<int16_t> decoded(kNumBlocks * 2);
+  in_memory->ReadBlocks(0, kNumBlocks, decoded.data());
+  // Skips a few samples while encoder adapts.
+  for (size_t i = 16 * 2; i < decoded.size(); ++i) {
+    ASSERT_NEAR(decoded[i], samples[i], 400) << "sample " << i;
+  }
+
+  // Ranges which cross ADPCM block boundaries give the same samples as the
+  // whole decoded stream:
+  for (size_t first_block : {0, 1, 1000, 1016, 1017, 2033, 2999}) {
+    size_t num_blocks = std::min((size_t)50, kNumBlocks - first_block);
+    std::vector<int16_t> blocks(num_blocks * 2);
+    std::vector<int16_t> streamed_blocks(num_blocks * 2);
+    in_memory->ReadBlocks(first_block, num_blocks, blocks.data());
+    streaming->ReadBlocks(first_block, num_blocks, streamed_blocks.data());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      ASSERT_EQ(blocks[i], decoded[first_block * 2 + i]);
+      ASSERT_EQ(streamed_blocks[i], decoded[first_block * 2 + i]);
+    }
+  }
+}
+
+TEST(WaveLoader, DecodesShortImaAdpcmInMemory) {
+  static constexpr size_t kNumBlocks = 3000;
+  auto samples = MakeSine(kNumBlocks, 2);
+  std::string file_path =
+      ::testing::TempDir() + "wave_loader_adpcm_short_test.wav";
+  ASSERT_TRUE(SaveWave(file_path, kWaveFormatImaAdpcm, 2, 22050,
+                       samples.data(), kNumBlocks));
+
+  auto in_memory = LoadWave(file_path, WaveFile::kModeLoadInMemory);
+  auto streaming = LoadWave(file_path, WaveFile::kModeStreamingFromFile);
+  ASSERT_TRUE(in_memory);
+  ASSERT_TRUE(streaming);
+  ASSERT_FALSE(in_memory->IsCompressed());
+  ASSERT_TRUE(in_memory->IsInMemory());
+  ASSERT_FALSE(in_memory->IsResampled());
+  ASSERT_TRUE(streaming->IsCompressed());
+  ASSERT_EQ(in_memory->GetNumBlocks(), kNumBlocks);
+  ASSERT_EQ(in_memory->GetSampleRate(), 22050);
+  ASSERT_EQ(in_memory->GetSizeInMemory(), kNumBlocks * 4);
+
+  std::vector<int16_t> decoded(kNumBlocks * 2);
+  streaming->ReadBlocks(0, kNumBlocks, decoded.data());
+  const int16_t* blocks = in_memory->GetBufferWhenInMemory(0);
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    ASSERT_EQ(blocks[i], decoded[i]) << "sample " << i;
+  }
+}
+
+TEST(WaveLoader, ResamplesToRequestedRateOnce) {
+  std::string file_path = WriteAlternatingWave(1000);
+
+  auto same_rate =
+      LoadWave(file_path, WaveFile::kModeStreamingFromFile, 22050);
+  ASSERT_TRUE(same_rate);
+  ASSERT_FALSE(same_rate->IsResampled());
+  ASSERT_TRUE(same_rate->IsStreamingFromFile());
+
+  auto resampled = LoadWave(file_path, WaveFile::kModeStreamingFromFile, 44100);
+  ASSERT_TRUE(resampled);
+  ASSERT_TRUE(resampled->IsResampled());
+  ASSERT_TRUE(resampled->IsInMemory());
+  ASSERT_EQ(resampled->GetSampleRate(), 44100);
+  ASSERT_EQ(resampled->GetNumBlocks(), 2000);
+  ASSERT_EQ(resampled->GetNumChannels(), 2);
+
+  // Converted samples are shared while the file is in use.
+  ASSERT_EQ(LoadWave(file_path, WaveFile::kModeLoadInMemory, 44100),
+            resampled);
+  ASSERT_NE(LoadWave(file_path, WaveFile::kModeLoadInMemory, 11025),
+            resampled);
+}
+
+TEST(WaveLoader, ResamplesImaAdpcm) {
+  static constexpr size_t kNumBlocks = 3000;
+  auto samples = MakeSine(kNumBlocks, 1);
+  std::string file_path =
+      ::testing::TempDir() + "wave_loader_adpcm_resample_test.wav";
+  ASSERT_TRUE(SaveWave(file_path, kWaveFormatImaAdpcm, 1, 11025,
+                       samples.data(), kNumBlocks));
+
+  auto wave_file = LoadWave(file_path, WaveFile::kModeLoadInMemory, 22050);
+  ASSERT_TRUE(wave_file);
+  ASSERT_FALSE(wave_file->IsCompressed());
+  ASSERT_TRUE(wave_file->IsInMemory());
+  ASSERT_EQ(wave_file->GetNumBlocks(), kNumBlocks * 2);
+
+  // Every other block falls on a block of the source.
+  const int16_t* resampled = wave_file->GetBufferWhenInMemory(0);
+  for (size_t i = 100; i < kNumBlocks - 100; ++i) {
+    ASSERT_NEAR(resampled[i * 2], samples[i], 500) << "block " << i;
+  }
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "wave_loader.hpp"
+
+namespace Symphony {
+namespace Audio {
+// Ring of blocks read ahead of the play cursor of a wave file which samples
+// are not in memory: streamed from file or compressed. Blocks go in the order
+// they are played: when the end of the file is reached, reading continues from
+// its beginning.
+//
+// Fill() is called by a loader thread (producer), Read() by the audio callback
+// (consumer). The ring has its own file handle, so several streams of the same
+// wave file can be prefetched independently.
+class WavePrefetcher {
+ public:
+  static inline constexpr size_t kDefaultCapacityBlocks = 16384;
+
+  // num_blocks_to_prefetch: 0 means that stream loops until stopped.
+  // capacity_blocks: should be a power of two, ring is made smaller when
+  // stream is shorter.
+  WavePrefetcher(std::shared_ptr<WaveFile> wave_file,
+                 size_t num_blocks_to_prefetch,
+                 size_t capacity_blocks = kDefaultCapacityBlocks);
+
+  WavePrefetcher(const WavePrefetcher&) = delete;
+  WavePrefetcher& operator=(const WavePrefetcher&) = delete;
+
+  bool IsOpen() const { return is_open_; }
+
+  // Producer side. Reads as many blocks as fit into the ring, returns number
+  // of blocks read.
+  size_t Fill();
+
+  // Consumer side. Copies num_blocks to blocks_out, blocks which are not
+  // prefetched yet are filled with silence and are skipped in the ring later,
+  // so that the ring stays in sync with the play cursor. Returns number of
+  // blocks copied.
+  size_t Read(size_t num_blocks, int16_t* blocks_out);
+
+  // Consumer side. Same as Read(), but doesn't copy: calls
+  // use_blocks(first_block, blocks, num_blocks) for at most two spans of the
+  // ring, first_block is relative to the read position. Blocks which are not
+  // prefetched yet are left out.
+  template <typename UseBlocks>
+  size_t ReadInPlace(size_t num_blocks, UseBlocks use_blocks);
+
+  size_t GetCapacityBlocks() const { return capacity_blocks_; }
+  size_t GetNumPrefetchedBlocks() const;
+  uint32_t GetNumRefills() const {
+    return num_refills_.load(std::memory_order_relaxed);
+  }
+  uint32_t GetNumUnderruns() const {
+    return num_underruns_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::shared_ptr<WaveFile> wave_file_;
+  std::ifstream file_;
+  bool is_open_{false};
+  size_t num_channels_{0};
+  size_t block_size_{0};
+  size_t capacity_blocks_{0};
+  std::vector<int16_t> ring_;
+
+  // Producer only.
+  size_t num_blocks_to_prefetch_{0};
+  size_t total_blocks_prefetched_{0};
+  size_t file_cursor_{0};
+
+  // Consumer only.
+  size_t blocks_to_skip_{0};
+
+  // Free-running positions in blocks. Counters have a single writer each, so
+  // they are updated with load and store only.
+  std::atomic<uint32_t> write_position_{0};
+  std::atomic<uint32_t> read_position_{0};
+  std::atomic<uint32_t> num_refills_{0};
+  std::atomic<uint32_t> num_underruns_{0};
+};
+
+WavePrefetcher::WavePrefetcher(std::shared_ptr<WaveFile> wave_file,
+                               size_t num_blocks_to_prefetch,
+                               size_t capacity_blocks)
+    : wave_file_(wave_file),
+      num_channels_(wave_file->GetNumChannels()),
+      block_size_(wave_file->GetBlockSize()),
+      capacity_blocks_(capacity_blocks),
+      num_blocks_to_prefetch_(num_blocks_to_prefetch) {
+  if (num_blocks_to_prefetch_) {
+    while (capacity_blocks_ / 2 >= num_blocks_to_prefetch_) {
+      capacity_blocks_ /= 2;
+    }
+  }
+  ring_.resize(capacity_blocks_ * num_channels_);
+
+  if (!wave_file_->IsStreamingFromFile()) {
+    is_open_ = true;
+    return;
+  }
+
+  file_.open(wave_file_->GetFilePath(), std::ios::binary);
+  is_open_ = file_.is_open();
+  if (!is_open_) {
+    std::cerr << "[Symphony::Audio::WavePrefetcher] Can't open file, "
+                 "file_path: "
+              << wave_file_->GetFilePath() << std::endl;
+  }
+}
+
+size_t WavePrefetcher::Fill() {
+  if (!is_open_) {
+    return 0;
+  }
+
+  uint32_t write_position = write_position_.load(std::memory_order_relaxed);
+  uint32_t read_position = read_position_.load(std::memory_order_acquire);
+
+  size_t num_blocks_to_fill =
+      capacity_blocks_ - (size_t)(write_position - read_position);
+  if (num_blocks_to_prefetch_) {
+    num_blocks_to_fill =
+        std::min(num_blocks_to_fill,
+                 num_blocks_to_prefetch_ - total_blocks_prefetched_);
+  }
+  if (!num_blocks_to_fill) {
+    return 0;
+  }
+
+  size_t file_num_blocks = wave_file_->GetNumBlocks();
+  size_t num_blocks_filled = 0;
+  while (num_blocks_filled < num_blocks_to_fill) {
+    size_t ring_block = (write_position + num_blocks_filled) &
+                        (uint32_t)(capacity_blocks_ - 1);
+    size_t num_blocks_to_read =
+        std::min({num_blocks_to_fill - num_blocks_filled,
+                  capacity_blocks_ - ring_block,
+                  file_num_blocks - file_cursor_});
+
+    if (!wave_file_->ReadBlocks(file_, file_cursor_, num_blocks_to_read,
+                                &ring_[ring_block * num_channels_])) {
+      std::cerr << "[Symphony::Audio::WavePrefetcher] Something is wrong "
+                   "with reading file, file_path: "
+                << wave_file_->GetFilePath() << std::endl;
+      is_open_ = false;
+      break;
+    }
+
+    num_blocks_filled += num_blocks_to_read;
+    file_cursor_ += num_blocks_to_read;
+    if (file_cursor_ == file_num_blocks) {
+      file_cursor_ = 0;
+    }
+  }
+
+  total_blocks_prefetched_ += num_blocks_filled;
+  write_position_.store(write_position + (uint32_t)num_blocks_filled,
+                        std::memory_order_release);
+  num_refills_.store(num_refills_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+
+  return num_blocks_filled;
+}
+
+size_t WavePrefetcher::Read(size_t num_blocks, int16_t* blocks_out) {
+  size_t num_blocks_read = ReadInPlace(
+      num_blocks,
+      [this, blocks_out](size_t first_block, const int16_t* blocks,
+                         size_t num_blocks_in_span) {
+        memcpy(blocks_out + first_block * num_channels_, blocks,
+               num_blocks_in_span * block_size_);
+      });
+
+  memset(blocks_out + num_blocks_read * num_channels_, 0,
+         (num_blocks - num_blocks_read) * block_size_);
+
+  return num_blocks_read;
+}
+
+template <typename UseBlocks>
+size_t WavePrefetcher::ReadInPlace(size_t num_blocks, UseBlocks use_blocks) {
+  uint32_t read_position = read_position_.load(std::memory_order_relaxed);
+  uint32_t write_position = write_position_.load(std::memory_order_acquire);
+
+  size_t num_blocks_available = write_position - read_position;
+
+  // Catches up after underruns.
+  size_t num_blocks_skipped = std::min(num_blocks_available, blocks_to_skip_);
+  read_position += (uint32_t)num_blocks_skipped;
+  num_blocks_available -= num_blocks_skipped;
+  blocks_to_skip_ -= num_blocks_skipped;
+
+  size_t num_blocks_read = std::min(num_blocks, num_blocks_available);
+  size_t ring_block = read_position & (uint32_t)(capacity_blocks_ - 1);
+  size_t num_blocks_before_wrap =
+      std::min(num_blocks_read, capacity_blocks_ - ring_block);
+  if (num_blocks_before_wrap) {
+    use_blocks(0, &ring_[ring_block * num_channels_], num_blocks_before_wrap);
+  }
+  if (num_blocks_read > num_blocks_before_wrap) {
+    use_blocks(num_blocks_before_wrap, &ring_[0],
+               num_blocks_read - num_blocks_before_wrap);
+  }
+
+  if (num_blocks_read < num_blocks) {
+    blocks_to_skip_ += num_blocks - num_blocks_read;
+    num_underruns_.store(num_underruns_.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+  }
+
+  // Blocks are used before the producer may overwrite them.
+  read_position_.store(read_position + (uint32_t)num_blocks_read,
+                       std::memory_order_release);
+
+  return num_blocks_read;
+}
+
+size_t WavePrefetcher::GetNumPrefetchedBlocks() const {
+  uint32_t read_position = read_position_.load(std::memory_order_acquire);
+  uint32_t write_position = write_position_.load(std::memory_order_acquire);
+  return write_position - read_position;
+}
+}  // namespace Audio
+}  // namespace Symphony
@@ -0,0 +1,107 @@
+#include "wave_prefetcher.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "wave_test_utils.hpp"
+
+using namespace Symphony::Audio;
+
+namespace {
+// Mono 16-bit wave file with samples 0, 1, 2, ...
+std::string WriteRampWave(size_t num_blocks) {
+  std::vector<int16_t> samples(num_blocks);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = (int16_t)i;
+  }
+  return WriteTestWave("wave_prefetcher_test.wav", samples, 1, 22050);
+}
+}  // namespace
+
+TEST(WavePrefetcher, ReadsInPlayOrderWithLoopWrapAround) {
+  auto wave_file =
+      LoadWave(WriteRampWave(10), WaveFile::kModeStreamingFromFile);
+  ASSERT_TRUE(wave_file);
+
+  WavePrefetcher prefetcher(wave_file, 0, 8);
+  ASSERT_TRUE(prefetcher.IsOpen());
+
+  std::vector<int16_t> blocks(6);
+  int16_t expected = 0;
+  for (int i = 0; i < 10; ++i) {
+    prefetcher.Fill();
+    ASSERT_EQ(prefetcher.GetNumPrefetchedBlocks(), 8);
+    ASSERT_EQ(prefetcher.Read(blocks.size(), blocks.data()), blocks.size());
+    for (int16_t block : blocks) {
+      ASSERT_EQ(block, expected);
+      expected = (expected + 1) % 10;
+    }
+  }
+  ASSERT_EQ(prefetcher.GetNumUnderruns(), 0);
+}
+
+TEST(WavePrefetcher, StopsAtNumBlocksToPrefetch) {
+  auto wave_file =
+      LoadWave(WriteRampWave(10), WaveFile::kModeStreamingFromFile);
+  ASSERT_TRUE(wave_file);
+
+  WavePrefetcher prefetcher(wave_file, 5, 8);
+  ASSERT_EQ(prefetcher.Fill(), 5);
+  ASSERT_EQ(prefetcher.Fill(), 0);
+}
+
+TEST(WavePrefetcher, FillsSilenceOnUnderrunAndCatchesUp) {
+  auto wave_file =
+      LoadWave(WriteRampWave(100), WaveFile::kModeStreamingFromFile);
+  ASSERT_TRUE(wave_file);
+
+  WavePrefetcher prefetcher(wave_file, 0, 16);
+  std::vector<int16_t> blocks(4);
+
+  // Nothing is prefetched yet:
+  ASSERT_EQ(prefetcher.Read(blocks.size(), blocks.data()), 0);
+  ASSERT_EQ(prefetcher.GetNumUnderruns(), 1);
+  for (int16_t block : blocks) {
+    ASSERT_EQ(block, 0);
+  }
+
+  // Missed blocks are skipped, so the stream stays in time:
+  prefetcher.Fill();
+  ASSERT_EQ(prefetcher.Read(blocks.size(), blocks.data()), blocks.size());
+  ASSERT_EQ(blocks[0], 4);
+  ASSERT_EQ(blocks[3], 7);
+}
+
+TEST(WavePrefetcher, ReadsInPlaceInTwoSpansWhenRingWraps) {
+  auto wave_file =
+      LoadWave(WriteRampWave(100), WaveFile::kModeStreamingFromFile);
+  ASSERT_TRUE(wave_file);
+
+  WavePrefetcher prefetcher(wave_file, 0, 8);
+  std::vector<int16_t> blocks(6);
+  prefetcher.Fill();
+  prefetcher.Read(blocks.size(), blocks.data());
+  prefetcher.Fill();
+
+  std::vector<std::pair<size_t, size_t>> spans;
+  std::vector<int16_t> read_in_place(6);
+  ASSERT_EQ(prefetcher.ReadInPlace(
+                read_in_place.size(),
+                [&](size_t first_block, const int16_t* blocks_in_ring,
+                    size_t num_blocks) {
+                  spans.emplace_back(first_block, num_blocks);
+                  std::copy(blocks_in_ring, blocks_in_ring + num_blocks,
+                            read_in_place.begin() + first_block);
+                }),
+            read_in_place.size());
+
+  ASSERT_EQ(spans.size(), 2);
+  ASSERT_EQ(spans[0], std::make_pair((size_t)0, (size_t)2));
+  ASSERT_EQ(spans[1], std::make_pair((size_t)2, (size_t)4));
+  for (size_t i = 0; i < read_in_place.size(); ++i) {
+    ASSERT_EQ(read_in_place[i], (int16_t)(6 + i));
+  }
+}
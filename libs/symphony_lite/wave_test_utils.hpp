@@ -0,0 +1,26 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "wave_loader.hpp"
+
+namespace Symphony {
+namespace Audio {
+// Writes interleaved samples as 16-bit PCM wave file in the test temporary
+// directory, returns its path.
+std::string WriteTestWave(const std::string& name,
+                          const std::vector<int16_t>& samples,
+                          size_t num_channels, size_t sample_rate) {
+  std::string file_path = ::testing::TempDir() + name;
+  EXPECT_TRUE(SaveWave(file_path, kWaveFormatPcm, num_channels, sample_rate,
+                       samples.data(), samples.size() / num_channels));
+  return file_path;
+}
+}  // namespace Audio
+}  // namespace Symphony
@@ -1,6 +1,16 @@
 #pragma once
 
+#include <stdlib.h>
+
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <string>
 #include <symphony_lite/all_symphony.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "consts.hpp"
 
 namespace gameLD58 {
 enum class Sound {
@@ -8,60 +18,174 @@ enum class Sound {
   kHumanoidSelect,
   kKaChing,
   kBeamLoop,
-  kBodyFall_1,
-  kBodyFall_2,
-  kBodyFall_3,
+  kBodyFall,
   kCapture,
-  kPanic_1,
-  kPanic_2,
-  kPanic_3,
-  kPanic_4,
-  kPanic_5,
-  kPanic_6,
+  kPanic,
 };
 
+// Group of the sound in sound_banks.json.
+const char* GetSoundGroupName(Sound sound) {
+  switch (sound) {
+    case Sound::kButtonClick:
+      return "button_click";
+    case Sound::kHumanoidSelect:
+      return "humanoid_select";
+    case Sound::kKaChing:
+      return "ka_ching";
+    case Sound::kBeamLoop:
+      return "beam_loop";
+    case Sound::kBodyFall:
+      return "body_fall";
+    case Sound::kCapture:
+      return "capture";
+    case Sound::kPanic:
+      return "panic";
+  }
+  return "";
+}
+
+// Sound banks are described in sound_banks.json:
+//
+//  - "banks": list of banks, each with "name" and "groups". A group has
+//    "name", "files" with its variations, optional "mode" ("memory",
+//    "mapped" or "streaming", "memory" by default) and optional "limits" for
+//    sounds which can be triggered by every human in a crowd.
+//  - "screens": names of banks needed by each screen.
+//  - "memory_budget_kb": banks of screens which are left stay loaded while
+//    they fit.
 struct AllAudio {
-  std::unordered_map<Sound, std::shared_ptr<Symphony::Audio::WaveFile>> audio;
+  // Loads bank descriptions, banks themselves are loaded by EnterScreen().
+  void Load(Symphony::Audio::Device& device, const std::string& file_path);
+
+  // Acquires banks of the screen before releasing banks of the previous
+  // screen, so that banks needed by both stay loaded.
+  void EnterScreen(const std::string& screen);
+
+  // Random variation of the sound, nullptr while its bank isn't loaded.
+  std::shared_ptr<Symphony::Audio::WaveFile> GetWave(Sound sound);
+  // All variations of the sound with the limits of its group, played with
+  // Symphony::Audio::Device::Trigger(). nullptr while its bank isn't loaded.
+  Symphony::Audio::LimitedSound* GetLimitedSound(Sound sound);
+
+  Symphony::Audio::SoundBanks banks;
+  std::unordered_map<Sound, size_t> groups;
+  std::map<std::string, std::vector<std::string>> screen_banks;
+  std::string cur_screen;
+
+  size_t music_bus{Symphony::Audio::kMasterBus};
+  size_t sfx_bus{Symphony::Audio::kMasterBus};
+  // Sounds of humans, mixed into sfx_bus. The tractor beam is played on
+  // sfx_bus itself, so that it isn't muffled with them.
+  size_t world_bus{Symphony::Audio::kMasterBus};
+  size_t ui_bus{Symphony::Audio::kMasterBus};
 };
 
-AllAudio LoadAllAudio() {
-  AllAudio result;
-
-  result.audio[Sound::kButtonClick] = Symphony::Audio::LoadWave(
-      "assets/button_click.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-
-  result.audio[Sound::kHumanoidSelect] = Symphony::Audio::LoadWave(
-      "assets/select_human.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-
-  result.audio[Sound::kKaChing] = Symphony::Audio::LoadWave(
-      "assets/sell_human.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-
-  result.audio[Sound::kBeamLoop] = Symphony::Audio::LoadWave(
-      "assets/beam.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-
-  result.audio[Sound::kBodyFall_1] = Symphony::Audio::LoadWave(
-      "assets/bodyfall_1.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-  result.audio[Sound::kBodyFall_2] = Symphony::Audio::LoadWave(
-      "assets/bodyfall_2.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-  result.audio[Sound::kBodyFall_3] = Symphony::Audio::LoadWave(
-      "assets/bodyfall_3.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-
-  result.audio[Sound::kCapture] = Symphony::Audio::LoadWave(
-      "assets/capture.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-
-  result.audio[Sound::kPanic_1] = Symphony::Audio::LoadWave(
-      "assets/panic_1.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-  result.audio[Sound::kPanic_2] = Symphony::Audio::LoadWave(
-      "assets/panic_2.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-  result.audio[Sound::kPanic_3] = Symphony::Audio::LoadWave(
-      "assets/panic_3.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-  result.audio[Sound::kPanic_4] = Symphony::Audio::LoadWave(
-      "assets/panic_4.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-  result.audio[Sound::kPanic_5] = Symphony::Audio::LoadWave(
-      "assets/panic_5.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-  result.audio[Sound::kPanic_6] = Symphony::Audio::LoadWave(
-      "assets/panic_6.wav", Symphony::Audio::WaveFile::kModeLoadInMemory);
-
-  return result;
+void AllAudio::Load(Symphony::Audio::Device& device,
+                    const std::string& file_path) {
+  music_bus = device.CreateBus();
+  sfx_bus = device.CreateBus();
+  world_bus = device.CreateBus(sfx_bus);
+  ui_bus = device.CreateBus();
+  device.SetBusFilter(ui_bus,
+                      Symphony::Audio::HighPass(kUiHighPassCutoffHz));
+
+  std::ifstream file;
+
+  file.open(file_path);
+  if (!file.is_open()) {
+    LOGE("Failed to load {}", file_path);
+    return;
+  }
+
+  nlohmann::json banks_json = nlohmann::json::parse(file, nullptr, false);
+  file.close();
+  if (banks_json.is_discarded()) {
+    LOGE("Failed to parse {}", file_path);
+    return;
+  }
+
+  std::vector<Symphony::Audio::SoundBankConfig> bank_configs;
+  for (const auto& bank_json : banks_json["banks"]) {
+    Symphony::Audio::SoundBankConfig bank_config;
+    bank_config.name = bank_json["name"].get<std::string>();
+
+    for (const auto& group_json : bank_json["groups"]) {
+      Symphony::Audio::SoundGroupConfig group_config;
+      group_config.name = group_json["name"].get<std::string>();
+      for (const auto& file_json : group_json["files"]) {
+        group_config.file_paths.push_back("assets/" +
+                                          file_json.get<std::string>());
+      }
+
+      std::string mode = group_json.value("mode", "memory");
+      if (mode == "mapped") {
+        group_config.mode = Symphony::Audio::WaveFile::kModeMemoryMapped;
+      } else if (mode == "streaming") {
+        group_config.mode = Symphony::Audio::WaveFile::kModeStreamingFromFile;
+      } else {
+        group_config.mode = Symphony::Audio::WaveFile::kModeLoadInMemory;
+      }
+
+      if (group_json.contains("limits")) {
+        const auto& limits_json = group_json["limits"];
+        group_config.limits = Symphony::Audio::SoundLimits{
+            .max_instances = limits_json.value("max_instances", (size_t)0),
+            .min_retrigger_interval_sec =
+                limits_json.value("min_retrigger_interval_sec", 0.0f),
+            .steal_oldest = limits_json.value("steal_oldest", false)};
+      }
+
+      bank_config.groups.push_back(std::move(group_config));
+    }
+
+    bank_configs.push_back(std::move(bank_config));
+  }
+
+  for (auto& [screen, banks_of_screen_json] :
+       banks_json["screens"].items()) {
+    for (const auto& bank_json : banks_of_screen_json) {
+      screen_banks[screen].push_back(bank_json.get<std::string>());
+    }
+  }
+
+  // Sounds are converted to the rate of the device once, when loaded.
+  banks.Init(bank_configs, (size_t)device.GetSampleRate(),
+             banks_json.value("memory_budget_kb", (size_t)512) * 1024);
+
+  for (Sound sound : {Sound::kButtonClick, Sound::kHumanoidSelect,
+                      Sound::kKaChing, Sound::kBeamLoop, Sound::kBodyFall,
+                      Sound::kCapture, Sound::kPanic}) {
+    groups[sound] = banks.FindGroup(GetSoundGroupName(sound));
+    if (groups[sound] == Symphony::Audio::kNoSoundGroup) {
+      LOGE("No sound group '{}' in {}", GetSoundGroupName(sound), file_path);
+    }
+  }
+}
+
+void AllAudio::EnterScreen(const std::string& screen) {
+  if (screen == cur_screen) {
+    return;
+  }
+
+  for (const auto& bank : screen_banks[screen]) {
+    banks.Acquire(bank);
+  }
+  for (const auto& bank : screen_banks[cur_screen]) {
+    banks.Release(bank);
+  }
+  cur_screen = screen;
+}
+
+std::shared_ptr<Symphony::Audio::WaveFile> AllAudio::GetWave(Sound sound) {
+  size_t group = groups[sound];
+  size_t num_variations = banks.GetNumVariations(group);
+  if (!num_variations) {
+    return nullptr;
+  }
+  return banks.GetWaveFile(group, (size_t)rand() % num_variations);
+}
+
+Symphony::Audio::LimitedSound* AllAudio::GetLimitedSound(Sound sound) {
+  return banks.GetLimitedSound(groups[sound]);
 }
 }  // namespace gameLD58
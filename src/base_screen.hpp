@@ -26,7 +26,8 @@ class BaseScreen : public Keyboard::Callback {
 
   void Load(
       std::map<std::string, std::shared_ptr<Symphony::Text::Font>> known_fonts,
-      const std::string& default_font);
+      const std::string& default_font,
+      std::shared_ptr<Symphony::Text::TextLayoutCache> text_layout_cache);
 
   void Show(const PlayerStatus* player_status_);
 
@@ -60,7 +61,8 @@ class BaseScreen : public Keyboard::Callback {
 
 void BaseScreen::Load(
     std::map<std::string, std::shared_ptr<Symphony::Text::Font>> known_fonts,
-    const std::string& default_font) {
+    const std::string& default_font,
+    std::shared_ptr<Symphony::Text::TextLayoutCache> text_layout_cache) {
   known_fonts_ = known_fonts;
   default_font_ = default_font;
 
@@ -85,6 +87,7 @@ void BaseScreen::Load(
   const auto& credits_earned_json =
       base_screen_json["base_screen"]["credits_earned"];
   credits_earned.text_renderer.InitRenderer(renderer_);
+  credits_earned.text_renderer.SetLayoutCache(text_layout_cache);
   credits_earned.text_renderer.LoadFromFile(credits_earned_json["file_path"]);
   credits_earned.text_renderer.SetPosition(credits_earned_json.value("x", 0),
                                            credits_earned_json.value("y", 0));
@@ -94,6 +97,7 @@ void BaseScreen::Load(
   const auto& humans_captured_json =
       base_screen_json["base_screen"]["humans_captured"];
   humans_captured.text_renderer.InitRenderer(renderer_);
+  humans_captured.text_renderer.SetLayoutCache(text_layout_cache);
   humans_captured.text_renderer.LoadFromFile(humans_captured_json["file_path"]);
   humans_captured.text_renderer.SetPosition(humans_captured_json.value("x", 0),
                                             humans_captured_json.value("y", 0));
@@ -104,6 +108,7 @@ void BaseScreen::Load(
   const auto& levels_completed_json =
       base_screen_json["base_screen"]["levels_completed"];
   levels_completed.text_renderer.InitRenderer(renderer_);
+  levels_completed.text_renderer.SetLayoutCache(text_layout_cache);
   levels_completed.text_renderer.LoadFromFile(
       levels_completed_json["file_path"]);
   levels_completed.text_renderer.SetPosition(
@@ -114,6 +119,7 @@ void BaseScreen::Load(
 
   const auto& best_price_json = base_screen_json["base_screen"]["best_price"];
   best_price.text_renderer.InitRenderer(renderer_);
+  best_price.text_renderer.SetLayoutCache(text_layout_cache);
   best_price.text_renderer.LoadFromFile(best_price_json["file_path"]);
   best_price.text_renderer.SetPosition(best_price_json.value("x", 0),
                                        best_price_json.value("y", 0));
@@ -198,8 +204,9 @@ void BaseScreen::OnKeyDown(Keyboard::Key /*key*/) {}
 void BaseScreen::OnKeyUp(Keyboard::Key key) {
   if (key == Keyboard::Key::kX) {
     if (callback_) {
-      audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+      audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                   Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
       callback_->ContinueFromBaseScreen();
     }
@@ -208,16 +215,18 @@ void BaseScreen::OnKeyUp(Keyboard::Key key) {
   } else if (key == Keyboard::Key::kTriangle) {
     if (!player_status_->cur_captured_humanoids.empty()) {
       if (callback_) {
-        audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                     Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+        audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                     Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                     Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
         callback_->ToMarketFromBaseScreen();
       }
     }
   } else if (key == Keyboard::Key::kSelect) {
     if (callback_) {
-      audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+      audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                   Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
       callback_->TryExitFromBaseScreen();
     }
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <stddef.h>
+
 namespace gameLD58 {
 static const int kScreenWidth = 480;
 static const int kScreenHeight = 272;
 static const bool kDrawSystemCounters = false;
+// Music tracks of screens crossfade into each other.
+static const float kMusicCrossfadeSec = 2.0f;
+// Sounds of the world are muffled while the tractor beam is on.
+static const float kBeamMuffleCutoffHz = 1200.0f;
+// UI sounds lose their rumble, so they don't mask music and world sounds.
+static const float kUiHighPassCutoffHz = 300.0f;
+// Layouts of texts of screens, kept to show the screens again quickly.
+static const size_t kTextLayoutCacheSize = 32;
 }  // namespace gameLD58
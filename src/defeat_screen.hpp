@@ -63,8 +63,9 @@ void DefeatScreen::OnKeyDown(Keyboard::Key /*key*/) {}
 
 void DefeatScreen::OnKeyUp(Keyboard::Key key) {
   if (key == Keyboard::Key::kX) {
-    audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                 Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+    audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                 Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                 Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
     if (callback_) {
       callback_->ContinueFromDefeatScreen();
@@ -134,9 +134,9 @@ class Game : public TitleScreen::Callback,
   AllAudio all_audio_;
   std::shared_ptr<Symphony::Audio::WaveFile> menu_audio_;
   std::shared_ptr<Symphony::Audio::WaveFile> market_audio_;
-  std::shared_ptr<Symphony::Audio::PlayingStream> menu_audio_stream_;
+  Symphony::Audio::VoiceHandle menu_audio_stream_;
   std::shared_ptr<Symphony::Audio::WaveFile> level_audio_;
-  std::shared_ptr<Symphony::Audio::PlayingStream> level_audio_stream_;
+  Symphony::Audio::VoiceHandle level_audio_stream_;
   float level_audio_timeout_{0.0f};
   std::map<std::string, std::shared_ptr<Symphony::Text::Font>> known_fonts_;
   std::string default_font_;
@@ -162,7 +162,8 @@ void Game::Update(float dt) {
       if (loading_.IsIdle()) {
         menu_audio_stream_ =
             audio_->Play(menu_audio_, Symphony::Audio::kPlayLooped,
-                         Symphony::Audio::FadeInOut(2.0f, 1.0f));
+                         Symphony::Audio::FadeInOut(2.0f, 1.0f),
+                         Symphony::Audio::kPriorityHigh, all_audio_.music_bus);
 
         state_ = State::kTitleScreen;
         title_screen_.RegisterCallback(this);
@@ -250,7 +251,9 @@ void Game::Update(float dt) {
         if (market_before_next_music_timeout_ < 0.0f) {
           menu_audio_stream_ =
               audio_->Play(market_audio_, Symphony::Audio::PlayTimes(2),
-                           Symphony::Audio::FadeInOut(5.0f, 5.0f));
+                           Symphony::Audio::FadeInOut(5.0f, 5.0f),
+                           Symphony::Audio::kPriorityHigh,
+                           all_audio_.music_bus);
           market_before_next_music_timeout_ =
               market_audio_->GetLengthSec() * 2.0f + 2.0f + (float)(rand() % 4);
         }
@@ -292,7 +295,9 @@ void Game::Update(float dt) {
         if (level_audio_timeout_ < 0.0f) {
           level_audio_stream_ =
               audio_->Play(level_audio_, Symphony::Audio::PlayTimes(1),
-                           Symphony::Audio::FadeInOut(5.0f, 5.0f));
+                           Symphony::Audio::FadeInOut(5.0f, 5.0f),
+                           Symphony::Audio::kPriorityHigh,
+                           all_audio_.music_bus);
           level_audio_timeout_ = 10.0f;
         }
       }
@@ -303,7 +308,8 @@ void Game::Update(float dt) {
       if (fade_in_out_.IsIdle()) {
         menu_audio_stream_ =
             audio_->Play(menu_audio_, Symphony::Audio::kPlayLooped,
-                         Symphony::Audio::FadeInOut(2.0f, 1.0f));
+                         Symphony::Audio::FadeInOut(2.0f, 1.0f),
+                         Symphony::Audio::kPriorityHigh, all_audio_.music_bus);
 
         base_screen_.Show(&player_status_);
         fade_in_out_.StartFadeOut(0.5f);
@@ -375,20 +381,29 @@ void Game::Load() {
     level_.Load(known_fonts_, default_font_);
     title_screen_.Load();
     story_screen_.Load(known_fonts_, default_font_);
-    base_screen_.Load(known_fonts_, default_font_);
-    market_screen_.Load(&market_rules_, known_fonts_, default_font_);
+    // Screens show the same few texts every time they are opened.
+    auto text_layout_cache =
+        std::make_shared<Symphony::Text::TextLayoutCache>(kTextLayoutCacheSize);
+    base_screen_.Load(known_fonts_, default_font_, text_layout_cache);
+    market_screen_.Load(&market_rules_, known_fonts_, default_font_,
+                        text_layout_cache);
     fade_in_out_.Load("assets/fade_in_out.png");
     victory_screen_.Load();
     defeat_screen_.Load();
     quit_dialog_.Load();
 
     menu_audio_ = Symphony::Audio::LoadWave(
-        "assets/05_22k.wav", Symphony::Audio::WaveFile::kModeStreamingFromFile);
+        "assets/05_22k.wav", Symphony::Audio::WaveFile::kModeMemoryMapped,
+        (size_t)audio_->GetSampleRate());
     market_audio_ = Symphony::Audio::LoadWave(
-        "assets/14_22k.wav", Symphony::Audio::WaveFile::kModeStreamingFromFile);
+        "assets/14_22k.wav", Symphony::Audio::WaveFile::kModeMemoryMapped,
+        (size_t)audio_->GetSampleRate());
     level_audio_ = Symphony::Audio::LoadWave(
-        "assets/09_22k.wav", Symphony::Audio::WaveFile::kModeStreamingFromFile);
-    all_audio_ = LoadAllAudio();
+        "assets/09_22k.wav", Symphony::Audio::WaveFile::kModeMemoryMapped,
+        (size_t)audio_->GetSampleRate());
+    // Only the title screen pays for its sounds on start.
+    all_audio_.Load(*audio_, "assets/sound_banks.json");
+    all_audio_.EnterScreen("title");
 
     ready_for_loading_ = false;
 
@@ -506,6 +521,7 @@ void Game::ContinueFromTitleScreen() {
 
   Keyboard::Instance().RegisterCallback(nullptr);
 
+  all_audio_.EnterScreen("story");
   fade_in_out_.StartFadeIn(0.5f);
   state_ = State::kToStoryScreenFadeIn;
   level_.Start(/*is_paused*/ true);
@@ -533,6 +549,7 @@ void Game::ContinueFromStoryScreen() {
 
   Keyboard::Instance().RegisterCallback(nullptr);
 
+  all_audio_.EnterScreen("base");
   fade_in_out_.StartFadeIn(0.5f);
   state_ = State::kToBaseScreenFadeIn;
   LOGD("Game switches to state 'State::kToBaseScreenFadeIn'.");
@@ -557,15 +574,15 @@ void Game::ToMarketFromBaseScreen() {
     return;
   }
 
-  audio_->Stop(menu_audio_stream_, Symphony::Audio::StopFade(0.5f));
-  menu_audio_stream_ =
-      audio_->Play(market_audio_, Symphony::Audio::PlayTimes(2),
-                   Symphony::Audio::FadeInOut(5.0f, 5.0f));
+  menu_audio_stream_ = audio_->Crossfade(
+      menu_audio_stream_, market_audio_, Symphony::Audio::PlayTimes(2),
+      kMusicCrossfadeSec, Symphony::Audio::kPriorityHigh, all_audio_.music_bus);
   market_before_next_music_timeout_ =
       market_audio_->GetLengthSec() * 2.0f + 2.0f + (float)(rand() % 4);
 
   Keyboard::Instance().RegisterCallback(nullptr);
 
+  all_audio_.EnterScreen("market");
   fade_in_out_.StartFadeIn(0.5f);
   state_ = State::kToMarketScreenFadeIn;
   LOGD("Game switches to state 'State::kToMarketScreenFadeIn'.");
@@ -580,16 +597,19 @@ void Game::ContinueFromBaseScreen() {
 
   if (player_status_.credits_earned >= player_status_.credits_earned_of) {
     // Victory:
+    all_audio_.EnterScreen("victory");
     fade_in_out_.StartFadeIn(0.5f);
     state_ = State::kToVictoryFadeIn;
     LOGD("Game switches to state 'State::kToVictoryFadeIn'.");
   } else if (player_status_.levels_completed >=
              player_status_.levels_completed_of) {
     // Defeat:
+    all_audio_.EnterScreen("defeat");
     fade_in_out_.StartFadeIn(0.5f);
     state_ = State::kToDefeatFadeIn;
     LOGD("Game switches to state 'State::kToDefeatFadeIn'.");
   } else {
+    all_audio_.EnterScreen("level");
     fade_in_out_.StartFadeIn(0.5f);
     state_ = State::kToGameFadeIn;
     level_.Start(/*is_paused*/ true);
@@ -616,12 +636,13 @@ void Game::BackFromMarketScreen() {
     return;
   }
 
-  audio_->Stop(menu_audio_stream_, Symphony::Audio::StopFade(0.5f));
-  menu_audio_stream_ = audio_->Play(menu_audio_, Symphony::Audio::kPlayLooped,
-                                    Symphony::Audio::FadeInOut(2.0f, 1.0f));
+  menu_audio_stream_ = audio_->Crossfade(
+      menu_audio_stream_, menu_audio_, Symphony::Audio::kPlayLooped,
+      kMusicCrossfadeSec, Symphony::Audio::kPriorityHigh, all_audio_.music_bus);
 
   Keyboard::Instance().RegisterCallback(nullptr);
 
+  all_audio_.EnterScreen("base");
   fade_in_out_.StartFadeIn(0.5f);
   state_ = State::kToBaseScreenFromMarketFadeIn;
   LOGD("Game switches to state 'State::kToBaseScreenFromMarketFadeIn'.");
@@ -658,6 +679,7 @@ void Game::FinishLevel(size_t captured_humans) {
 
   audio_->Stop(level_audio_stream_, Symphony::Audio::StopFade(0.5f));
 
+  all_audio_.EnterScreen("base");
   fade_in_out_.StartFadeIn(0.5f);
   state_ = State::kToBaseScreenFromLevelFadeIn;
   LOGD("Game switches to state 'State::kToBaseScreenFromLevelFadeIn'.");
@@ -675,6 +697,9 @@ void Game::TryExitFromLevel() {
       Keyboard::Instance().RegisterCallback(&quit_dialog_);
 
   level_.SetIsPaused(true);
+  // Level sounds are paused with the level, music keeps playing quieter.
+  audio_->SetBusVolume(all_audio_.sfx_bus, 0.0f, 0.25f);
+  audio_->SetBusVolume(all_audio_.music_bus, 0.5f, 0.25f);
 
   LOGD("Game shows Quit dialog from Level.");
 }
@@ -685,6 +710,8 @@ void Game::ContinueFromDefeatScreen() { QuitGame(); }
 
 void Game::BackToGame() {
   level_.SetIsPaused(false);
+  audio_->SetBusVolume(all_audio_.sfx_bus, 1.0f, 0.25f);
+  audio_->SetBusVolume(all_audio_.music_bus, 1.0f, 0.25f);
 
   show_quit_dialog_ = false;
   Keyboard::Instance().RegisterCallback(prev_keyboard_callback_);
@@ -718,7 +745,10 @@ void Game::loadFonts() {
   file.close();
 
   for (const auto& font_json : known_fonts_json["known_fonts"]) {
-    auto font = Symphony::Text::LoadBmFont(font_json["file_path"]);
+    // Cooked fonts are made by the build next to the game, without them the
+    // font files are parsed.
+    auto font = Symphony::Text::LoadBmFont(
+        font_json["file_path"], font_json.value("cooked_file_path", ""));
     if (!font) {
       LOGE("Failed to load font {}", font_json["file_path"].get<std::string>());
       continue;
@@ -116,10 +116,11 @@ class Human {
         acc_.x = -std::copysign(configuration_.accelerationRunning, acc_.x);
         prevCaptured_ = true;
 
-        Sound sounds[6] = {Sound::kPanic_1, Sound::kPanic_2, Sound::kPanic_3,
-                           Sound::kPanic_4, Sound::kPanic_5, Sound::kPanic_6};
-        audio_->Play(all_audio_->audio[sounds[rand() % 6]],
-                     Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+        if (auto* sound = all_audio_->GetLimitedSound(Sound::kPanic)) {
+          panic_voice_ =
+              audio_->Trigger(*sound, Symphony::Audio::kPriorityNormal,
+                              all_audio_->world_bus, audio_->GetAudioClock());
+        }
       }
     } else if (rect.center.y < groundY_) {
       LOGD("Run away");
@@ -248,6 +249,8 @@ class Human {
   std::shared_ptr<SDL_Renderer> renderer_;
   std::shared_ptr<Symphony::Audio::Device> audio_;
   AllAudio* all_audio_{nullptr};
+  // Level pans it after the human.
+  Symphony::Audio::VoiceHandle panic_voice_;
   std::shared_ptr<SDL_Texture> texture_;
   Symphony::Math::Vector2d acc_;
   bool captured_{false};
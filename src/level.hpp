@@ -143,6 +143,10 @@ class Level : public Keyboard::Callback {
   template <typename T>
   void DrawObject(const T& obj, auto DrawToFn);
 
+  // Pan of a sound at x: -1 at the left edge of the screen, 1 at the right
+  // one.
+  float getPan(float x) const;
+
   void reFormatCapturedText();
   void reFormatTimeText();
 };
@@ -285,6 +289,11 @@ void Level::reFormatTimeText() {
                       default_font_, known_fonts_);
 }
 
+float Level::getPan(float x) const {
+  float dx = shortest_delta(x, cam_x_, level_config_.length);
+  return std::clamp(dx / (kScreenWidth * 0.5f), -1.0f, 1.0f);
+}
+
 void Level::Draw() {
   paralax_renderer_.Draw(cam_x_, cam_y_);
 
@@ -430,12 +439,17 @@ void Level::Update(float dt) {
   for (auto h = humans_.begin(); h != humans_.end();) {
     bool collected = ufo_.MaybeCatchHuman(*h);
     if (collected) {
+      float pan = getPan(h->rect.center.x);
       h = humans_.erase(h);
       capturedHumans_++;
       reFormatCapturedText();
 
-      audio_->Play(all_audio_->audio[Sound::kCapture],
-                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+      if (auto* sound = all_audio_->GetLimitedSound(Sound::kCapture)) {
+        audio_->SetPan(
+            audio_->Trigger(*sound, Symphony::Audio::kPriorityNormal,
+                            all_audio_->world_bus, audio_->GetAudioClock()),
+            pan);
+      }
     } else {
       h++;
     }
@@ -444,17 +458,26 @@ void Level::Update(float dt) {
   for (auto h = humans_.begin(); h != humans_.end();) {
     if (!h->Update(dt)) {
       LOGD("Dead");
+      float pan = getPan(h->rect.center.x);
       h = humans_.erase(h);
 
-      Sound sounds[3] = {Sound::kBodyFall_1, Sound::kBodyFall_2,
-                         Sound::kBodyFall_3};
-      audio_->Play(all_audio_->audio[sounds[rand() % 3]],
-                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+      if (auto* sound = all_audio_->GetLimitedSound(Sound::kBodyFall)) {
+        audio_->SetPan(
+            audio_->Trigger(*sound, Symphony::Audio::kPriorityNormal,
+                            all_audio_->world_bus, audio_->GetAudioClock()),
+            pan);
+      }
     } else {
       h++;
     }
   }
 
+  // Sounds follow their sources across the screen.
+  for (const auto& h : humans_) {
+    audio_->SetPan(h.panic_voice_, getPan(h.rect.center.x));
+  }
+  audio_->SetPan(ufo_.GetBeamVoice(), getPan(ufo_.GetBounds().center.x));
+
   if (capturedHumans_ >= level_config_.to_capture) {
     is_ending_ = true;
     ending_timeout_ = 1.0f;
@@ -58,6 +58,23 @@ void mainloop(void* gameCtx) {
   if (!ctx->game->IsRunning()) {
     LOGI("Exiting main loop.");
 
+    auto audio_stats = ctx->audio->GetStats();
+    LOGI(
+        "Audio: {} callbacks, {}/{} blocks delivered, {} late, {} underruns, "
+        "{} clipped samples, peak {} voices, max callback {} us.",
+        audio_stats.num_callbacks, audio_stats.num_blocks_delivered,
+        audio_stats.num_blocks_requested, audio_stats.num_late_callbacks,
+        audio_stats.num_underruns, audio_stats.num_clipped_samples,
+        audio_stats.peak_num_playing, audio_stats.max_callback_time_us);
+    std::string audio_callback_time_histogram;
+    for (size_t i = 0; i < audio_stats.callback_time_histogram.size(); ++i) {
+      audio_callback_time_histogram +=
+          std::format(" {}", audio_stats.callback_time_histogram[i]);
+    }
+    LOGI("Audio callback time histogram (<{} us, x2 per bucket):{}",
+         Symphony::Audio::Device::GetCallbackTimeBucketLimitUs(0),
+         audio_callback_time_histogram);
+
     ctx->audio.reset();
 
     ctx->renderer.reset();
@@ -95,16 +112,26 @@ void mainloop(void* gameCtx) {
   Keyboard::Instance().Update(dt);
 
   ctx->game->Update(dt);
+  ctx->audio->Update();
 
   SDL_SetRenderDrawColor(ctx->renderer.get(), 0, 0, 0, 255);
   SDL_RenderClear(ctx->renderer.get());
   ctx->game->Draw();
   if (kDrawSystemCounters) {
     ctx->fps = ((1.0f / dt) * 0.1f) + (ctx->fps * 0.9f);
-    size_t num_playing_audio_streams = ctx->audio->GetNumPlaying();
+    auto audio_stats = ctx->audio->GetStats();
     ctx->system_info_renderer->ReFormat(
         {{"fps_count", std::format("{:.1f}", ctx->fps)},
-         {"audio_streams_playing", std::to_string(num_playing_audio_streams)},
+         {"audio_streams_playing",
+          std::format("{} (peak {}, virtual {})", audio_stats.num_playing,
+                      audio_stats.peak_num_playing, audio_stats.num_virtual)},
+         {"audio_streaming_underruns",
+          std::to_string(audio_stats.num_underruns)},
+         {"audio_callback",
+          std::format("max {} us, late {}, clipped {}",
+                      audio_stats.max_callback_time_us,
+                      audio_stats.num_late_callbacks,
+                      audio_stats.num_clipped_samples)},
          {"down_keys", Keyboard::Instance().GetDownKeysListString()}},
         "system_20.fnt", system_info_renderer_fonts);
     ctx->system_info_renderer->Render(0);
@@ -173,7 +200,14 @@ int main(int /* argc */, char* /* argv */[]) {
 
   ctx->audio = std::make_shared<Symphony::Audio::Device>();
   ctx->audio->Init();
-  LOGI("Audio is created and initialized.");
+  // Crowds of panicking humans can take all voices, only the loudest of them
+  // are mixed.
+  ctx->audio->SetMaxRealVoices(16);
+  LOGI(
+      "Audio is created and initialized: {} Hz, {} blocks per callback, "
+      "{:.1f} ms output latency.",
+      ctx->audio->GetSampleRate(), ctx->audio->GetBufferBlocks(),
+      ctx->audio->GetOutputLatencySec() * 1000.0f);
 
   ctx->system_info_renderer =
       std::make_unique<Symphony::Text::TextRenderer>(ctx->renderer);
@@ -27,7 +27,8 @@ class MarketScreen : public Keyboard::Callback {
   void Load(
       const MarketRules* market_rules,
       std::map<std::string, std::shared_ptr<Symphony::Text::Font>> known_fonts,
-      const std::string& default_font);
+      const std::string& default_font,
+      std::shared_ptr<Symphony::Text::TextLayoutCache> text_layout_cache);
 
   void Show(PlayerStatus* player_status, size_t cur_alien_index);
 
@@ -97,7 +98,8 @@ class MarketScreen : public Keyboard::Callback {
 void MarketScreen::Load(
     const MarketRules* market_rules,
     std::map<std::string, std::shared_ptr<Symphony::Text::Font>> known_fonts,
-    const std::string& default_font) {
+    const std::string& default_font,
+    std::shared_ptr<Symphony::Text::TextLayoutCache> text_layout_cache) {
   market_rules_ = market_rules;
   known_fonts_ = known_fonts;
   default_font_ = default_font;
@@ -129,6 +131,7 @@ void MarketScreen::Load(
 
   const auto& humanoid_json = market_screen_json["market_screen"]["humanoid"];
   humanoid_text_.InitRenderer(renderer_);
+  humanoid_text_.SetLayoutCache(text_layout_cache);
   humanoid_text_.LoadFromFile(humanoid_json["file_path"]);
   humanoid_text_.SetPosition(humanoid_json.value("x", 0),
                              humanoid_json.value("y", 0));
@@ -144,6 +147,7 @@ void MarketScreen::Load(
   const auto& alien_text_json =
       market_screen_json["market_screen"]["alien_text"];
   alien_text_.InitRenderer(renderer_);
+  alien_text_.SetLayoutCache(text_layout_cache);
   alien_text_.LoadFromFile(alien_text_json["file_path"]);
   alien_text_.SetPosition(alien_text_json.value("x", 0),
                           alien_text_json.value("y", 0));
@@ -152,6 +156,7 @@ void MarketScreen::Load(
 
   const auto& credits_json = market_screen_json["market_screen"]["credits"];
   credits_text_.InitRenderer(renderer_);
+  credits_text_.SetLayoutCache(text_layout_cache);
   credits_text_.LoadFromFile(credits_json["file_path"]);
   credits_text_.SetPosition(credits_json.value("x", 0),
                             credits_json.value("y", 0));
@@ -166,6 +171,7 @@ void MarketScreen::Load(
   const auto& alien_reply_json =
       market_screen_json["market_screen"]["alien_reply"];
   alien_reply_text_.InitRenderer(renderer_);
+  alien_reply_text_.SetLayoutCache(text_layout_cache);
   alien_reply_text_.LoadFromFile(alien_reply_json["file_path"]);
   alien_reply_text_.SetPosition(alien_reply_json.value("x", 0),
                                 alien_reply_json.value("y", 0));
@@ -178,6 +184,7 @@ void MarketScreen::Load(
 
   const auto& receipt_json = market_screen_json["market_screen"]["receipt"];
   receipt_text_.InitRenderer(renderer_);
+  receipt_text_.SetLayoutCache(text_layout_cache);
   receipt_text_.LoadFromFile(receipt_json["file_path"]);
   receipt_text_.SetPosition(receipt_json.value("x", 0),
                             receipt_json.value("y", 0));
@@ -337,8 +344,9 @@ void MarketScreen::OnKeyUp(Keyboard::Key key) {
     case State::kShowWare:
       if (key == Keyboard::Key::kCircle) {
         if (callback_) {
-          audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+          audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                       Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
           callback_->BackFromMarketScreen();
         }
@@ -348,8 +356,9 @@ void MarketScreen::OnKeyUp(Keyboard::Key key) {
           --cur_humanoid_index_;
           need_humanoid_re_format = true;
 
-          audio_->Play(all_audio_->audio[Sound::kHumanoidSelect],
-                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+          audio_->Play(all_audio_->GetWave(Sound::kHumanoidSelect),
+                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                       Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
         }
       } else if (key == Keyboard::Key::kDpadRight) {
         auto next_it = cur_humanoid_it_;
@@ -360,8 +369,9 @@ void MarketScreen::OnKeyUp(Keyboard::Key key) {
           ++cur_humanoid_index_;
           need_humanoid_re_format = true;
 
-          audio_->Play(all_audio_->audio[Sound::kHumanoidSelect],
-                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+          audio_->Play(all_audio_->GetWave(Sound::kHumanoidSelect),
+                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                       Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
         }
       } else if (key == Keyboard::Key::kX) {
         size_t match_result = MatchHumanoidWithAlien(
@@ -387,8 +397,9 @@ void MarketScreen::OnKeyUp(Keyboard::Key key) {
         reFormatCredits();
         reFormatReceipt();
 
-        audio_->Play(all_audio_->audio[Sound::kKaChing],
-                     Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+        audio_->Play(all_audio_->GetWave(Sound::kKaChing),
+                     Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                     Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
         state_ = State::kReceipt;
         no_button_time_ = no_button_timeout_;
@@ -396,8 +407,9 @@ void MarketScreen::OnKeyUp(Keyboard::Key key) {
         if (callback_) {
           callback_->TryExitFromMarketScreen();
 
-          audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+          audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                       Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
         }
       }
       break;
@@ -425,8 +437,9 @@ void MarketScreen::OnKeyUp(Keyboard::Key key) {
 
         reFormatAlienReply();
 
-        audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                     Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+        audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                     Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                     Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
         state_ = State::kAlienReply;
         no_button_time_ = no_button_timeout_;
@@ -436,8 +449,9 @@ void MarketScreen::OnKeyUp(Keyboard::Key key) {
     case State::kAllSold:
       if (key == Keyboard::Key::kCircle) {
         if (callback_) {
-          audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+          audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                       Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                       Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
           callback_->BackFromMarketScreen();
         }
@@ -119,19 +119,22 @@ void StoryScreen::OnKeyUp(Keyboard::Key key) {
       }
     }
 
-    audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                 Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+    audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                 Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                 Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
   } else if (key == Keyboard::Key::kCircle) {
     if (cur_story_bro_ > 0) {
       --cur_story_bro_;
 
-      audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+      audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                   Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
     }
   } else if (key == Keyboard::Key::kSelect) {
     if (callback_) {
-      audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+      audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                   Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
       callback_->TryExitFromStoryScreen();
     }
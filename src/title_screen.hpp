@@ -64,15 +64,17 @@ void TitleScreen::OnKeyDown(Keyboard::Key /*key*/) {}
 void TitleScreen::OnKeyUp(Keyboard::Key key) {
   if (key == Keyboard::Key::kX) {
     if (callback_) {
-      audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+      audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                   Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
       callback_->ContinueFromTitleScreen();
     }
   } else if (key == Keyboard::Key::kSelect) {
     if (callback_) {
-      audio_->Play(all_audio_->audio[Sound::kButtonClick],
-                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade);
+      audio_->Play(all_audio_->GetWave(Sound::kButtonClick),
+                   Symphony::Audio::PlayTimes(1), Symphony::Audio::kNoFade,
+                   Symphony::Audio::kPriorityNormal, all_audio_->ui_bus);
 
       callback_->TryExitFromTitleScreen();
     }
@@ -53,6 +53,10 @@ class Ufo {
 
   const Symphony::Math::AARect2d& GetBounds() const { return rect_; }
 
+  const Symphony::Audio::VoiceHandle& GetBeamVoice() const {
+    return beam_audio_stream_;
+  }
+
   void SetPosition(const Symphony::Math::Point2d& new_position) {
     rect_.center = new_position;
   }
@@ -62,10 +66,13 @@ class Ufo {
   bool IsPointInBeam(const Symphony::Math::Point2d& p);
 
  private:
+  // Muffles sounds of the world while the beam is on.
+  void setWorldMuffled(bool is_muffled);
+
   std::shared_ptr<SDL_Renderer> renderer_;
   std::shared_ptr<Symphony::Audio::Device> audio_;
   AllAudio* all_audio_{nullptr};
-  std::shared_ptr<Symphony::Audio::PlayingStream> beam_audio_stream_;
+  Symphony::Audio::VoiceHandle beam_audio_stream_;
 
   std::shared_ptr<SDL_Texture> texture_{};
 
@@ -87,6 +94,7 @@ class Ufo {
   Symphony::Math::Vector2d acceleration_{0, 0};
 
   float tractorBeamTimeout_{0};
+  bool is_world_muffled_{false};
 
   float prevTime_{0};
 
@@ -182,9 +190,11 @@ void Ufo::Update(float dt) {
     if (Keyboard::Instance().IsKeyDown(Keyboard::Key::kSquare).has_value()) {
       if (tractorBeamTimeout_ == 0.0f) {
         audio_->Stop(beam_audio_stream_, Symphony::Audio::StopFade(0.25f));
-        beam_audio_stream_ = audio_->Play(all_audio_->audio[Sound::kBeamLoop],
-                                          Symphony::Audio::kPlayLooped,
-                                          Symphony::Audio::kNoFade);
+        beam_audio_stream_ = audio_->Play(
+            all_audio_->GetWave(Sound::kBeamLoop), Symphony::Audio::kPlayLooped,
+            Symphony::Audio::kNoFade, Symphony::Audio::kPriorityNormal,
+            all_audio_->sfx_bus, audio_->GetAudioClock());
+        setWorldMuffled(true);
       }
       tractorBeamTimeout_ = configuration_.tractorBeam.latency;
     }
@@ -227,7 +237,8 @@ void Ufo::Update(float dt) {
       std::clamp(tractorBeamTimeout_, 0.0f, configuration_.tractorBeam.latency);
   if (tractorBeamTimeout_ == 0.0f) {
     audio_->Stop(beam_audio_stream_, Symphony::Audio::StopFade(0.25f));
-    beam_audio_stream_.reset();
+    beam_audio_stream_ = {};
+    setWorldMuffled(false);
   }
 }
 
@@ -236,11 +247,24 @@ void Ufo::StartLevel() { is_ending_ = false; }
 void Ufo::FinishLevel() {
   tractorBeamTimeout_ = 0.0f;
   audio_->Stop(beam_audio_stream_, Symphony::Audio::StopFade(0.25f));
-  beam_audio_stream_.reset();
+  beam_audio_stream_ = {};
+  setWorldMuffled(false);
 
   is_ending_ = true;
 }
 
+void Ufo::setWorldMuffled(bool is_muffled) {
+  if (is_muffled == is_world_muffled_) {
+    return;
+  }
+
+  is_world_muffled_ = is_muffled;
+  audio_->SetBusFilter(all_audio_->world_bus,
+                       is_muffled
+                           ? Symphony::Audio::LowPass(kBeamMuffleCutoffHz)
+                           : Symphony::Audio::kNoFilter);
+}
+
 static SDL_FColor SdlColorFromUInt32(uint32_t color) {
   SDL_FColor sdl_color;
   sdl_color.a = (float)((color >> 24) & 0xFF) / 255.0f;